@@ -32,6 +32,7 @@
 #include <bw_env_gen.h>
 #include <bw_gain.h>
 #include <bw_ppm.h>
+#include <bw_snapshot.h>
 #include <bw_buf.h>
 #include <bw_voice_alloc.h>
 
@@ -85,6 +86,7 @@ typedef struct plugin {
 	bw_gain_coeffs		gain_coeffs;
 	bw_ppm_coeffs		ppm_coeffs;
 	bw_ppm_state		ppm_state;
+	bw_snapshot		ppm_snapshot;
 
 	voice			voices[N_VOICES];
 
@@ -121,6 +123,7 @@ typedef struct plugin {
 	char			vco2_waveform_cur;
 
 	float			buf[BUFFER_SIZE];
+	float			ppm_snapshot_mem[3];
 
 	float *			b0[N_VOICES];
 	float *			b1[N_VOICES];
@@ -153,6 +156,8 @@ static void plugin_init(plugin *instance, plugin_callbacks *cbs) {
 	bw_phase_gen_init(&instance->a440_phase_gen_coeffs);
 	bw_gain_init(&instance->gain_coeffs);
 	bw_ppm_init(&instance->ppm_coeffs);
+	bw_snapshot_init(&instance->ppm_snapshot, 1);
+	bw_snapshot_mem_set(&instance->ppm_snapshot, instance->ppm_snapshot_mem);
 
 	for (int i = 0; i < N_VOICES; i++) {
 		bw_phase_gen_init(&instance->voices[i].vco1_phase_gen_coeffs);
@@ -258,7 +263,7 @@ static void plugin_reset(plugin *instance) {
 	bw_phase_gen_reset_state(&instance->a440_phase_gen_coeffs, &instance->a440_phase_gen_state, 0.f, &p, &pi);
 	bw_gain_reset_coeffs(&instance->gain_coeffs);
 	bw_ppm_reset_coeffs(&instance->ppm_coeffs);
-	bw_ppm_reset_state(&instance->ppm_coeffs, &instance->ppm_state, 0.f);
+	bw_snapshot_reset(&instance->ppm_snapshot, bw_ppm_reset_state(&instance->ppm_coeffs, &instance->ppm_state, 0.f));
 
 	for (int i = 0; i < N_VOICES; i++) {
 		bw_phase_gen_reset_coeffs(&instance->voices[i].vco1_phase_gen_coeffs);
@@ -447,7 +452,8 @@ static void plugin_set_parameter(plugin *instance, size_t index, float value) {
 
 static float plugin_get_parameter(plugin *instance, size_t index) {
 	(void)index;
-	return bw_clipf(bw_ppm_get_y_z1(&instance->ppm_state), -60.f, 0.f);
+	// this might be called concurrently with plugin_process()
+	return bw_clipf(*bw_snapshot_read(&instance->ppm_snapshot, NULL), -60.f, 0.f);
 }
 
 static void note_on(void *BW_RESTRICT handle, unsigned char note, float velocity) {
@@ -692,6 +698,9 @@ static void plugin_process(plugin *instance, const float **inputs, float **outpu
 
 		i += n;
 	}
+
+	*bw_snapshot_write_begin(&instance->ppm_snapshot) = bw_ppm_get_y_z1(&instance->ppm_state);
+	bw_snapshot_write_end(&instance->ppm_snapshot);
 }
 
 static void plugin_midi_msg_in(plugin *instance, size_t index, const uint8_t * data) {
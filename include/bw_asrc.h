@@ -0,0 +1,994 @@
+/*
+ * Brickworks
+ *
+ * Copyright (C) 2024 Orastron Srl unipersonale
+ *
+ * Brickworks is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3 of the License.
+ *
+ * Brickworks is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Brickworks.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * File author: Stefano D'Angelo
+ */
+
+/*!
+ *  module_type {{{ dsp }}}
+ *  version {{{ 1.0.0 }}}
+ *  requires {{{ bw_atomic bw_common bw_math bw_src_sinc }}}
+ *  description {{{
+ *    Asynchronous sample rate converter to bridge between independent clock
+ *    domains (e.g., two audio devices).
+ *
+ *    The producer writes input samples into an internal multichannel FIFO
+ *    and the consumer reads output samples resampled from it by windowed-sinc
+ *    interpolation (see [bw_src_sinc](bw_src_sinc)). After each read the
+ *    average FIFO fill level is compared with a target value and a
+ *    proportional-integral controller smoothly adjusts the resampling ratio
+ *    around its nominal value, thus tracking the drift between the two
+ *    clocks.
+ *
+ *    Writing and reading can happen in different threads (single producer,
+ *    single consumer) and with arbitrary and varying block sizes. No locks
+ *    are involved and no memory is allocated.
+ *
+ *    All channels share the same FIFO positions and resampling ratio, hence
+ *    one state holds all channels.
+ *  }}}
+ *  changelog {{{
+ *    <ul>
+ *      <li>Version <strong>1.0.0</strong>:
+ *        <ul>
+ *          <li>First release.</li>
+ *        </ul>
+ *      </li>
+ *    </ul>
+ *  }}}
+ */
+
+#ifndef BW_ASRC_H
+#define BW_ASRC_H
+
+#include <bw_common.h>
+#include <bw_src_sinc.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*! api {{{
+ *    #### bw_asrc_coeffs
+ *  ```>>> */
+typedef struct bw_asrc_coeffs bw_asrc_coeffs;
+/*! <<<```
+ *    Coefficients and related.
+ *
+ *    #### bw_asrc_state
+ *  ```>>> */
+typedef struct bw_asrc_state bw_asrc_state;
+/*! <<<```
+ *    Internal state and related, for all channels.
+ *
+ *    #### bw_asrc_init()
+ *  ```>>> */
+static inline void bw_asrc_init(
+	bw_asrc_coeffs * BW_RESTRICT coeffs,
+	size_t                       n_channels,
+	size_t                       fifo_len,
+	bw_src_sinc_quality          quality);
+/*! <<<```
+ *    Initializes input parameter values in `coeffs` for `n_channels` channels
+ *    using a FIFO which can contain up to `fifo_len` samples per channel
+ *    (rounded up to the next power of `2`) and the given interpolation
+ *    `quality`.
+ *
+ *    `fifo_len` must be at least `512` and less than or equal to `2^30`.
+ *
+ *    #### bw_asrc_set_sample_rates()
+ *  ```>>> */
+static inline void bw_asrc_set_sample_rates(
+	bw_asrc_coeffs * BW_RESTRICT coeffs,
+	float                        in_sample_rate,
+	float                        out_sample_rate);
+/*! <<<```
+ *    Sets the nominal input and output sample rates (Hz) in `coeffs` and
+ *    precomputes interpolation filter tables.
+ *
+ *    Their ratio must be between `0.015625f` (1/64) and `64.f`.
+ *
+ *    #### bw_asrc_mem_req()
+ *  ```>>> */
+static inline size_t bw_asrc_mem_req(
+	const bw_asrc_coeffs * BW_RESTRICT coeffs);
+/*! <<<```
+ *    Returns the size, in bytes, of contiguous memory to be supplied to
+ *    `bw_asrc_mem_set()` using `coeffs`.
+ *
+ *    #### bw_asrc_mem_set()
+ *  ```>>> */
+static inline void bw_asrc_mem_set(
+	const bw_asrc_coeffs * BW_RESTRICT coeffs,
+	bw_asrc_state * BW_RESTRICT        state,
+	void * BW_RESTRICT                 mem);
+/*! <<<```
+ *    Associates the contiguous memory block `mem` to the given `state` using
+ *    `coeffs`.
+ *
+ *    #### bw_asrc_reset_coeffs()
+ *  ```>>> */
+static inline void bw_asrc_reset_coeffs(
+	bw_asrc_coeffs * BW_RESTRICT coeffs);
+/*! <<<```
+ *    Resets coefficients in `coeffs` to assume their target values.
+ *
+ *    #### bw_asrc_reset_state()
+ *  ```>>> */
+static inline void bw_asrc_reset_state(
+	const bw_asrc_coeffs * BW_RESTRICT coeffs,
+	bw_asrc_state * BW_RESTRICT        state,
+	const float *                      x_0,
+	float *                            y_0);
+/*! <<<```
+ *    Resets the given `state` to its initial values using the given `coeffs`
+ *    and the initial input values in the `x_0` array (one per channel). The
+ *    FIFO is filled up to the target fill level with such values.
+ *
+ *    The corresponding initial output values are written into the `y_0` array
+ *    (one per channel), if not `BW_NULL`.
+ *
+ *    This function must not be called while either `bw_asrc_write()` or
+ *    `bw_asrc_read()` are running.
+ *
+ *    #### bw_asrc_update_coeffs_ctrl()
+ *  ```>>> */
+static inline void bw_asrc_update_coeffs_ctrl(
+	bw_asrc_coeffs * BW_RESTRICT coeffs);
+/*! <<<```
+ *    Triggers control-rate update of coefficients in `coeffs`.
+ *
+ *    #### bw_asrc_write()
+ *  ```>>> */
+static inline size_t bw_asrc_write(
+	const bw_asrc_coeffs * BW_RESTRICT coeffs,
+	bw_asrc_state * BW_RESTRICT        state,
+	const float * const *              x,
+	size_t                             n_samples);
+/*! <<<```
+ *    Writes at most the first `n_samples` of the input buffers `x` (one per
+ *    channel) into the FIFO in `state` using `coeffs`.
+ *
+ *    Returns the number of samples actually written, which is less than
+ *    `n_samples` only in case of overrun (the FIFO is full).
+ *
+ *    This function can be called concurrently with `bw_asrc_read()` from
+ *    another thread, but not concurrently with itself.
+ *
+ *    #### bw_asrc_read()
+ *  ```>>> */
+static inline size_t bw_asrc_read(
+	const bw_asrc_coeffs * BW_RESTRICT coeffs,
+	bw_asrc_state * BW_RESTRICT        state,
+	float * const *                    y,
+	size_t                             n_samples);
+/*! <<<```
+ *    Fills the first `n_samples` of the output buffers `y` (one per channel)
+ *    with samples resampled from the FIFO in `state` using `coeffs`, then
+ *    updates the resampling ratio.
+ *
+ *    Returns the number of samples actually resampled, which is less than
+ *    `n_samples` only in case of underrun (the FIFO does not contain enough
+ *    samples), in which case the remaining output samples are set to `0.f`.
+ *
+ *    This function can be called concurrently with `bw_asrc_write()` from
+ *    another thread, but not concurrently with itself.
+ *
+ *    #### bw_asrc_set_target_fill()
+ *  ```>>> */
+static inline void bw_asrc_set_target_fill(
+	bw_asrc_coeffs * BW_RESTRICT coeffs,
+	float                        value);
+/*! <<<```
+ *    Sets the target FIFO fill level, relative to the FIFO length, in
+ *    `coeffs`.
+ *
+ *    Higher values give more headroom against underruns due to jittery
+ *    producers or consumers at the price of higher latency.
+ *
+ *    Valid range: [`0.125f`, `0.875f`].
+ *
+ *    Default value: `0.5f`.
+ *
+ *    #### bw_asrc_set_bandwidth()
+ *  ```>>> */
+static inline void bw_asrc_set_bandwidth(
+	bw_asrc_coeffs * BW_RESTRICT coeffs,
+	float                        value);
+/*! <<<```
+ *    Sets the bandwidth (Hz) of the ratio control loop in `coeffs`.
+ *
+ *    Lower values give a more stable ratio but slower convergence.
+ *
+ *    Valid range: [`0.001f`, `1.f`].
+ *
+ *    Default value: `0.01f`.
+ *
+ *    #### bw_asrc_set_max_deviation()
+ *  ```>>> */
+static inline void bw_asrc_set_max_deviation(
+	bw_asrc_coeffs * BW_RESTRICT coeffs,
+	float                        value);
+/*! <<<```
+ *    Sets the maximum relative deviation of the resampling ratio from its
+ *    nominal value in `coeffs`.
+ *
+ *    Valid range: [`0.f`, `0.1f`].
+ *
+ *    Default value: `0.01f`.
+ *
+ *    #### bw_asrc_get_ratio()
+ *  ```>>> */
+static inline float bw_asrc_get_ratio(
+	const bw_asrc_coeffs * BW_RESTRICT coeffs,
+	const bw_asrc_state * BW_RESTRICT  state);
+/*! <<<```
+ *    Returns the current resampling ratio (output over input sample rate) in
+ *    `state` using `coeffs`.
+ *
+ *    #### bw_asrc_get_fill()
+ *  ```>>> */
+static inline float bw_asrc_get_fill(
+	const bw_asrc_coeffs * BW_RESTRICT coeffs,
+	const bw_asrc_state * BW_RESTRICT  state);
+/*! <<<```
+ *    Returns the smoothed FIFO fill level (samples) as estimated by the last
+ *    call to `bw_asrc_read()` in `state` using `coeffs`.
+ *
+ *    #### bw_asrc_get_n_overruns()
+ *  ```>>> */
+static inline uint32_t bw_asrc_get_n_overruns(
+	const bw_asrc_state * BW_RESTRICT state);
+/*! <<<```
+ *    Returns the number of calls to `bw_asrc_write()` that could not write
+ *    all input samples since the last reset of `state`.
+ *
+ *    #### bw_asrc_get_n_underruns()
+ *  ```>>> */
+static inline uint32_t bw_asrc_get_n_underruns(
+	const bw_asrc_state * BW_RESTRICT state);
+/*! <<<```
+ *    Returns the number of calls to `bw_asrc_read()` that could not resample
+ *    all output samples since the last reset of `state`.
+ *
+ *    #### bw_asrc_coeffs_is_valid()
+ *  ```>>> */
+static inline char bw_asrc_coeffs_is_valid(
+	const bw_asrc_coeffs * BW_RESTRICT coeffs);
+/*! <<<```
+ *    Tries to determine whether `coeffs` is valid and returns non-`0` if it
+ *    seems to be the case and `0` if it is certainly not. False positives are
+ *    possible, false negatives are not.
+ *
+ *    `coeffs` must at least point to a readable memory block of size greater
+ *    than or equal to that of `bw_asrc_coeffs`.
+ *
+ *    #### bw_asrc_state_is_valid()
+ *  ```>>> */
+static inline char bw_asrc_state_is_valid(
+	const bw_asrc_coeffs * BW_RESTRICT coeffs,
+	const bw_asrc_state * BW_RESTRICT  state);
+/*! <<<```
+ *    Tries to determine whether `state` is valid and returns non-`0` if it
+ *    seems to be the case and `0` if it is certainly not. False positives are
+ *    possible, false negatives are not.
+ *
+ *    If `coeffs` is not `BW_NULL` extra cross-checks might be performed
+ *    (`state` is supposed to be associated to `coeffs`).
+ *
+ *    `state` must at least point to a readable memory block of size greater
+ *    than or equal to that of `bw_asrc_state`.
+ *  }}} */
+
+#ifdef __cplusplus
+}
+#endif
+
+/*** Implementation ***/
+
+/* WARNING: This part of the file is not part of the public API. Its content may
+ * change at any time in future versions. Please, do not use it directly. */
+
+#include <bw_atomic.h>
+#include <bw_math.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifdef BW_DEBUG_DEEP
+enum bw_asrc_coeffs_state {
+	bw_asrc_coeffs_state_invalid,
+	bw_asrc_coeffs_state_init,
+	bw_asrc_coeffs_state_set_sample_rates,
+	bw_asrc_coeffs_state_reset_coeffs
+};
+#endif
+
+#ifdef BW_DEBUG_DEEP
+enum bw_asrc_state_state {
+	bw_asrc_state_state_invalid,
+	bw_asrc_state_state_mem_set,
+	bw_asrc_state_state_reset_state
+};
+#endif
+
+struct bw_asrc_coeffs {
+#ifdef BW_DEBUG_DEEP
+	uint32_t			hash;
+	enum bw_asrc_coeffs_state	state;
+	uint32_t			reset_id;
+#endif
+
+	// Sub-components
+	bw_src_sinc_coeffs		sinc_coeffs;
+
+	// Coefficients
+	float				fs_in;
+	float				fs_out;
+	size_t				len;
+	size_t				mask;
+	size_t				stride;		// len + n_taps
+	uint64_t			step;		// nominal, 32.32 fixed point
+	float				step_f;
+	float				target;
+	float				k_lp;
+	float				kp;
+	float				ki;
+
+	// Parameters
+	size_t				n_channels;
+	bw_src_sinc_quality		quality;
+	float				target_fill;
+	float				bandwidth;
+	float				max_dev;
+};
+
+struct bw_asrc_state {
+#ifdef BW_DEBUG_DEEP
+	uint32_t			hash;
+	enum bw_asrc_state_state	state;
+	uint32_t			coeffs_reset_id;
+#endif
+
+	// Buffers
+	float * BW_RESTRICT		buf;
+
+	// States
+	uint32_t			wr;		// written by producer only
+	uint32_t			rd;		// written by consumer only
+	uint32_t			frac;
+	uint64_t			step;
+	float				fill_z1;
+	float				fill;
+	float				integ;
+	float				dev;
+	uint32_t			n_overruns;
+	uint32_t			n_underruns;
+};
+
+static inline void bw_asrc_init(
+		bw_asrc_coeffs * BW_RESTRICT coeffs,
+		size_t                       n_channels,
+		size_t                       fifo_len,
+		bw_src_sinc_quality          quality) {
+	BW_ASSERT(coeffs != BW_NULL);
+	BW_ASSERT(n_channels > 0);
+	BW_ASSERT(fifo_len >= 512 && fifo_len <= ((size_t)1 << 30));
+	BW_ASSERT(quality == bw_src_sinc_quality_low || quality == bw_src_sinc_quality_medium || quality == bw_src_sinc_quality_high);
+
+	coeffs->n_channels = n_channels;
+	coeffs->len = 1;
+	while (coeffs->len < fifo_len)
+		coeffs->len <<= 1;
+	coeffs->mask = coeffs->len - 1;
+	coeffs->quality = quality;
+	coeffs->target_fill = 0.5f;
+	coeffs->bandwidth = 0.01f;
+	coeffs->max_dev = 0.01f;
+
+#ifdef BW_DEBUG_DEEP
+	coeffs->hash = bw_hash_sdbm("bw_asrc_coeffs");
+	coeffs->state = bw_asrc_coeffs_state_init;
+	coeffs->reset_id = coeffs->hash + 1;
+#endif
+	BW_ASSERT_DEEP(bw_asrc_coeffs_is_valid(coeffs));
+	BW_ASSERT_DEEP(coeffs->state == bw_asrc_coeffs_state_init);
+}
+
+static inline void bw_asrc_set_sample_rates(
+		bw_asrc_coeffs * BW_RESTRICT coeffs,
+		float                        in_sample_rate,
+		float                        out_sample_rate) {
+	BW_ASSERT(coeffs != BW_NULL);
+	BW_ASSERT_DEEP(bw_asrc_coeffs_is_valid(coeffs));
+	BW_ASSERT_DEEP(coeffs->state >= bw_asrc_coeffs_state_init);
+	BW_ASSERT(bw_is_finite(in_sample_rate) && in_sample_rate > 0.f);
+	BW_ASSERT(bw_is_finite(out_sample_rate) && out_sample_rate > 0.f);
+	BW_ASSERT(out_sample_rate >= 0.015625f * in_sample_rate && out_sample_rate <= 64.f * in_sample_rate);
+
+	coeffs->fs_in = in_sample_rate;
+	coeffs->fs_out = out_sample_rate;
+	bw_src_sinc_design(&coeffs->sinc_coeffs, out_sample_rate / in_sample_rate, coeffs->quality, 0);
+	coeffs->stride = coeffs->len + coeffs->sinc_coeffs.n_taps;
+	coeffs->step = coeffs->sinc_coeffs.step;
+	coeffs->step_f = (float)coeffs->step;
+
+#ifdef BW_DEBUG_DEEP
+	coeffs->state = bw_asrc_coeffs_state_set_sample_rates;
+#endif
+	BW_ASSERT_DEEP(bw_asrc_coeffs_is_valid(coeffs));
+	BW_ASSERT_DEEP(coeffs->state == bw_asrc_coeffs_state_set_sample_rates);
+}
+
+static inline size_t bw_asrc_mem_req(
+		const bw_asrc_coeffs * BW_RESTRICT coeffs) {
+	BW_ASSERT(coeffs != BW_NULL);
+	BW_ASSERT_DEEP(bw_asrc_coeffs_is_valid(coeffs));
+	BW_ASSERT_DEEP(coeffs->state >= bw_asrc_coeffs_state_set_sample_rates);
+
+	return coeffs->n_channels * coeffs->stride * sizeof(float);
+}
+
+static inline void bw_asrc_mem_set(
+		const bw_asrc_coeffs * BW_RESTRICT coeffs,
+		bw_asrc_state * BW_RESTRICT        state,
+		void * BW_RESTRICT                 mem) {
+	BW_ASSERT(coeffs != BW_NULL);
+	BW_ASSERT_DEEP(bw_asrc_coeffs_is_valid(coeffs));
+	BW_ASSERT_DEEP(coeffs->state >= bw_asrc_coeffs_state_set_sample_rates);
+	BW_ASSERT(state != BW_NULL);
+	BW_ASSERT(mem != BW_NULL);
+
+	(void)coeffs;
+	state->buf = (float *)mem;
+
+#ifdef BW_DEBUG_DEEP
+	state->hash = bw_hash_sdbm("bw_asrc_state");
+	state->state = bw_asrc_state_state_mem_set;
+#endif
+	BW_ASSERT_DEEP(bw_asrc_coeffs_is_valid(coeffs));
+	BW_ASSERT_DEEP(coeffs->state >= bw_asrc_coeffs_state_set_sample_rates);
+	BW_ASSERT_DEEP(bw_asrc_state_is_valid(coeffs, state));
+	BW_ASSERT_DEEP(state->state == bw_asrc_state_state_mem_set);
+}
+
+static inline void bw_asrc_do_update_coeffs_ctrl(
+		bw_asrc_coeffs * BW_RESTRICT coeffs) {
+	// critically damped second-order loop on the fill level error (seconds),
+	// which is smoothed by two one-pole lowpass filters at ten times the
+	// bandwidth to reject block size and timing jitter
+	const float w = 6.283185307179586f * coeffs->bandwidth;
+	coeffs->target = coeffs->target_fill * (float)coeffs->len;
+	coeffs->k_lp = 10.f * w / coeffs->fs_out;
+	coeffs->kp = 2.f * w;
+	coeffs->ki = w * w;
+}
+
+static inline void bw_asrc_reset_coeffs(
+		bw_asrc_coeffs * BW_RESTRICT coeffs) {
+	BW_ASSERT(coeffs != BW_NULL);
+	BW_ASSERT_DEEP(bw_asrc_coeffs_is_valid(coeffs));
+	BW_ASSERT_DEEP(coeffs->state >= bw_asrc_coeffs_state_set_sample_rates);
+
+	bw_asrc_do_update_coeffs_ctrl(coeffs);
+
+#ifdef BW_DEBUG_DEEP
+	coeffs->state = bw_asrc_coeffs_state_reset_coeffs;
+	coeffs->reset_id++;
+#endif
+	BW_ASSERT_DEEP(bw_asrc_coeffs_is_valid(coeffs));
+	BW_ASSERT_DEEP(coeffs->state == bw_asrc_coeffs_state_reset_coeffs);
+}
+
+static inline void bw_asrc_reset_state(
+		const bw_asrc_coeffs * BW_RESTRICT coeffs,
+		bw_asrc_state * BW_RESTRICT        state,
+		const float *                      x_0,
+		float *                            y_0) {
+	BW_ASSERT(coeffs != BW_NULL);
+	BW_ASSERT_DEEP(bw_asrc_coeffs_is_valid(coeffs));
+	BW_ASSERT_DEEP(coeffs->state >= bw_asrc_coeffs_state_reset_coeffs);
+	BW_ASSERT(state != BW_NULL);
+	BW_ASSERT_DEEP(bw_asrc_state_is_valid(coeffs, state));
+	BW_ASSERT_DEEP(state->state >= bw_asrc_state_state_mem_set);
+	BW_ASSERT(x_0 != BW_NULL);
+	BW_ASSERT_DEEP(bw_has_only_finite(x_0, coeffs->n_channels));
+
+	for (size_t i = 0; i < coeffs->n_channels; i++) {
+		float * BW_RESTRICT b = state->buf + i * coeffs->stride;
+		for (size_t j = 0; j < coeffs->stride; j++)
+			b[j] = x_0[i];
+	}
+	state->wr = (uint32_t)coeffs->target;
+	state->rd = 0;
+	state->frac = 0;
+	state->step = coeffs->step;
+	state->fill_z1 = coeffs->target;
+	state->fill = coeffs->target;
+	state->integ = 0.f;
+	state->dev = 0.f;
+	state->n_overruns = 0;
+	state->n_underruns = 0;
+	if (y_0 != BW_NULL)
+		for (size_t i = 0; i < coeffs->n_channels; i++)
+			y_0[i] = x_0[i];
+
+#ifdef BW_DEBUG_DEEP
+	state->state = bw_asrc_state_state_reset_state;
+	state->coeffs_reset_id = coeffs->reset_id;
+#endif
+	BW_ASSERT_DEEP(bw_asrc_coeffs_is_valid(coeffs));
+	BW_ASSERT_DEEP(coeffs->state >= bw_asrc_coeffs_state_reset_coeffs);
+	BW_ASSERT_DEEP(bw_asrc_state_is_valid(coeffs, state));
+	BW_ASSERT_DEEP(state->state == bw_asrc_state_state_reset_state);
+	BW_ASSERT_DEEP(y_0 != BW_NULL ? bw_has_only_finite(y_0, coeffs->n_channels) : 1);
+}
+
+static inline void bw_asrc_update_coeffs_ctrl(
+		bw_asrc_coeffs * BW_RESTRICT coeffs) {
+	BW_ASSERT(coeffs != BW_NULL);
+	BW_ASSERT_DEEP(bw_asrc_coeffs_is_valid(coeffs));
+	BW_ASSERT_DEEP(coeffs->state >= bw_asrc_coeffs_state_reset_coeffs);
+
+	bw_asrc_do_update_coeffs_ctrl(coeffs);
+
+	BW_ASSERT_DEEP(bw_asrc_coeffs_is_valid(coeffs));
+	BW_ASSERT_DEEP(coeffs->state >= bw_asrc_coeffs_state_reset_coeffs);
+}
+
+static inline size_t bw_asrc_write(
+		const bw_asrc_coeffs * BW_RESTRICT coeffs,
+		bw_asrc_state * BW_RESTRICT        state,
+		const float * const *              x,
+		size_t                             n_samples) {
+	BW_ASSERT(coeffs != BW_NULL);
+	BW_ASSERT_DEEP(bw_asrc_coeffs_is_valid(coeffs));
+	BW_ASSERT_DEEP(coeffs->state >= bw_asrc_coeffs_state_reset_coeffs);
+	BW_ASSERT(state != BW_NULL);
+	BW_ASSERT_DEEP(state->state >= bw_asrc_state_state_reset_state);
+	BW_ASSERT(x != BW_NULL);
+
+	const uint32_t wr = state->wr;
+	const int32_t used = (int32_t)(wr - bw_atomic_load(&state->rd));
+	const size_t space = coeffs->len - (used > 0 ? (size_t)used : 0);
+	const size_t n = n_samples < space ? n_samples : space;
+	const size_t n_taps = coeffs->sinc_coeffs.n_taps;
+	for (size_t i = 0; i < coeffs->n_channels; i++) {
+		BW_ASSERT(x[i] != BW_NULL);
+		BW_ASSERT_DEEP(bw_has_only_finite(x[i], n_samples));
+		float * BW_RESTRICT b = state->buf + i * coeffs->stride;
+		size_t idx = wr & coeffs->mask;
+		for (size_t j = 0; j < n; j++) {
+			b[idx] = x[i][j];
+			if (idx < n_taps)
+				b[coeffs->len + idx] = x[i][j];
+			idx = (idx + 1) & coeffs->mask;
+		}
+	}
+	bw_atomic_store(&state->wr, wr + (uint32_t)n);
+	if (n != n_samples)
+		state->n_overruns++;
+
+	BW_ASSERT_DEEP(bw_asrc_coeffs_is_valid(coeffs));
+	BW_ASSERT_DEEP(coeffs->state >= bw_asrc_coeffs_state_reset_coeffs);
+	BW_ASSERT(n <= n_samples);
+
+	return n;
+}
+
+static inline size_t bw_asrc_read(
+		const bw_asrc_coeffs * BW_RESTRICT coeffs,
+		bw_asrc_state * BW_RESTRICT        state,
+		float * const *                    y,
+		size_t                             n_samples) {
+	BW_ASSERT(coeffs != BW_NULL);
+	BW_ASSERT_DEEP(bw_asrc_coeffs_is_valid(coeffs));
+	BW_ASSERT_DEEP(coeffs->state >= bw_asrc_coeffs_state_reset_coeffs);
+	BW_ASSERT(state != BW_NULL);
+	BW_ASSERT_DEEP(state->state >= bw_asrc_state_state_reset_state);
+	BW_ASSERT(y != BW_NULL);
+
+	const uint32_t wr = bw_atomic_load(&state->wr);
+	const int32_t n_taps = (int32_t)coeffs->sinc_coeffs.n_taps;
+	uint32_t rd = state->rd;
+	uint32_t frac = state->frac;
+	size_t n = 0;
+	for (; n < n_samples; n++) {
+		if ((int32_t)(wr - rd) < n_taps)
+			break;
+		const size_t idx = rd & coeffs->mask;
+		for (size_t i = 0; i < coeffs->n_channels; i++) {
+			BW_ASSERT(y[i] != BW_NULL);
+			y[i][n] = bw_src_sinc_interp(&coeffs->sinc_coeffs, state->buf + i * coeffs->stride + idx, frac);
+		}
+		const uint64_t p = (uint64_t)frac + state->step;
+		rd += (uint32_t)(p >> 32);
+		frac = (uint32_t)p;
+	}
+	if (n != n_samples) {
+		for (size_t i = 0; i < coeffs->n_channels; i++)
+			for (size_t j = n; j < n_samples; j++)
+				y[i][j] = 0.f;
+		state->n_underruns++;
+	}
+	state->frac = frac;
+	bw_atomic_store(&state->rd, rd);
+
+	// ratio update
+	const float fill = (float)(int32_t)(wr - rd) - (float)frac * (1.f / 4294967296.f);
+	const float k = bw_minf(coeffs->k_lp * (float)n_samples, 1.f);
+	state->fill_z1 += k * (fill - state->fill_z1);
+	state->fill += k * (state->fill_z1 - state->fill);
+	const float e = (state->fill - coeffs->target) / coeffs->fs_in;
+	const float dt = (float)n_samples / coeffs->fs_out;
+	state->integ = bw_clipf(state->integ + coeffs->ki * e * dt, -coeffs->max_dev, coeffs->max_dev);
+	state->dev = bw_clipf(coeffs->kp * e + state->integ, -coeffs->max_dev, coeffs->max_dev);
+	state->step = (uint64_t)((int64_t)coeffs->step + (int64_t)(state->dev * coeffs->step_f));
+
+	BW_ASSERT_DEEP(bw_asrc_coeffs_is_valid(coeffs));
+	BW_ASSERT_DEEP(coeffs->state >= bw_asrc_coeffs_state_reset_coeffs);
+	BW_ASSERT_DEEP(bw_asrc_state_is_valid(coeffs, state));
+	BW_ASSERT(n <= n_samples);
+
+	return n;
+}
+
+static inline void bw_asrc_set_target_fill(
+		bw_asrc_coeffs * BW_RESTRICT coeffs,
+		float                        value) {
+	BW_ASSERT(coeffs != BW_NULL);
+	BW_ASSERT_DEEP(bw_asrc_coeffs_is_valid(coeffs));
+	BW_ASSERT_DEEP(coeffs->state >= bw_asrc_coeffs_state_init);
+	BW_ASSERT(bw_is_finite(value));
+	BW_ASSERT(value >= 0.125f && value <= 0.875f);
+
+	coeffs->target_fill = value;
+
+	BW_ASSERT_DEEP(bw_asrc_coeffs_is_valid(coeffs));
+	BW_ASSERT_DEEP(coeffs->state >= bw_asrc_coeffs_state_init);
+}
+
+static inline void bw_asrc_set_bandwidth(
+		bw_asrc_coeffs * BW_RESTRICT coeffs,
+		float                        value) {
+	BW_ASSERT(coeffs != BW_NULL);
+	BW_ASSERT_DEEP(bw_asrc_coeffs_is_valid(coeffs));
+	BW_ASSERT_DEEP(coeffs->state >= bw_asrc_coeffs_state_init);
+	BW_ASSERT(bw_is_finite(value));
+	BW_ASSERT(value >= 0.001f && value <= 1.f);
+
+	coeffs->bandwidth = value;
+
+	BW_ASSERT_DEEP(bw_asrc_coeffs_is_valid(coeffs));
+	BW_ASSERT_DEEP(coeffs->state >= bw_asrc_coeffs_state_init);
+}
+
+static inline void bw_asrc_set_max_deviation(
+		bw_asrc_coeffs * BW_RESTRICT coeffs,
+		float                        value) {
+	BW_ASSERT(coeffs != BW_NULL);
+	BW_ASSERT_DEEP(bw_asrc_coeffs_is_valid(coeffs));
+	BW_ASSERT_DEEP(coeffs->state >= bw_asrc_coeffs_state_init);
+	BW_ASSERT(bw_is_finite(value));
+	BW_ASSERT(value >= 0.f && value <= 0.1f);
+
+	coeffs->max_dev = value;
+
+	BW_ASSERT_DEEP(bw_asrc_coeffs_is_valid(coeffs));
+	BW_ASSERT_DEEP(coeffs->state >= bw_asrc_coeffs_state_init);
+}
+
+static inline float bw_asrc_get_ratio(
+		const bw_asrc_coeffs * BW_RESTRICT coeffs,
+		const bw_asrc_state * BW_RESTRICT  state) {
+	BW_ASSERT(coeffs != BW_NULL);
+	BW_ASSERT_DEEP(bw_asrc_coeffs_is_valid(coeffs));
+	BW_ASSERT_DEEP(coeffs->state >= bw_asrc_coeffs_state_reset_coeffs);
+	BW_ASSERT(state != BW_NULL);
+	BW_ASSERT_DEEP(bw_asrc_state_is_valid(coeffs, state));
+	BW_ASSERT_DEEP(state->state >= bw_asrc_state_state_reset_state);
+
+	return coeffs->fs_out / (coeffs->fs_in * (1.f + state->dev));
+}
+
+static inline float bw_asrc_get_fill(
+		const bw_asrc_coeffs * BW_RESTRICT coeffs,
+		const bw_asrc_state * BW_RESTRICT  state) {
+	BW_ASSERT(coeffs != BW_NULL);
+	BW_ASSERT_DEEP(bw_asrc_coeffs_is_valid(coeffs));
+	BW_ASSERT(state != BW_NULL);
+	BW_ASSERT_DEEP(bw_asrc_state_is_valid(coeffs, state));
+	BW_ASSERT_DEEP(state->state >= bw_asrc_state_state_reset_state);
+
+	(void)coeffs;
+	return state->fill;
+}
+
+static inline uint32_t bw_asrc_get_n_overruns(
+		const bw_asrc_state * BW_RESTRICT state) {
+	BW_ASSERT(state != BW_NULL);
+	BW_ASSERT_DEEP(bw_asrc_state_is_valid(BW_NULL, state));
+	BW_ASSERT_DEEP(state->state >= bw_asrc_state_state_reset_state);
+
+	return state->n_overruns;
+}
+
+static inline uint32_t bw_asrc_get_n_underruns(
+		const bw_asrc_state * BW_RESTRICT state) {
+	BW_ASSERT(state != BW_NULL);
+	BW_ASSERT_DEEP(bw_asrc_state_is_valid(BW_NULL, state));
+	BW_ASSERT_DEEP(state->state >= bw_asrc_state_state_reset_state);
+
+	return state->n_underruns;
+}
+
+static inline char bw_asrc_coeffs_is_valid(
+		const bw_asrc_coeffs * BW_RESTRICT coeffs) {
+	BW_ASSERT(coeffs != BW_NULL);
+
+#ifdef BW_DEBUG_DEEP
+	if (coeffs->hash != bw_hash_sdbm("bw_asrc_coeffs"))
+		return 0;
+	if (coeffs->state < bw_asrc_coeffs_state_init || coeffs->state > bw_asrc_coeffs_state_reset_coeffs)
+		return 0;
+#endif
+
+	if (coeffs->n_channels == 0)
+		return 0;
+	if (coeffs->len < 512 || coeffs->len > ((size_t)1 << 30) || (coeffs->len & coeffs->mask) != 0 || coeffs->mask != coeffs->len - 1)
+		return 0;
+	if (!bw_is_finite(coeffs->target_fill) || coeffs->target_fill < 0.125f || coeffs->target_fill > 0.875f)
+		return 0;
+	if (!bw_is_finite(coeffs->bandwidth) || coeffs->bandwidth < 0.001f || coeffs->bandwidth > 1.f)
+		return 0;
+	if (!bw_is_finite(coeffs->max_dev) || coeffs->max_dev < 0.f || coeffs->max_dev > 0.1f)
+		return 0;
+
+#ifdef BW_DEBUG_DEEP
+	if (coeffs->state >= bw_asrc_coeffs_state_set_sample_rates) {
+		if (!bw_is_finite(coeffs->fs_in) || coeffs->fs_in <= 0.f || !bw_is_finite(coeffs->fs_out) || coeffs->fs_out <= 0.f)
+			return 0;
+		if (coeffs->stride != coeffs->len + coeffs->sinc_coeffs.n_taps || coeffs->step == 0)
+			return 0;
+	}
+
+	if (coeffs->state >= bw_asrc_coeffs_state_reset_coeffs) {
+		if (!bw_is_finite(coeffs->target) || coeffs->target < (float)coeffs->sinc_coeffs.n_taps || coeffs->target > (float)coeffs->len)
+			return 0;
+		if (!bw_is_finite(coeffs->k_lp) || coeffs->k_lp <= 0.f)
+			return 0;
+		if (!bw_is_finite(coeffs->kp) || coeffs->kp <= 0.f)
+			return 0;
+		if (!bw_is_finite(coeffs->ki) || coeffs->ki <= 0.f)
+			return 0;
+	}
+#endif
+
+	return 1;
+}
+
+static inline char bw_asrc_state_is_valid(
+		const bw_asrc_coeffs * BW_RESTRICT coeffs,
+		const bw_asrc_state * BW_RESTRICT  state) {
+	BW_ASSERT(state != BW_NULL);
+
+#ifdef BW_DEBUG_DEEP
+	if (state->hash != bw_hash_sdbm("bw_asrc_state"))
+		return 0;
+	if (state->state < bw_asrc_state_state_mem_set || state->state > bw_asrc_state_state_reset_state)
+		return 0;
+
+	if (state->state >= bw_asrc_state_state_reset_state) {
+		if (coeffs != BW_NULL && coeffs->reset_id != state->coeffs_reset_id)
+			return 0;
+
+		if (!bw_is_finite(state->fill_z1) || !bw_is_finite(state->fill) || !bw_is_finite(state->integ) || !bw_is_finite(state->dev))
+			return 0;
+	}
+#endif
+
+	(void)coeffs;
+
+	return state->buf != BW_NULL;
+}
+
+#ifdef __cplusplus
+}
+
+namespace Brickworks {
+
+/*** Public C++ API ***/
+
+/*! api_cpp {{{
+ *    ##### Brickworks::ASRC
+ *  ```>>> */
+template<size_t N_CHANNELS>
+class ASRC {
+public:
+	ASRC(
+		size_t              fifoLen = 8192,
+		bw_src_sinc_quality quality = bw_src_sinc_quality_high);
+
+	~ASRC();
+
+	void setSampleRates(
+		float inSampleRate,
+		float outSampleRate);
+
+	void reset(
+		float               x0 = 0.f,
+		float * BW_RESTRICT y0 = nullptr);
+
+	void reset(
+		const float * x0,
+		float *       y0 = nullptr);
+
+	size_t write(
+		const float * const * x,
+		size_t                nSamples);
+
+	size_t read(
+		float * const * y,
+		size_t          nSamples);
+
+	void setTargetFill(
+		float value);
+
+	void setBandwidth(
+		float value);
+
+	void setMaxDeviation(
+		float value);
+
+	float getRatio();
+
+	float getFill();
+
+	uint32_t getNOverruns();
+
+	uint32_t getNUnderruns();
+/*! <<<...
+ *  }
+ *  ```
+ *
+ *    `write()` and `read()` can be called concurrently from two different
+ *    threads. Setters must be called from the same thread that calls
+ *    `read()`, and do not take effect before the next call to `read()`.
+ *  }}} */
+
+/*** Implementation ***/
+
+/* WARNING: This part of the file is not part of the public API. Its content may
+ * change at any time in future versions. Please, do not use it directly. */
+
+private:
+	bw_asrc_coeffs			coeffs;
+	bw_asrc_state			state;
+	void * BW_RESTRICT		mem;
+	bool				changed;
+};
+
+template<size_t N_CHANNELS>
+inline ASRC<N_CHANNELS>::ASRC(
+		size_t              fifoLen,
+		bw_src_sinc_quality quality) {
+	bw_asrc_init(&coeffs, N_CHANNELS, fifoLen, quality);
+	mem = nullptr;
+	changed = false;
+}
+
+template<size_t N_CHANNELS>
+inline ASRC<N_CHANNELS>::~ASRC() {
+	if (mem != nullptr)
+		operator delete(mem);
+}
+
+template<size_t N_CHANNELS>
+inline void ASRC<N_CHANNELS>::setSampleRates(
+		float inSampleRate,
+		float outSampleRate) {
+	bw_asrc_set_sample_rates(&coeffs, inSampleRate, outSampleRate);
+	size_t req = bw_asrc_mem_req(&coeffs);
+	if (mem != nullptr)
+		operator delete(mem);
+	mem = operator new(req);
+	bw_asrc_mem_set(&coeffs, &state, mem);
+}
+
+template<size_t N_CHANNELS>
+inline void ASRC<N_CHANNELS>::reset(
+		float               x0,
+		float * BW_RESTRICT y0) {
+	float x[N_CHANNELS];
+	for (size_t i = 0; i < N_CHANNELS; i++)
+		x[i] = x0;
+	reset(x, y0);
+}
+
+template<size_t N_CHANNELS>
+inline void ASRC<N_CHANNELS>::reset(
+		const float * x0,
+		float *       y0) {
+	bw_asrc_reset_coeffs(&coeffs);
+	bw_asrc_reset_state(&coeffs, &state, x0, y0);
+	changed = false;
+}
+
+template<size_t N_CHANNELS>
+inline size_t ASRC<N_CHANNELS>::write(
+		const float * const * x,
+		size_t                nSamples) {
+	return bw_asrc_write(&coeffs, &state, x, nSamples);
+}
+
+template<size_t N_CHANNELS>
+inline size_t ASRC<N_CHANNELS>::read(
+		float * const * y,
+		size_t          nSamples) {
+	if (changed) {
+		bw_asrc_update_coeffs_ctrl(&coeffs);
+		changed = false;
+	}
+	return bw_asrc_read(&coeffs, &state, y, nSamples);
+}
+
+template<size_t N_CHANNELS>
+inline void ASRC<N_CHANNELS>::setTargetFill(
+		float value) {
+	bw_asrc_set_target_fill(&coeffs, value);
+	changed = true;
+}
+
+template<size_t N_CHANNELS>
+inline void ASRC<N_CHANNELS>::setBandwidth(
+		float value) {
+	bw_asrc_set_bandwidth(&coeffs, value);
+	changed = true;
+}
+
+template<size_t N_CHANNELS>
+inline void ASRC<N_CHANNELS>::setMaxDeviation(
+		float value) {
+	bw_asrc_set_max_deviation(&coeffs, value);
+	changed = true;
+}
+
+template<size_t N_CHANNELS>
+inline float ASRC<N_CHANNELS>::getRatio() {
+	return bw_asrc_get_ratio(&coeffs, &state);
+}
+
+template<size_t N_CHANNELS>
+inline float ASRC<N_CHANNELS>::getFill() {
+	return bw_asrc_get_fill(&coeffs, &state);
+}
+
+template<size_t N_CHANNELS>
+inline uint32_t ASRC<N_CHANNELS>::getNOverruns() {
+	return bw_asrc_get_n_overruns(&state);
+}
+
+template<size_t N_CHANNELS>
+inline uint32_t ASRC<N_CHANNELS>::getNUnderruns() {
+	return bw_asrc_get_n_underruns(&state);
+}
+
+}
+#endif
+
+#endif
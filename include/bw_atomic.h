@@ -0,0 +1,221 @@
+/*
+ * Brickworks
+ *
+ * Copyright (C) 2024 Orastron Srl unipersonale
+ *
+ * Brickworks is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3 of the License.
+ *
+ * Brickworks is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Brickworks.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * File author: Stefano D'Angelo
+ */
+
+/*!
+ *  module_type {{{ utility }}}
+ *  version {{{ 1.0.0 }}}
+ *  requires {{{ bw_common }}}
+ *  description {{{
+ *    Minimal set of lock-free atomic operations on 32-bit unsigned integers,
+ *    meant to be used by modules that exchange data between threads.
+ *
+ *    All functions in this module are [reentrant](api#reentrant-function),
+ *    [RT-safe](api#rt-safe-function), and
+ *    [thread-safe](api#thread-safe-function).
+ *
+ *    Operations are implemented using GCC/Clang `__atomic` builtins or MSVC
+ *    `_Interlocked*` intrinsics. If neither is available you can provide your
+ *    own implementation by defining all of `BW_ATOMIC_LOAD`,
+ *    `BW_ATOMIC_STORE`, `BW_ATOMIC_EXCHANGE`, `BW_ATOMIC_FETCH_ADD`, and
+ *    `BW_ATOMIC_COMPARE_EXCHANGE` before including this file, with the same
+ *    semantics as the corresponding functions below.
+ *  }}}
+ *  changelog {{{
+ *    <ul>
+ *      <li>Version <strong>1.0.0</strong>:
+ *        <ul>
+ *          <li>First release.</li>
+ *        </ul>
+ *      </li>
+ *    </ul>
+ *  }}}
+ */
+
+#ifndef BW_ATOMIC_H
+#define BW_ATOMIC_H
+
+#include <bw_common.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*** Public API ***/
+
+/*! api {{{
+ *    #### bw_atomic_load()
+ *  ```>>> */
+static inline uint32_t bw_atomic_load(
+	const uint32_t * x);
+/*! <<<```
+ *    Atomically reads and returns the value pointed to by `x` with acquire
+ *    semantics.
+ *
+ *    #### bw_atomic_store()
+ *  ```>>> */
+static inline void bw_atomic_store(
+	uint32_t * x,
+	uint32_t   value);
+/*! <<<```
+ *    Atomically writes `value` into the location pointed to by `x` with release
+ *    semantics.
+ *
+ *    #### bw_atomic_exchange()
+ *  ```>>> */
+static inline uint32_t bw_atomic_exchange(
+	uint32_t * x,
+	uint32_t   value);
+/*! <<<```
+ *    Atomically replaces the value pointed to by `x` with `value` with
+ *    acquire-release semantics.
+ *
+ *    Returns the previous value.
+ *
+ *    #### bw_atomic_fetch_add()
+ *  ```>>> */
+static inline uint32_t bw_atomic_fetch_add(
+	uint32_t * x,
+	uint32_t   value);
+/*! <<<```
+ *    Atomically adds `value` to the value pointed to by `x` (wrapping around on
+ *    overflow) with acquire-release semantics.
+ *
+ *    Returns the previous value.
+ *
+ *    #### bw_atomic_compare_exchange()
+ *  ```>>> */
+static inline char bw_atomic_compare_exchange(
+	uint32_t * x,
+	uint32_t * expected,
+	uint32_t   desired);
+/*! <<<```
+ *    Atomically compares the value pointed to by `x` with the one pointed to by
+ *    `expected` and, if they are equal, replaces the former with `desired`
+ *    (acquire-release semantics). Otherwise, the current value pointed to by
+ *    `x` is written into `expected` (acquire semantics).
+ *
+ *    Returns non-`0` if the replacement happened, `0` otherwise.
+ *  }}} */
+
+#ifdef __cplusplus
+}
+#endif
+
+/*** Implementation ***/
+
+/* WARNING: This part of the file is not part of the public API. Its content may
+ * change at any time in future versions. Please, do not use it directly. */
+
+#if !defined(BW_ATOMIC_LOAD) || !defined(BW_ATOMIC_STORE) \
+	|| !defined(BW_ATOMIC_EXCHANGE) || !defined(BW_ATOMIC_FETCH_ADD) \
+	|| !defined(BW_ATOMIC_COMPARE_EXCHANGE)
+# if defined(__GNUC__) || defined(__clang__)
+#  define BW_ATOMIC_LOAD(x) \
+	__atomic_load_n(x, __ATOMIC_ACQUIRE)
+#  define BW_ATOMIC_STORE(x, value) \
+	__atomic_store_n(x, value, __ATOMIC_RELEASE)
+#  define BW_ATOMIC_EXCHANGE(x, value) \
+	__atomic_exchange_n(x, value, __ATOMIC_ACQ_REL)
+#  define BW_ATOMIC_FETCH_ADD(x, value) \
+	__atomic_fetch_add(x, value, __ATOMIC_ACQ_REL)
+#  define BW_ATOMIC_COMPARE_EXCHANGE(x, expected, desired) \
+	__atomic_compare_exchange_n(x, expected, desired, 0, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)
+# elif defined(_MSC_VER)
+#  include <intrin.h>
+#  define BW_ATOMIC_MSVC
+#  define BW_ATOMIC_LOAD(x) \
+	((uint32_t)_InterlockedOr((volatile long *)(x), 0))
+#  define BW_ATOMIC_STORE(x, value) \
+	((void)_InterlockedExchange((volatile long *)(x), (long)(value)))
+#  define BW_ATOMIC_EXCHANGE(x, value) \
+	((uint32_t)_InterlockedExchange((volatile long *)(x), (long)(value)))
+#  define BW_ATOMIC_FETCH_ADD(x, value) \
+	((uint32_t)_InterlockedExchangeAdd((volatile long *)(x), (long)(value)))
+#  define BW_ATOMIC_COMPARE_EXCHANGE(x, expected, desired) \
+	bw_atomic_msvc_compare_exchange(x, expected, desired)
+# else
+#  error No atomic operations available, please define BW_ATOMIC_{LOAD,STORE,EXCHANGE,FETCH_ADD,COMPARE_EXCHANGE}
+# endif
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifdef BW_ATOMIC_MSVC
+static inline char bw_atomic_msvc_compare_exchange(
+		uint32_t * x,
+		uint32_t * expected,
+		uint32_t   desired) {
+	const long e = (long)*expected;
+	const long v = _InterlockedCompareExchange((volatile long *)x, (long)desired, e);
+	if (v == e)
+		return 1;
+	*expected = (uint32_t)v;
+	return 0;
+}
+#endif
+
+static inline uint32_t bw_atomic_load(
+		const uint32_t * x) {
+	BW_ASSERT(x != BW_NULL);
+
+	return BW_ATOMIC_LOAD((uint32_t *)x);
+}
+
+static inline void bw_atomic_store(
+		uint32_t * x,
+		uint32_t   value) {
+	BW_ASSERT(x != BW_NULL);
+
+	BW_ATOMIC_STORE(x, value);
+}
+
+static inline uint32_t bw_atomic_exchange(
+		uint32_t * x,
+		uint32_t   value) {
+	BW_ASSERT(x != BW_NULL);
+
+	return BW_ATOMIC_EXCHANGE(x, value);
+}
+
+static inline uint32_t bw_atomic_fetch_add(
+		uint32_t * x,
+		uint32_t   value) {
+	BW_ASSERT(x != BW_NULL);
+
+	return BW_ATOMIC_FETCH_ADD(x, value);
+}
+
+static inline char bw_atomic_compare_exchange(
+		uint32_t * x,
+		uint32_t * expected,
+		uint32_t   desired) {
+	BW_ASSERT(x != BW_NULL);
+	BW_ASSERT(expected != BW_NULL);
+
+	return BW_ATOMIC_COMPARE_EXCHANGE(x, expected, desired) ? 1 : 0;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
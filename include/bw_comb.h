@@ -20,7 +20,7 @@
 
 /*!
  *  module_type {{{ dsp }}}
- *  version {{{ 1.1.1 }}}
+ *  version {{{ 1.2.0 }}}
  *  requires {{{
  *    bw_buf bw_common bw_delay bw_gain bw_math bw_one_pole
  *  }}}
@@ -37,6 +37,16 @@
  *  }}}
  *  changelog {{{
  *    <ul>
+ *      <li>Version <strong>1.2.0</strong>:
+ *        <ul>
+ *          <li>Added <code>bw_comb_is_silent()</code> and corresponding C++
+ *              API.</li>
+ *          <li><code>bw_comb_process()</code> and
+ *              <code>bw_comb_process_multi()</code> now stop processing
+ *              once the input is silent and the tail has decayed below
+ *              -120 dB.</li>
+ *        </ul>
+ *      </li>
  *      <li>Version <strong>1.1.1</strong>:
  *        <ul>
  *          <li>Added debugging check in <code>bw_comb_process_multi()</code> to
@@ -313,6 +323,23 @@ static inline void bw_comb_set_coeff_fb(
  *
  *    Default value: `0.f`.
  *
+ *    #### bw_comb_is_silent()
+ *  ```>>> */
+static inline char bw_comb_is_silent(
+	const bw_comb_coeffs * BW_RESTRICT coeffs,
+	const bw_comb_state * BW_RESTRICT  state);
+/*! <<<```
+ *    Returns non-`0` if `state` is currently silent, `0` otherwise.
+ *
+ *    `bw_comb_process()` and `bw_comb_process_multi()` keep track of how long
+ *    the input has been exactly `0.f`. Once that is at least as long as the
+ *    delay line, they check whether the tail has decayed below -120 dB. If so,
+ *    they clear the delay line and consider `state` silent, in which case they
+ *    just zero-fill the output until non-`0.f` input comes in. Processing then
+ *    resumes exactly as from a state reset with `0.f` initial input.
+ *
+ *    `bw_comb_process1()` and `bw_comb_reset_state()` make `state` non-silent.
+ *
  *    #### bw_comb_coeffs_is_valid()
  *  ```>>> */
 static inline char bw_comb_coeffs_is_valid(
@@ -415,6 +442,10 @@ struct bw_comb_state {
 
 	// Sub-components
 	bw_delay_state			delay_state;
+
+	// Silence detection
+	size_t				n_silent;
+	char				silent;
 };
 
 static inline void bw_comb_init(
@@ -575,6 +606,8 @@ static inline float bw_comb_reset_state(
 		bw_delay_reset_state(&coeffs->delay_coeffs, &state->delay_state, v);
 		y = (bw_gain_get_gain_cur(&coeffs->ff_coeffs) + bw_gain_get_gain_cur(&coeffs->blend_coeffs)) * v;
 	}
+	state->n_silent = 0;
+	state->silent = 0;
 
 #ifdef BW_DEBUG_DEEP
 	state->state = bw_comb_state_state_reset_state;
@@ -664,6 +697,7 @@ static inline float bw_comb_process1(
 	bw_delay_write(&coeffs->delay_coeffs, &state->delay_state, v);
 	const float ff = bw_delay_read(&coeffs->delay_coeffs, &state->delay_state, coeffs->dffi, coeffs->dfff);
 	const float y = bw_gain_process1(&coeffs->blend_coeffs, v) + bw_gain_process1(&coeffs->ff_coeffs, ff);
+	state->silent = 0;
 
 	BW_ASSERT_DEEP(bw_comb_coeffs_is_valid(coeffs));
 	BW_ASSERT_DEEP(coeffs->state >= bw_comb_coeffs_state_reset_coeffs);
@@ -674,6 +708,32 @@ static inline float bw_comb_process1(
 	return y;
 }
 
+static inline void bw_comb_silence_track(
+		bw_comb_state * BW_RESTRICT state,
+		const float *               x,
+		size_t                      n_samples) {
+	size_t z = 0;
+	while (z < n_samples && x[n_samples - 1 - z] == 0.f)
+		z++;
+	if (z < n_samples) {
+		state->n_silent = z;
+		state->silent = 0;
+	} else if (!state->silent)
+		state->n_silent += n_samples;
+}
+
+static inline void bw_comb_silence_check(
+		const bw_comb_coeffs * BW_RESTRICT coeffs,
+		bw_comb_state * BW_RESTRICT        state) {
+	if (state->silent || state->n_silent < bw_delay_get_length(&coeffs->delay_coeffs))
+		return;
+	state->n_silent = 0;
+	if (bw_delay_get_peak(&coeffs->delay_coeffs, &state->delay_state) < 1e-6f /* -120 dB */) {
+		bw_delay_reset_state(&coeffs->delay_coeffs, &state->delay_state, 0.f);
+		state->silent = 1;
+	}
+}
+
 static inline void bw_comb_process(
 		bw_comb_coeffs * BW_RESTRICT coeffs,
 		bw_comb_state * BW_RESTRICT  state,
@@ -691,10 +751,18 @@ static inline void bw_comb_process(
 	BW_ASSERT(y != BW_NULL);
 
 	bw_comb_update_coeffs_ctrl(coeffs);
-	for (size_t i = 0; i < n_samples; i++) {
-		bw_comb_update_coeffs_audio(coeffs);
-		y[i] = bw_comb_process1(coeffs, state, x[i]);
-	}
+	bw_comb_silence_track(state, x, n_samples);
+	if (state->silent)
+		for (size_t i = 0; i < n_samples; i++) {
+			bw_comb_update_coeffs_audio(coeffs);
+			y[i] = 0.f;
+		}
+	else
+		for (size_t i = 0; i < n_samples; i++) {
+			bw_comb_update_coeffs_audio(coeffs);
+			y[i] = bw_comb_process1(coeffs, state, x[i]);
+		}
+	bw_comb_silence_check(coeffs, state);
 
 	BW_ASSERT_DEEP(bw_comb_coeffs_is_valid(coeffs));
 	BW_ASSERT_DEEP(coeffs->state >= bw_comb_coeffs_state_reset_coeffs);
@@ -731,11 +799,15 @@ static inline void bw_comb_process_multi(
 #endif
 
 	bw_comb_update_coeffs_ctrl(coeffs);
+	for (size_t j = 0; j < n_channels; j++)
+		bw_comb_silence_track(state[j], x[j], n_samples);
 	for (size_t i = 0; i < n_samples; i++) {
 		bw_comb_update_coeffs_audio(coeffs);
 		for (size_t j = 0; j < n_channels; j++)
-			y[j][i] = bw_comb_process1(coeffs, state[j], x[j][i]);
+			y[j][i] = state[j]->silent ? 0.f : bw_comb_process1(coeffs, state[j], x[j][i]);
 	}
+	for (size_t j = 0; j < n_channels; j++)
+		bw_comb_silence_check(coeffs, state[j]);
 
 	BW_ASSERT_DEEP(bw_comb_coeffs_is_valid(coeffs));
 	BW_ASSERT_DEEP(coeffs->state >= bw_comb_coeffs_state_reset_coeffs);
@@ -812,6 +884,21 @@ static inline void bw_comb_set_coeff_fb(
 	BW_ASSERT_DEEP(coeffs->state >= bw_comb_coeffs_state_init);
 }
 
+static inline char bw_comb_is_silent(
+		const bw_comb_coeffs * BW_RESTRICT coeffs,
+		const bw_comb_state * BW_RESTRICT  state) {
+	BW_ASSERT(coeffs != BW_NULL);
+	BW_ASSERT_DEEP(bw_comb_coeffs_is_valid(coeffs));
+	BW_ASSERT_DEEP(coeffs->state >= bw_comb_coeffs_state_reset_coeffs);
+	BW_ASSERT(state != BW_NULL);
+	BW_ASSERT_DEEP(bw_comb_state_is_valid(coeffs, state));
+	BW_ASSERT_DEEP(state->state >= bw_comb_state_state_reset_state);
+
+	(void)coeffs;
+
+	return state->silent;
+}
+
 static inline char bw_comb_coeffs_is_valid(
 		const bw_comb_coeffs * BW_RESTRICT coeffs) {
 	BW_ASSERT(coeffs != BW_NULL);
@@ -951,6 +1038,9 @@ public:
 
 	void setCoeffFB(
 		float value);
+
+	bool isSilent(
+		size_t channel);
 /*! <<<...
  *  }
  *  ```
@@ -1083,6 +1173,12 @@ inline void Comb<N_CHANNELS>::setCoeffFB(
 	bw_comb_set_coeff_fb(&coeffs, value);
 }
 
+template<size_t N_CHANNELS>
+inline bool Comb<N_CHANNELS>::isSilent(
+		size_t channel) {
+	return bw_comb_is_silent(&coeffs, states + channel);
+}
+
 }
 #endif
 
@@ -20,7 +20,7 @@
 
 /*!
  *  module_type {{{ dsp }}}
- *  version {{{ 1.1.1 }}}
+ *  version {{{ 1.2.0 }}}
  *  requires {{{
  *    bw_common bw_env_follow bw_gain bw_math bw_one_pole
  *  }}}
@@ -29,6 +29,12 @@
  *  }}}
  *  changelog {{{
  *    <ul>
+ *      <li>Version <strong>1.2.0</strong>:
+ *        <ul>
+ *          <li>Added <code>bw_comp_get_gain_reduction_z1()</code> and
+ *              corresponding C++ API.</li>
+ *        </ul>
+ *      </li>
  *      <li>Version <strong>1.1.1</strong>:
  *        <ul>
  *          <li>Added debugging check in <code>bw_comp_process_multi()</code> to
@@ -326,6 +332,19 @@ static inline void bw_comp_set_gain_dB(
  *
  *    Default value: `0.f`.
  *
+ *    #### bw_comp_get_gain_reduction_z1()
+ *  ```>>> */
+static inline float bw_comp_get_gain_reduction_z1(
+	const bw_comp_coeffs * BW_RESTRICT coeffs,
+	const bw_comp_state * BW_RESTRICT  state);
+/*! <<<```
+ *    Returns the gain (linear ratio, in (`0.f`, `1.f`]) applied by compression
+ *    to the last processed sample using `coeffs` and `state`, not including
+ *    the output makeup gain.
+ *
+ *    It is meant for metering and can be called once per block rather than
+ *    per sample, e.g., to feed a `bw_snapshot`.
+ *
  *    #### bw_comp_coeffs_is_valid()
  *  ```>>> */
 static inline char bw_comp_coeffs_is_valid(
@@ -796,6 +815,23 @@ static inline void bw_comp_set_gain_dB(
 	BW_ASSERT_DEEP(coeffs->state >= bw_comp_coeffs_state_init);
 }
 
+static inline float bw_comp_get_gain_reduction_z1(
+		const bw_comp_coeffs * BW_RESTRICT coeffs,
+		const bw_comp_state * BW_RESTRICT  state) {
+	BW_ASSERT(coeffs != BW_NULL);
+	BW_ASSERT_DEEP(bw_comp_coeffs_is_valid(coeffs));
+	BW_ASSERT_DEEP(coeffs->state >= bw_comp_coeffs_state_reset_coeffs);
+	BW_ASSERT(state != BW_NULL);
+	BW_ASSERT_DEEP(bw_comp_state_is_valid(coeffs, state));
+
+	const float env = bw_env_follow_get_y_z1(&state->env_follow_state);
+	const float y = env > bw_one_pole_get_y_z1(&coeffs->smooth_thresh_state) ? bw_pow2f(coeffs->kc * (coeffs->lt - bw_log2f(env))) : 1.f;
+
+	BW_ASSERT(bw_is_finite(y));
+
+	return y;
+}
+
 static inline char bw_comp_coeffs_is_valid(
 		const bw_comp_coeffs * BW_RESTRICT coeffs) {
 	BW_ASSERT(coeffs != BW_NULL);
@@ -937,6 +973,9 @@ public:
 
 	void setGainDB(
 		float value);
+
+	float getGainReductionZ1(
+		size_t channel);
 /*! <<<...
  *  }
  *  ```
@@ -1083,6 +1122,12 @@ inline void Comp<N_CHANNELS>::setGainDB(
 	bw_comp_set_gain_dB(&coeffs, value);
 }
 
+template<size_t N_CHANNELS>
+inline float Comp<N_CHANNELS>::getGainReductionZ1(
+		size_t channel) {
+	return bw_comp_get_gain_reduction_z1(&coeffs, states + channel);
+}
+
 }
 #endif
 
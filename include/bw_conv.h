@@ -0,0 +1,1058 @@
+/*
+ * Brickworks
+ *
+ * Copyright (C) 2024 Orastron Srl unipersonale
+ *
+ * Brickworks is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3 of the License.
+ *
+ * Brickworks is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Brickworks.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * File author: Stefano D'Angelo
+ */
+
+/*!
+ *  module_type {{{ dsp }}}
+ *  version {{{ 1.0.0 }}}
+ *  requires {{{ bw_atomic bw_common bw_fft }}}
+ *  description {{{
+ *    Zero-latency convolution with long impulse responses (e.g., speaker
+ *    cabinets or rooms).
+ *
+ *    The impulse response is split into non-uniform partitions: the first
+ *    `64` samples are convolved directly in the time domain, then the rest
+ *    is covered by segments of uniform partitions whose length doubles from
+ *    `64` up to `8192` samples, each convolved by the overlap-save method
+ *    using [bw_fft](bw_fft) and a frequency-domain delay line. Input and
+ *    output latency is zero and the computational load per sample is
+ *    roughly logarithmic in the impulse response length.
+ *
+ *    The spectra of impulse response partitions live in coefficient memory
+ *    and are shared by all channels, while frequency-domain delay lines and
+ *    other buffers live in a single memory block per channel.
+ *
+ *    Optionally, segments with partitions of `1024` samples or longer can
+ *    be processed by a background thread, which is not created by this
+ *    module: the audio thread only enqueues work and the user is responsible
+ *    for calling `bw_conv_process_background()` from another thread often
+ *    enough (e.g., once per audio block). If background work is not
+ *    completed in time the audio thread completes it or waits for it.
+ *  }}}
+ *  changelog {{{
+ *    <ul>
+ *      <li>Version <strong>1.0.0</strong>:
+ *        <ul>
+ *          <li>First release.</li>
+ *        </ul>
+ *      </li>
+ *    </ul>
+ *  }}}
+ */
+
+#ifndef BW_CONV_H
+#define BW_CONV_H
+
+#include <bw_common.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*** Public API ***/
+
+/*! api {{{
+ *    #### bw_conv_coeffs
+ *  ```>>> */
+typedef struct bw_conv_coeffs bw_conv_coeffs;
+/*! <<<```
+ *    Coefficients and related.
+ *
+ *    #### bw_conv_state
+ *  ```>>> */
+typedef struct bw_conv_state bw_conv_state;
+/*! <<<```
+ *    Internal state and related.
+ *
+ *    #### bw_conv_init()
+ *  ```>>> */
+static inline void bw_conv_init(
+	bw_conv_coeffs * BW_RESTRICT coeffs,
+	size_t                       max_len,
+	char                         background);
+/*! <<<```
+ *    Initializes `coeffs` to handle impulse responses of up to `max_len`
+ *    samples. If `background` is non-`0`, long partitions are meant to be
+ *    processed by `bw_conv_process_background()`.
+ *
+ *    #### bw_conv_coeffs_mem_req()
+ *  ```>>> */
+static inline size_t bw_conv_coeffs_mem_req(
+	const bw_conv_coeffs * BW_RESTRICT coeffs);
+/*! <<<```
+ *    Returns the size, in bytes, of contiguous memory to be supplied to
+ *    `bw_conv_coeffs_mem_set()` using `coeffs`.
+ *
+ *    #### bw_conv_coeffs_mem_set()
+ *  ```>>> */
+static inline void bw_conv_coeffs_mem_set(
+	bw_conv_coeffs * BW_RESTRICT coeffs,
+	void * BW_RESTRICT           mem);
+/*! <<<```
+ *    Associates the contiguous memory block `mem` to `coeffs`.
+ *
+ *    #### bw_conv_set_ir()
+ *  ```>>> */
+static inline void bw_conv_set_ir(
+	bw_conv_coeffs * BW_RESTRICT coeffs,
+	const float *                ir,
+	size_t                       len);
+/*! <<<```
+ *    Sets the impulse response in `coeffs` to the first `len` samples of `ir`
+ *    (`len` must not exceed `max_len` as given to `bw_conv_init()`) and
+ *    computes the spectra of its partitions.
+ *
+ *    This function is not [RT-safe](api#rt-safe-function). It must not be
+ *    called while any associated state is being processed and all
+ *    associated states must be reset afterwards.
+ *
+ *    #### bw_conv_mem_req()
+ *  ```>>> */
+static inline size_t bw_conv_mem_req(
+	const bw_conv_coeffs * BW_RESTRICT coeffs);
+/*! <<<```
+ *    Returns the size, in bytes, of contiguous memory to be supplied to
+ *    `bw_conv_mem_set()` using `coeffs`.
+ *
+ *    #### bw_conv_mem_set()
+ *  ```>>> */
+static inline void bw_conv_mem_set(
+	const bw_conv_coeffs * BW_RESTRICT coeffs,
+	bw_conv_state * BW_RESTRICT        state,
+	void * BW_RESTRICT                 mem);
+/*! <<<```
+ *    Associates the contiguous memory block `mem` to the given `state` using
+ *    `coeffs`.
+ *
+ *    #### bw_conv_reset_state()
+ *  ```>>> */
+static inline float bw_conv_reset_state(
+	const bw_conv_coeffs * BW_RESTRICT coeffs,
+	bw_conv_state * BW_RESTRICT        state,
+	float                              x_0);
+/*! <<<```
+ *    Resets the given `state` to its initial values using the given `coeffs`
+ *    and the initial input value `x_0`.
+ *
+ *    Returns the corresponding initial output value.
+ *
+ *    This function must not be called while `bw_conv_process_background()`
+ *    is running on `state`.
+ *
+ *    #### bw_conv_reset_state_multi()
+ *  ```>>> */
+static inline void bw_conv_reset_state_multi(
+	const bw_conv_coeffs * BW_RESTRICT              coeffs,
+	bw_conv_state * BW_RESTRICT const * BW_RESTRICT state,
+	const float *                                   x_0,
+	float *                                         y_0,
+	size_t                                          n_channels);
+/*! <<<```
+ *    Resets each of the `n_channels` `state`s to its initial values using the
+ *    given `coeffs` and the corresponding initial input value in the `x_0`
+ *    array.
+ *
+ *    The corresponding initial output values are written into the `y_0`
+ *    array, if not `BW_NULL`.
+ *
+ *    #### bw_conv_process()
+ *  ```>>> */
+static inline void bw_conv_process(
+	const bw_conv_coeffs * BW_RESTRICT coeffs,
+	bw_conv_state * BW_RESTRICT        state,
+	const float *                      x,
+	float *                            y,
+	size_t                             n_samples);
+/*! <<<```
+ *    Processes the first `n_samples` of the input buffer `x` and fills the
+ *    first `n_samples` of the output buffer `y`, while using and updating
+ *    `state` (audio rate only).
+ *
+ *    `x` and `y` can either point to the same buffer or to non-overlapping
+ *    buffers.
+ *
+ *    #### bw_conv_process_multi()
+ *  ```>>> */
+static inline void bw_conv_process_multi(
+	const bw_conv_coeffs * BW_RESTRICT              coeffs,
+	bw_conv_state * BW_RESTRICT const * BW_RESTRICT state,
+	const float * const *                           x,
+	float * const *                                 y,
+	size_t                                          n_channels,
+	size_t                                          n_samples);
+/*! <<<```
+ *    Processes the first `n_samples` of the `n_channels` input buffers `x` and
+ *    fills the first `n_samples` of the `n_channels` output buffers `y`, while
+ *    using and updating each of the `n_channels` `state`s (audio rate only).
+ *
+ *    #### bw_conv_process_background()
+ *  ```>>> */
+static inline size_t bw_conv_process_background(
+	const bw_conv_coeffs * BW_RESTRICT coeffs,
+	bw_conv_state * BW_RESTRICT        state);
+/*! <<<```
+ *    Carries out pending background work on `state` using `coeffs`, if any,
+ *    and returns the number of segments that were processed.
+ *
+ *    This function is meant to be called from a thread other than the one
+ *    calling `bw_conv_process()` or `bw_conv_process_multi()`, which it can
+ *    run concurrently with. It must not be called concurrently with itself
+ *    on the same `state`.
+ *
+ *    #### bw_conv_process_background_multi()
+ *  ```>>> */
+static inline size_t bw_conv_process_background_multi(
+	const bw_conv_coeffs * BW_RESTRICT              coeffs,
+	bw_conv_state * BW_RESTRICT const * BW_RESTRICT state,
+	size_t                                          n_channels);
+/*! <<<```
+ *    Like `bw_conv_process_background()` but for each of the `n_channels`
+ *    `state`s. Returns the total number of segments that were
+ *    processed.
+ *
+ *    #### bw_conv_get_n_late()
+ *  ```>>> */
+static inline uint32_t bw_conv_get_n_late(
+	const bw_conv_state * BW_RESTRICT state);
+/*! <<<```
+ *    Returns the number of times background work on `state` was not
+ *    completed in time and the audio thread had to complete it or wait for it
+ *    since the last reset of `state`.
+ *
+ *    #### bw_conv_coeffs_is_valid()
+ *  ```>>> */
+static inline char bw_conv_coeffs_is_valid(
+	const bw_conv_coeffs * BW_RESTRICT coeffs);
+/*! <<<```
+ *    Tries to determine whether `coeffs` is valid and returns non-`0` if it
+ *    seems to be the case and `0` if it is certainly not. False positives are
+ *    possible, false negatives are not.
+ *
+ *    `coeffs` must at least point to a readable memory block of size greater
+ *    than or equal to that of `bw_conv_coeffs`.
+ *
+ *    #### bw_conv_state_is_valid()
+ *  ```>>> */
+static inline char bw_conv_state_is_valid(
+	const bw_conv_coeffs * BW_RESTRICT coeffs,
+	const bw_conv_state * BW_RESTRICT  state);
+/*! <<<```
+ *    Tries to determine whether `state` is valid and returns non-`0` if it
+ *    seems to be the case and `0` if it is certainly not. False positives are
+ *    possible, false negatives are not.
+ *
+ *    If `coeffs` is not `BW_NULL` extra cross-checks might be performed
+ *    (`state` is supposed to be associated to `coeffs`).
+ *
+ *    `state` must at least point to a readable memory block of size greater
+ *    than or equal to that of `bw_conv_state`.
+ *  }}} */
+
+#ifdef __cplusplus
+}
+#endif
+
+/*** Implementation ***/
+
+/* WARNING: This part of the file is not part of the public API. Its content may
+ * change at any time in future versions. Please, do not use it directly. */
+
+#include <bw_atomic.h>
+#include <bw_fft.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define BW_CONV_HEAD_LEN	64
+#define BW_CONV_MAX_SEGS	8	// partition lengths 64 to 8192
+#define BW_CONV_BG_MIN_LEN	1024
+
+#ifdef BW_DEBUG_DEEP
+enum bw_conv_coeffs_state {
+	bw_conv_coeffs_state_invalid,
+	bw_conv_coeffs_state_init,
+	bw_conv_coeffs_state_mem_set,
+	bw_conv_coeffs_state_set_ir
+};
+#endif
+
+#ifdef BW_DEBUG_DEEP
+enum bw_conv_state_state {
+	bw_conv_state_state_invalid,
+	bw_conv_state_state_mem_set,
+	bw_conv_state_state_reset_state
+};
+#endif
+
+// Segment of n_parts partitions of len samples starting at offset. Apart from
+// the first segment, offset = 2 * len, hence output is needed one block after
+// the input block is complete, which leaves time for background processing.
+typedef struct {
+	size_t				len;
+	size_t				offset;
+	size_t				n_parts;
+	char				background;
+	bw_fft				fft;		// real, 2 * len
+	float * BW_RESTRICT		h;		// n_parts spectra
+	float				sum;		// of impulse response samples
+} bw_conv_seg_coeffs;
+
+typedef struct {
+	float * BW_RESTRICT		in;		// last 2 * len input samples
+	float * BW_RESTRICT		job_in;		// input of pending job
+	float * BW_RESTRICT		fdl;		// frequency-domain delay line
+	float * BW_RESTRICT		acc;
+	float * BW_RESTRICT		out;		// 2 blocks of len samples
+	size_t				fdl_idx;
+	size_t				job_slot;
+	uint32_t			job;		// 0 = idle, 1 = pending, 2 = running
+} bw_conv_seg_state;
+
+struct bw_conv_coeffs {
+#ifdef BW_DEBUG_DEEP
+	uint32_t			hash;
+	enum bw_conv_coeffs_state	state;
+	uint32_t			reset_id;
+#endif
+
+	// Coefficients
+	size_t				n_segs;
+	bw_conv_seg_coeffs		segs[BW_CONV_MAX_SEGS];
+	float				head[BW_CONV_HEAD_LEN];	// reversed
+	float				head_sum;
+
+	// Parameters
+	size_t				max_len;
+	char				background;
+};
+
+struct bw_conv_state {
+#ifdef BW_DEBUG_DEEP
+	uint32_t			hash;
+	enum bw_conv_state_state	state;
+	uint32_t			coeffs_reset_id;
+#endif
+
+	// Sub-components
+	bw_conv_seg_state		segs[BW_CONV_MAX_SEGS];
+
+	// States
+	float				hist[2 * BW_CONV_HEAD_LEN];
+	size_t				hist_idx;
+	size_t				count;
+	uint32_t			n_late;
+};
+
+static inline void bw_conv_init(
+		bw_conv_coeffs * BW_RESTRICT coeffs,
+		size_t                       max_len,
+		char                         background) {
+	BW_ASSERT(coeffs != BW_NULL);
+
+	coeffs->max_len = max_len;
+	coeffs->background = background;
+
+	// 64 samples in time domain, then 3 x 64, 2 x 128, 2 x 256, ...,
+	// 2 x 4096, n x 8192
+	coeffs->n_segs = 0;
+	size_t offset = BW_CONV_HEAD_LEN;
+	for (size_t i = 0; i < BW_CONV_MAX_SEGS && offset < max_len; i++) {
+		bw_conv_seg_coeffs *s = coeffs->segs + i;
+		s->len = (size_t)BW_CONV_HEAD_LEN << i;
+		s->offset = offset;
+		const size_t n_parts = i == BW_CONV_MAX_SEGS - 1 ? (max_len - offset + s->len - 1) / s->len : (i == 0 ? 3 : 2);
+		const size_t n_parts_max = (max_len - offset + s->len - 1) / s->len;
+		s->n_parts = n_parts < n_parts_max ? n_parts : n_parts_max;
+		s->background = background && s->len >= BW_CONV_BG_MIN_LEN;
+		bw_fft_init(&s->fft, 2 * s->len, 1);
+		s->h = BW_NULL;
+		s->sum = 0.f;
+		offset += s->n_parts * s->len;
+		coeffs->n_segs++;
+	}
+	for (size_t i = 0; i < BW_CONV_HEAD_LEN; i++)
+		coeffs->head[i] = 0.f;
+	coeffs->head_sum = 0.f;
+
+#ifdef BW_DEBUG_DEEP
+	coeffs->hash = bw_hash_sdbm("bw_conv_coeffs");
+	coeffs->state = bw_conv_coeffs_state_init;
+	coeffs->reset_id = coeffs->hash + 1;
+#endif
+	BW_ASSERT_DEEP(bw_conv_coeffs_is_valid(coeffs));
+	BW_ASSERT_DEEP(coeffs->state == bw_conv_coeffs_state_init);
+}
+
+static inline size_t bw_conv_coeffs_mem_req(
+		const bw_conv_coeffs * BW_RESTRICT coeffs) {
+	BW_ASSERT(coeffs != BW_NULL);
+	BW_ASSERT_DEEP(bw_conv_coeffs_is_valid(coeffs));
+	BW_ASSERT_DEEP(coeffs->state >= bw_conv_coeffs_state_init);
+
+	size_t req = 0;
+	for (size_t i = 0; i < coeffs->n_segs; i++) {
+		const bw_conv_seg_coeffs *s = coeffs->segs + i;
+		req += bw_fft_mem_req(&s->fft) + s->n_parts * 2 * s->len * sizeof(float);
+	}
+	return req;
+}
+
+static inline void bw_conv_coeffs_mem_set(
+		bw_conv_coeffs * BW_RESTRICT coeffs,
+		void * BW_RESTRICT           mem) {
+	BW_ASSERT(coeffs != BW_NULL);
+	BW_ASSERT_DEEP(bw_conv_coeffs_is_valid(coeffs));
+	BW_ASSERT_DEEP(coeffs->state >= bw_conv_coeffs_state_init);
+	BW_ASSERT(coeffs->n_segs == 0 || mem != BW_NULL);
+
+	char *m = (char *)mem;
+	for (size_t i = 0; i < coeffs->n_segs; i++) {
+		bw_conv_seg_coeffs *s = coeffs->segs + i;
+		bw_fft_mem_set(&s->fft, m);
+		m += bw_fft_mem_req(&s->fft);
+		s->h = (float *)m;
+		m += s->n_parts * 2 * s->len * sizeof(float);
+	}
+
+#ifdef BW_DEBUG_DEEP
+	coeffs->state = bw_conv_coeffs_state_mem_set;
+#endif
+	BW_ASSERT_DEEP(bw_conv_coeffs_is_valid(coeffs));
+	BW_ASSERT_DEEP(coeffs->state == bw_conv_coeffs_state_mem_set);
+}
+
+static inline void bw_conv_set_ir(
+		bw_conv_coeffs * BW_RESTRICT coeffs,
+		const float *                ir,
+		size_t                       len) {
+	BW_ASSERT(coeffs != BW_NULL);
+	BW_ASSERT_DEEP(bw_conv_coeffs_is_valid(coeffs));
+	BW_ASSERT_DEEP(coeffs->state >= bw_conv_coeffs_state_mem_set);
+	BW_ASSERT(len <= coeffs->max_len);
+	BW_ASSERT(len == 0 || ir != BW_NULL);
+	BW_ASSERT_DEEP(len == 0 || bw_has_only_finite(ir, len));
+
+	coeffs->head_sum = 0.f;
+	for (size_t i = 0; i < BW_CONV_HEAD_LEN; i++) {
+		const size_t j = BW_CONV_HEAD_LEN - 1 - i;
+		coeffs->head[i] = j < len ? ir[j] : 0.f;
+		coeffs->head_sum += coeffs->head[i];
+	}
+
+	for (size_t i = 0; i < coeffs->n_segs; i++) {
+		bw_conv_seg_coeffs *s = coeffs->segs + i;
+		// scaled to compensate for unnormalized inverse transform
+		const float k = 0.5f / (float)s->len;
+		s->sum = 0.f;
+		for (size_t p = 0; p < s->n_parts; p++) {
+			float * BW_RESTRICT h = s->h + p * 2 * s->len;
+			const size_t o = s->offset + p * s->len;
+			for (size_t j = 0; j < s->len; j++) {
+				const float v = o + j < len ? ir[o + j] : 0.f;
+				s->sum += v;
+				h[j] = k * v;
+			}
+			for (size_t j = s->len; j < 2 * s->len; j++)
+				h[j] = 0.f;
+			bw_fft_forward(&s->fft, h, h);
+		}
+	}
+
+#ifdef BW_DEBUG_DEEP
+	coeffs->state = bw_conv_coeffs_state_set_ir;
+	coeffs->reset_id++;
+#endif
+	BW_ASSERT_DEEP(bw_conv_coeffs_is_valid(coeffs));
+	BW_ASSERT_DEEP(coeffs->state == bw_conv_coeffs_state_set_ir);
+}
+
+static inline size_t bw_conv_mem_req(
+		const bw_conv_coeffs * BW_RESTRICT coeffs) {
+	BW_ASSERT(coeffs != BW_NULL);
+	BW_ASSERT_DEEP(bw_conv_coeffs_is_valid(coeffs));
+	BW_ASSERT_DEEP(coeffs->state >= bw_conv_coeffs_state_init);
+
+	size_t req = 0;
+	for (size_t i = 0; i < coeffs->n_segs; i++)
+		req += (8 + 2 * coeffs->segs[i].n_parts) * coeffs->segs[i].len;
+	return req * sizeof(float);
+}
+
+static inline void bw_conv_mem_set(
+		const bw_conv_coeffs * BW_RESTRICT coeffs,
+		bw_conv_state * BW_RESTRICT        state,
+		void * BW_RESTRICT                 mem) {
+	BW_ASSERT(coeffs != BW_NULL);
+	BW_ASSERT_DEEP(bw_conv_coeffs_is_valid(coeffs));
+	BW_ASSERT_DEEP(coeffs->state >= bw_conv_coeffs_state_init);
+	BW_ASSERT(state != BW_NULL);
+	BW_ASSERT(coeffs->n_segs == 0 || mem != BW_NULL);
+
+	float *m = (float *)mem;
+	for (size_t i = 0; i < coeffs->n_segs; i++) {
+		const size_t len = coeffs->segs[i].len;
+		bw_conv_seg_state *s = state->segs + i;
+		s->in = m;
+		s->job_in = s->in + 2 * len;
+		s->acc = s->job_in + 2 * len;
+		s->out = s->acc + 2 * len;
+		s->fdl = s->out + 2 * len;
+		m = s->fdl + 2 * coeffs->segs[i].n_parts * len;
+	}
+
+#ifdef BW_DEBUG_DEEP
+	state->hash = bw_hash_sdbm("bw_conv_state");
+	state->state = bw_conv_state_state_mem_set;
+#endif
+	BW_ASSERT_DEEP(bw_conv_coeffs_is_valid(coeffs));
+	BW_ASSERT_DEEP(coeffs->state >= bw_conv_coeffs_state_init);
+	BW_ASSERT_DEEP(bw_conv_state_is_valid(coeffs, state));
+	BW_ASSERT_DEEP(state->state == bw_conv_state_state_mem_set);
+}
+
+static inline float bw_conv_reset_state(
+		const bw_conv_coeffs * BW_RESTRICT coeffs,
+		bw_conv_state * BW_RESTRICT        state,
+		float                              x_0) {
+	BW_ASSERT(coeffs != BW_NULL);
+	BW_ASSERT_DEEP(bw_conv_coeffs_is_valid(coeffs));
+	BW_ASSERT_DEEP(coeffs->state >= bw_conv_coeffs_state_set_ir);
+	BW_ASSERT(state != BW_NULL);
+	BW_ASSERT_DEEP(bw_conv_state_is_valid(coeffs, state));
+	BW_ASSERT_DEEP(state->state >= bw_conv_state_state_mem_set);
+	BW_ASSERT(bw_is_finite(x_0));
+
+	for (size_t i = 0; i < 2 * BW_CONV_HEAD_LEN; i++)
+		state->hist[i] = x_0;
+	state->hist_idx = 0;
+	state->count = 0;
+	state->n_late = 0;
+	float y = coeffs->head_sum * x_0;
+	for (size_t i = 0; i < coeffs->n_segs; i++) {
+		const bw_conv_seg_coeffs *c = coeffs->segs + i;
+		bw_conv_seg_state *s = state->segs + i;
+		const size_t n = 2 * c->len;
+		for (size_t j = 0; j < n; j++)
+			s->in[j] = x_0;
+		// all spectra in the delay line are the same
+		if (x_0 == 0.f)
+			for (size_t j = 0; j < c->n_parts * n; j++)
+				s->fdl[j] = 0.f;
+		else {
+			bw_fft_forward(&c->fft, s->in, s->fdl);
+			for (size_t j = n; j < c->n_parts * n; j++)
+				s->fdl[j] = s->fdl[j - n];
+		}
+		const float v = c->sum * x_0;
+		for (size_t j = 0; j < n; j++)
+			s->out[j] = v;
+		s->fdl_idx = 0;
+		s->job_slot = 0;
+		s->job = 0;
+		y += v;
+	}
+
+#ifdef BW_DEBUG_DEEP
+	state->state = bw_conv_state_state_reset_state;
+	state->coeffs_reset_id = coeffs->reset_id;
+#endif
+	BW_ASSERT_DEEP(bw_conv_coeffs_is_valid(coeffs));
+	BW_ASSERT_DEEP(coeffs->state >= bw_conv_coeffs_state_set_ir);
+	BW_ASSERT_DEEP(bw_conv_state_is_valid(coeffs, state));
+	BW_ASSERT_DEEP(state->state == bw_conv_state_state_reset_state);
+	BW_ASSERT(bw_is_finite(y));
+
+	return y;
+}
+
+static inline void bw_conv_reset_state_multi(
+		const bw_conv_coeffs * BW_RESTRICT              coeffs,
+		bw_conv_state * BW_RESTRICT const * BW_RESTRICT state,
+		const float *                                   x_0,
+		float *                                         y_0,
+		size_t                                          n_channels) {
+	BW_ASSERT(coeffs != BW_NULL);
+	BW_ASSERT_DEEP(bw_conv_coeffs_is_valid(coeffs));
+	BW_ASSERT_DEEP(coeffs->state >= bw_conv_coeffs_state_set_ir);
+	BW_ASSERT(state != BW_NULL);
+	BW_ASSERT(x_0 != BW_NULL);
+
+	if (y_0 != BW_NULL)
+		for (size_t i = 0; i < n_channels; i++)
+			y_0[i] = bw_conv_reset_state(coeffs, state[i], x_0[i]);
+	else
+		for (size_t i = 0; i < n_channels; i++)
+			bw_conv_reset_state(coeffs, state[i], x_0[i]);
+
+	BW_ASSERT_DEEP(bw_conv_coeffs_is_valid(coeffs));
+	BW_ASSERT_DEEP(coeffs->state >= bw_conv_coeffs_state_set_ir);
+	BW_ASSERT_DEEP(y_0 != BW_NULL ? bw_has_only_finite(y_0, n_channels) : 1);
+}
+
+static inline void bw_conv_seg_run(
+		const bw_conv_seg_coeffs * BW_RESTRICT c,
+		bw_conv_seg_state * BW_RESTRICT        s) {
+	const size_t n = 2 * c->len;
+	s->fdl_idx = s->fdl_idx == 0 ? c->n_parts - 1 : s->fdl_idx - 1;
+	bw_fft_forward(&c->fft, s->job_in, s->fdl + s->fdl_idx * n);
+	for (size_t j = 0; j < n; j++)
+		s->acc[j] = 0.f;
+	size_t k = s->fdl_idx;
+	for (size_t p = 0; p < c->n_parts; p++) {
+		bw_fft_mul_add(&c->fft, s->fdl + k * n, c->h + p * n, s->acc);
+		k = k == c->n_parts - 1 ? 0 : k + 1;
+	}
+	bw_fft_inverse(&c->fft, s->acc, s->acc);
+	float * BW_RESTRICT o = s->out + s->job_slot * c->len;
+	for (size_t j = 0; j < c->len; j++)
+		o[j] = s->acc[c->len + j];
+}
+
+static inline void bw_conv_seg_wait(
+		const bw_conv_seg_coeffs * BW_RESTRICT c,
+		bw_conv_state * BW_RESTRICT            state,
+		bw_conv_seg_state * BW_RESTRICT        s) {
+	uint32_t expected = 1;
+	if (bw_atomic_compare_exchange(&s->job, &expected, 2)) {
+		bw_conv_seg_run(c, s);
+		bw_atomic_store(&s->job, 0);
+		state->n_late++;
+	} else if (expected == 2) {
+		while (bw_atomic_load(&s->job) != 0) ;
+		state->n_late++;
+	}
+}
+
+static inline void bw_conv_process(
+		const bw_conv_coeffs * BW_RESTRICT coeffs,
+		bw_conv_state * BW_RESTRICT        state,
+		const float *                      x,
+		float *                            y,
+		size_t                             n_samples) {
+	BW_ASSERT(coeffs != BW_NULL);
+	BW_ASSERT_DEEP(bw_conv_coeffs_is_valid(coeffs));
+	BW_ASSERT_DEEP(coeffs->state >= bw_conv_coeffs_state_set_ir);
+	BW_ASSERT(state != BW_NULL);
+	BW_ASSERT_DEEP(bw_conv_state_is_valid(coeffs, state));
+	BW_ASSERT_DEEP(state->state >= bw_conv_state_state_reset_state);
+	BW_ASSERT(x != BW_NULL);
+	BW_ASSERT_DEEP(bw_has_only_finite(x, n_samples));
+	BW_ASSERT(y != BW_NULL);
+	BW_ASSERT(x == y || x + n_samples <= y || y + n_samples <= x);
+
+	// count wraps around after 2 blocks of the longest partition length
+	const size_t count_mask = ((size_t)BW_CONV_HEAD_LEN << BW_CONV_MAX_SEGS) - 1;
+	for (size_t i = 0; i < n_samples; ) {
+		size_t n = BW_CONV_HEAD_LEN - (state->count & (BW_CONV_HEAD_LEN - 1));
+		n = n < n_samples - i ? n : n_samples - i;
+
+		for (size_t j = 0; j < coeffs->n_segs; j++) {
+			const size_t len = coeffs->segs[j].len;
+			float * BW_RESTRICT in = state->segs[j].in + len + (state->count & (len - 1));
+			for (size_t k = 0; k < n; k++)
+				in[k] = x[i + k];
+		}
+
+		for (size_t k = 0; k < n; k++) {
+			state->hist_idx = (state->hist_idx + 1) & (BW_CONV_HEAD_LEN - 1);
+			state->hist[state->hist_idx] = x[i + k];
+			state->hist[state->hist_idx + BW_CONV_HEAD_LEN] = x[i + k];
+			const float * BW_RESTRICT w = state->hist + state->hist_idx + 1;
+			float v0 = 0.f, v1 = 0.f, v2 = 0.f, v3 = 0.f;
+			for (size_t m = 0; m < BW_CONV_HEAD_LEN; m += 4) {
+				v0 += coeffs->head[m] * w[m];
+				v1 += coeffs->head[m + 1] * w[m + 1];
+				v2 += coeffs->head[m + 2] * w[m + 2];
+				v3 += coeffs->head[m + 3] * w[m + 3];
+			}
+			y[i + k] = (v0 + v1) + (v2 + v3);
+		}
+
+		for (size_t j = 0; j < coeffs->n_segs; j++) {
+			const size_t len = coeffs->segs[j].len;
+			const float * BW_RESTRICT o = state->segs[j].out + (((state->count / len) & 1) * len) + (state->count & (len - 1));
+			for (size_t k = 0; k < n; k++)
+				y[i + k] += o[k];
+		}
+
+		state->count = (state->count + n) & count_mask;
+		i += n;
+
+		for (size_t j = 0; j < coeffs->n_segs; j++) {
+			const bw_conv_seg_coeffs *c = coeffs->segs + j;
+			bw_conv_seg_state *s = state->segs + j;
+			if ((state->count & (c->len - 1)) != 0)
+				continue;
+
+			// result of previous job is about to be played
+			if (c->background)
+				bw_conv_seg_wait(c, state, s);
+
+			for (size_t k = 0; k < 2 * c->len; k++)
+				s->job_in[k] = s->in[k];
+			for (size_t k = 0; k < c->len; k++)
+				s->in[k] = s->in[c->len + k];
+			s->job_slot = ((state->count / c->len) + (j == 0 ? 0 : 1)) & 1;
+
+			if (c->background)
+				bw_atomic_store(&s->job, 1);
+			else
+				bw_conv_seg_run(c, s);
+		}
+	}
+
+	BW_ASSERT_DEEP(bw_conv_coeffs_is_valid(coeffs));
+	BW_ASSERT_DEEP(coeffs->state >= bw_conv_coeffs_state_set_ir);
+	BW_ASSERT_DEEP(state->state >= bw_conv_state_state_reset_state);
+	BW_ASSERT_DEEP(bw_has_only_finite(y, n_samples));
+}
+
+static inline void bw_conv_process_multi(
+		const bw_conv_coeffs * BW_RESTRICT              coeffs,
+		bw_conv_state * BW_RESTRICT const * BW_RESTRICT state,
+		const float * const *                           x,
+		float * const *                                 y,
+		size_t                                          n_channels,
+		size_t                                          n_samples) {
+	BW_ASSERT(coeffs != BW_NULL);
+	BW_ASSERT_DEEP(bw_conv_coeffs_is_valid(coeffs));
+	BW_ASSERT_DEEP(coeffs->state >= bw_conv_coeffs_state_set_ir);
+	BW_ASSERT(state != BW_NULL);
+	BW_ASSERT(x != BW_NULL);
+	BW_ASSERT(y != BW_NULL);
+
+	for (size_t i = 0; i < n_channels; i++)
+		bw_conv_process(coeffs, state[i], x[i], y[i], n_samples);
+
+	BW_ASSERT_DEEP(bw_conv_coeffs_is_valid(coeffs));
+	BW_ASSERT_DEEP(coeffs->state >= bw_conv_coeffs_state_set_ir);
+}
+
+static inline size_t bw_conv_process_background(
+		const bw_conv_coeffs * BW_RESTRICT coeffs,
+		bw_conv_state * BW_RESTRICT        state) {
+	BW_ASSERT(coeffs != BW_NULL);
+	BW_ASSERT_DEEP(bw_conv_coeffs_is_valid(coeffs));
+	BW_ASSERT_DEEP(coeffs->state >= bw_conv_coeffs_state_set_ir);
+	BW_ASSERT(state != BW_NULL);
+
+	size_t n = 0;
+	for (size_t i = 0; i < coeffs->n_segs; i++) {
+		if (!coeffs->segs[i].background)
+			continue;
+		bw_conv_seg_state *s = state->segs + i;
+		uint32_t expected = 1;
+		if (bw_atomic_compare_exchange(&s->job, &expected, 2)) {
+			bw_conv_seg_run(coeffs->segs + i, s);
+			bw_atomic_store(&s->job, 0);
+			n++;
+		}
+	}
+	return n;
+}
+
+static inline size_t bw_conv_process_background_multi(
+		const bw_conv_coeffs * BW_RESTRICT              coeffs,
+		bw_conv_state * BW_RESTRICT const * BW_RESTRICT state,
+		size_t                                          n_channels) {
+	BW_ASSERT(coeffs != BW_NULL);
+	BW_ASSERT_DEEP(bw_conv_coeffs_is_valid(coeffs));
+	BW_ASSERT_DEEP(coeffs->state >= bw_conv_coeffs_state_set_ir);
+	BW_ASSERT(state != BW_NULL);
+
+	size_t n = 0;
+	for (size_t i = 0; i < n_channels; i++)
+		n += bw_conv_process_background(coeffs, state[i]);
+	return n;
+}
+
+static inline uint32_t bw_conv_get_n_late(
+		const bw_conv_state * BW_RESTRICT state) {
+	BW_ASSERT(state != BW_NULL);
+	BW_ASSERT_DEEP(bw_conv_state_is_valid(BW_NULL, state));
+	BW_ASSERT_DEEP(state->state >= bw_conv_state_state_reset_state);
+
+	return state->n_late;
+}
+
+static inline char bw_conv_coeffs_is_valid(
+		const bw_conv_coeffs * BW_RESTRICT coeffs) {
+	BW_ASSERT(coeffs != BW_NULL);
+
+#ifdef BW_DEBUG_DEEP
+	if (coeffs->hash != bw_hash_sdbm("bw_conv_coeffs"))
+		return 0;
+	if (coeffs->state < bw_conv_coeffs_state_init || coeffs->state > bw_conv_coeffs_state_set_ir)
+		return 0;
+#endif
+
+	if (coeffs->n_segs > BW_CONV_MAX_SEGS)
+		return 0;
+	size_t offset = BW_CONV_HEAD_LEN;
+	for (size_t i = 0; i < coeffs->n_segs; i++) {
+		const bw_conv_seg_coeffs *s = coeffs->segs + i;
+		if (s->len != ((size_t)BW_CONV_HEAD_LEN << i) || s->offset != offset || s->n_parts == 0)
+			return 0;
+		if (i != 0 && s->offset != 2 * s->len)
+			return 0;
+		if (s->background && (!coeffs->background || s->len < BW_CONV_BG_MIN_LEN))
+			return 0;
+		if (!bw_fft_is_valid(&s->fft) || bw_fft_get_size(&s->fft) != 2 * s->len)
+			return 0;
+		offset += s->n_parts * s->len;
+	}
+	if (offset < coeffs->max_len)
+		return 0;
+
+#ifdef BW_DEBUG_DEEP
+	if (coeffs->state >= bw_conv_coeffs_state_mem_set)
+		for (size_t i = 0; i < coeffs->n_segs; i++)
+			if (coeffs->segs[i].h == BW_NULL)
+				return 0;
+
+	if (coeffs->state >= bw_conv_coeffs_state_set_ir) {
+		if (!bw_has_only_finite(coeffs->head, BW_CONV_HEAD_LEN) || !bw_is_finite(coeffs->head_sum))
+			return 0;
+		for (size_t i = 0; i < coeffs->n_segs; i++)
+			if (!bw_is_finite(coeffs->segs[i].sum))
+				return 0;
+	}
+#endif
+
+	return 1;
+}
+
+static inline char bw_conv_state_is_valid(
+		const bw_conv_coeffs * BW_RESTRICT coeffs,
+		const bw_conv_state * BW_RESTRICT  state) {
+	BW_ASSERT(state != BW_NULL);
+
+#ifdef BW_DEBUG_DEEP
+	if (state->hash != bw_hash_sdbm("bw_conv_state"))
+		return 0;
+	if (state->state < bw_conv_state_state_mem_set || state->state > bw_conv_state_state_reset_state)
+		return 0;
+
+	if (state->state >= bw_conv_state_state_reset_state) {
+		if (coeffs != BW_NULL && coeffs->reset_id != state->coeffs_reset_id)
+			return 0;
+
+		if (state->hist_idx >= BW_CONV_HEAD_LEN || !bw_has_only_finite(state->hist, 2 * BW_CONV_HEAD_LEN))
+			return 0;
+	}
+#endif
+
+	if (coeffs != BW_NULL)
+		for (size_t i = 0; i < coeffs->n_segs; i++) {
+			const bw_conv_seg_state *s = state->segs + i;
+			if (s->in == BW_NULL || s->job_in == BW_NULL || s->fdl == BW_NULL || s->acc == BW_NULL || s->out == BW_NULL)
+				return 0;
+			if (s->fdl_idx >= coeffs->segs[i].n_parts || s->job_slot > 1)
+				return 0;
+		}
+
+	return 1;
+}
+
+#undef BW_CONV_HEAD_LEN
+#undef BW_CONV_MAX_SEGS
+#undef BW_CONV_BG_MIN_LEN
+
+#ifdef __cplusplus
+}
+
+#ifndef BW_CXX_NO_ARRAY
+# include <array>
+#endif
+
+namespace Brickworks {
+
+/*** Public C++ API ***/
+
+/*! api_cpp {{{
+ *    ##### Brickworks::Conv
+ *  ```>>> */
+template<size_t N_CHANNELS>
+class Conv {
+public:
+	Conv(
+		size_t maxLen,
+		bool   background = false);
+
+	~Conv();
+
+	void setIR(
+		const float * ir,
+		size_t        len);
+
+	void reset(
+		float               x0 = 0.f,
+		float * BW_RESTRICT y0 = nullptr);
+
+#ifndef BW_CXX_NO_ARRAY
+	void reset(
+		float                                       x0,
+		std::array<float, N_CHANNELS> * BW_RESTRICT y0);
+#endif
+
+	void reset(
+		const float * x0,
+		float *       y0 = nullptr);
+
+#ifndef BW_CXX_NO_ARRAY
+	void reset(
+		std::array<float, N_CHANNELS>               x0,
+		std::array<float, N_CHANNELS> * BW_RESTRICT y0 = nullptr);
+#endif
+
+	void process(
+		const float * const * x,
+		float * const *       y,
+		size_t                nSamples);
+
+#ifndef BW_CXX_NO_ARRAY
+	void process(
+		std::array<const float *, N_CHANNELS> x,
+		std::array<float *, N_CHANNELS>       y,
+		size_t                                nSamples);
+#endif
+
+	size_t processBackground();
+
+	uint32_t getNLate(
+		size_t channel);
+/*! <<<...
+ *  }
+ *  ```
+ *
+ *    `processBackground()` can be called from another thread concurrently
+ *    with `process()`.
+ *  }}} */
+
+/*** Implementation ***/
+
+/* WARNING: This part of the file is not part of the public API. Its content may
+ * change at any time in future versions. Please, do not use it directly. */
+
+private:
+	bw_conv_coeffs			coeffs;
+	bw_conv_state			states[N_CHANNELS];
+	bw_conv_state * BW_RESTRICT	statesP[N_CHANNELS];
+	void * BW_RESTRICT		mem;
+};
+
+template<size_t N_CHANNELS>
+inline Conv<N_CHANNELS>::Conv(
+		size_t maxLen,
+		bool   background) {
+	bw_conv_init(&coeffs, maxLen, background);
+	size_t coeffsReq = bw_conv_coeffs_mem_req(&coeffs);
+	size_t req = bw_conv_mem_req(&coeffs);
+	mem = operator new(coeffsReq + req * N_CHANNELS);
+	bw_conv_coeffs_mem_set(&coeffs, mem);
+	void *m = static_cast<char *>(mem) + coeffsReq;
+	for (size_t i = 0; i < N_CHANNELS; i++, m = static_cast<char *>(m) + req) {
+		statesP[i] = states + i;
+		bw_conv_mem_set(&coeffs, states + i, m);
+	}
+}
+
+template<size_t N_CHANNELS>
+inline Conv<N_CHANNELS>::~Conv() {
+	operator delete(mem);
+}
+
+template<size_t N_CHANNELS>
+inline void Conv<N_CHANNELS>::setIR(
+		const float * ir,
+		size_t        len) {
+	bw_conv_set_ir(&coeffs, ir, len);
+}
+
+template<size_t N_CHANNELS>
+inline void Conv<N_CHANNELS>::reset(
+		float               x0,
+		float * BW_RESTRICT y0) {
+	if (y0 != nullptr)
+		for (size_t i = 0; i < N_CHANNELS; i++)
+			y0[i] = bw_conv_reset_state(&coeffs, states + i, x0);
+	else
+		for (size_t i = 0; i < N_CHANNELS; i++)
+			bw_conv_reset_state(&coeffs, states + i, x0);
+}
+
+#ifndef BW_CXX_NO_ARRAY
+template<size_t N_CHANNELS>
+inline void Conv<N_CHANNELS>::reset(
+		float                                       x0,
+		std::array<float, N_CHANNELS> * BW_RESTRICT y0) {
+	reset(x0, y0 != nullptr ? y0->data() : nullptr);
+}
+#endif
+
+template<size_t N_CHANNELS>
+inline void Conv<N_CHANNELS>::reset(
+		const float * x0,
+		float *       y0) {
+	bw_conv_reset_state_multi(&coeffs, statesP, x0, y0, N_CHANNELS);
+}
+
+#ifndef BW_CXX_NO_ARRAY
+template<size_t N_CHANNELS>
+inline void Conv<N_CHANNELS>::reset(
+		std::array<float, N_CHANNELS>               x0,
+		std::array<float, N_CHANNELS> * BW_RESTRICT y0) {
+	reset(x0.data(), y0 != nullptr ? y0->data() : nullptr);
+}
+#endif
+
+template<size_t N_CHANNELS>
+inline void Conv<N_CHANNELS>::process(
+		const float * const * x,
+		float * const *       y,
+		size_t                nSamples) {
+	bw_conv_process_multi(&coeffs, statesP, x, y, N_CHANNELS, nSamples);
+}
+
+#ifndef BW_CXX_NO_ARRAY
+template<size_t N_CHANNELS>
+inline void Conv<N_CHANNELS>::process(
+		std::array<const float *, N_CHANNELS> x,
+		std::array<float *, N_CHANNELS>       y,
+		size_t                                nSamples) {
+	process(x.data(), y.data(), nSamples);
+}
+#endif
+
+template<size_t N_CHANNELS>
+inline size_t Conv<N_CHANNELS>::processBackground() {
+	return bw_conv_process_background_multi(&coeffs, statesP, N_CHANNELS);
+}
+
+template<size_t N_CHANNELS>
+inline uint32_t Conv<N_CHANNELS>::getNLate(
+		size_t channel) {
+	return bw_conv_get_n_late(states + channel);
+}
+
+}
+#endif
+
+#endif
@@ -20,7 +20,7 @@
 
 /*!
  *  module_type {{{ dsp }}}
- *  version {{{ 1.1.1 }}}
+ *  version {{{ 1.2.0 }}}
  *  requires {{{ bw_buf bw_common bw_math }}}
  *  description {{{
  *    Interpolated delay line, not smoothed.
@@ -31,6 +31,21 @@
  *  }}}
  *  changelog {{{
  *    <ul>
+ *      <li>Version <strong>1.2.0</strong>:
+ *        <ul>
+ *          <li>Added <code>bw_delay_set_pow2_length()</code>,
+ *              <code>bw_delay_is_silent()</code>,
+ *              <code>bw_delay_get_peak()</code>, and corresponding C++
+ *              API.</li>
+ *          <li><code>bw_delay_process()</code> and
+ *              <code>bw_delay_process_multi()</code> now skip processing
+ *              when both the delay line and the input are silent.</li>
+ *          <li><code>bw_delay_process()</code> and
+ *              <code>bw_delay_process_multi()</code> now process blocks of
+ *              samples at once for each channel, so that interpolation can
+ *              be vectorized.</li>
+ *        </ul>
+ *      </li>
  *      <li>Version <strong>1.1.1</strong>:
  *        <ul>
  *          <li>Added debugging check in <code>bw_delay_process_multi()</code>
@@ -274,6 +289,24 @@ static inline void bw_delay_set_delay(
  *
  *    Default value: `0.f`.
  *
+ *    #### bw_delay_set_pow2_length()
+ *  ```>>> */
+static inline void bw_delay_set_pow2_length(
+	bw_delay_coeffs * BW_RESTRICT coeffs,
+	char                          value);
+/*! <<<```
+ *    Sets whether the delay line length should be rounded up to a power of 2
+ *    (non-`0`) or not (`0`) in `coeffs`.
+ *
+ *    In the former case, `bw_delay_read()` and `bw_delay_write()` wrap around
+ *    using bit masking rather than comparisons, at the cost of a higher memory
+ *    requirement.
+ *
+ *    This value is only taken into account by
+ *    `bw_delay_set_sample_rate()`.
+ *
+ *    Default value: `0` (off).
+ *
  *    #### bw_delay_get_length()
  *  ```>>> */
 static inline size_t bw_delay_get_length(
@@ -283,6 +316,32 @@ static inline size_t bw_delay_get_length(
  *
  *    `coeffs` must be at least in the "sample-rate-set" state.
  *
+ *    #### bw_delay_is_silent()
+ *  ```>>> */
+static inline char bw_delay_is_silent(
+	const bw_delay_coeffs * BW_RESTRICT coeffs,
+	const bw_delay_state * BW_RESTRICT  state);
+/*! <<<```
+ *    Returns non-`0` if the delay line in `state` only contains zeros, that is
+ *    if the last `bw_delay_get_length()` samples written to it were all `0.f`,
+ *    or `0` otherwise.
+ *
+ *    In such case, `bw_delay_process()` and `bw_delay_process_multi()` just
+ *    zero-fill the output for blocks of silent input, which gives the same
+ *    exact result as processing them.
+ *
+ *    #### bw_delay_get_peak()
+ *  ```>>> */
+static inline float bw_delay_get_peak(
+	const bw_delay_coeffs * BW_RESTRICT coeffs,
+	const bw_delay_state * BW_RESTRICT  state);
+/*! <<<```
+ *    Returns the maximum absolute value of the samples currently stored in the
+ *    delay line in `state`.
+ *
+ *    This function scans the whole delay line, hence it should be called
+ *    sparingly.
+ *
  *    #### bw_delay_coeffs_is_valid()
  *  ```>>> */
 static inline char bw_delay_coeffs_is_valid(
@@ -355,6 +414,7 @@ struct bw_delay_coeffs {
 	// Coefficients
 	float				fs;
 	size_t				len;
+	size_t				mask;
 
 	size_t				di;
 	float				df;
@@ -363,6 +423,7 @@ struct bw_delay_coeffs {
 	float				max_delay;
 	float				delay;
 	char				delay_changed;
+	char				pow2_length;
 };
 
 struct bw_delay_state {
@@ -375,6 +436,7 @@ struct bw_delay_state {
 	// States
 	float * BW_RESTRICT		buf;
 	size_t				idx;
+	size_t				n_zero;		// trailing zeros written, up to len
 };
 
 static inline void bw_delay_init(
@@ -386,6 +448,7 @@ static inline void bw_delay_init(
 
 	coeffs->max_delay = max_delay;
 	coeffs->delay = 0.f;
+	coeffs->pow2_length = 0;
 
 #ifdef BW_DEBUG_DEEP
 	coeffs->hash = bw_hash_sdbm("bw_delay_coeffs");
@@ -406,6 +469,13 @@ static inline void bw_delay_set_sample_rate(
 
 	coeffs->fs = sample_rate;
 	coeffs->len = (size_t)bw_ceilf(coeffs->fs * coeffs->max_delay) + 1;
+	if (coeffs->pow2_length) {
+		size_t len = 1;
+		while (len < coeffs->len)
+			len <<= 1;
+		coeffs->len = len;
+	}
+	coeffs->mask = coeffs->len - 1;
 
 #ifdef BW_DEBUG_DEEP
 	coeffs->state = bw_delay_coeffs_state_set_sample_rate;
@@ -486,6 +556,7 @@ static inline float bw_delay_reset_state(
 
 	bw_buf_fill(x_0, state->buf, coeffs->len);
 	state->idx = 0;
+	state->n_zero = x_0 == 0.f ? coeffs->len : 0;
 	const float y = x_0;
 
 #ifdef BW_DEBUG_DEEP
@@ -545,8 +616,14 @@ static float bw_delay_read(
 	BW_ASSERT(df >= 0.f && df < 1.f);
 	BW_ASSERT(di + df <= coeffs->len);
 
-	const size_t n = (state->idx + (state->idx >= di ? 0 : coeffs->len)) - di;
-	const size_t p = (n ? n : coeffs->len) - 1;
+	size_t n, p;
+	if (coeffs->pow2_length) {
+		n = (state->idx - di) & coeffs->mask;
+		p = (n - 1) & coeffs->mask;
+	} else {
+		n = (state->idx + (state->idx >= di ? 0 : coeffs->len)) - di;
+		p = (n ? n : coeffs->len) - 1;
+	}
 	const float y = state->buf[n] + df * (state->buf[p] - state->buf[n]);
 
 	BW_ASSERT_DEEP(bw_delay_coeffs_is_valid(coeffs));
@@ -570,9 +647,14 @@ static void bw_delay_write(
 	BW_ASSERT_DEEP(state->state >= bw_delay_state_state_reset_state);
 	BW_ASSERT(bw_is_finite(x));
 
-	state->idx++;
-	state->idx = state->idx == coeffs->len ? 0 : state->idx;
+	if (coeffs->pow2_length)
+		state->idx = (state->idx + 1) & coeffs->mask;
+	else {
+		state->idx++;
+		state->idx = state->idx == coeffs->len ? 0 : state->idx;
+	}
 	state->buf[state->idx] = x;
+	state->n_zero = x != 0.f ? 0 : state->n_zero + (state->n_zero < coeffs->len);
 
 	BW_ASSERT_DEEP(bw_delay_coeffs_is_valid(coeffs));
 	BW_ASSERT_DEEP(coeffs->state >= bw_delay_coeffs_state_reset_coeffs);
@@ -625,6 +707,73 @@ static inline float bw_delay_process1(
 	return y;
 }
 
+static inline void bw_delay_do_process(
+		const bw_delay_coeffs * BW_RESTRICT coeffs,
+		bw_delay_state * BW_RESTRICT        state,
+		const float *                       x,
+		float *                             y,
+		size_t                              n_samples) {
+	const size_t len = coeffs->len;
+	const size_t di = coeffs->di;
+	const float df = coeffs->df;
+	float * BW_RESTRICT buf = state->buf;
+
+	size_t z = 0;
+	while (z < n_samples && x[n_samples - 1 - z] == 0.f)
+		z++;
+	if (z == n_samples && state->n_zero == len) {
+		bw_buf_fill(0.f, y, n_samples);
+		return;
+	}
+	const size_t n_zero = z == n_samples ? state->n_zero + n_samples : z;
+
+	// chunks of samples are first written and then read, hence they must not
+	// overwrite samples that are still to be read
+	const size_t c_max = len - di - 1;
+	if (c_max == 0) {
+		for (size_t i = 0; i < n_samples; i++)
+			y[i] = bw_delay_process1(coeffs, state, x[i]);
+		return;
+	}
+
+	for (size_t i = 0; i < n_samples; ) {
+		const size_t c = n_samples - i < c_max ? n_samples - i : c_max;
+		const float *xc = x + i;
+		float *yc = y + i;
+
+		size_t w = state->idx + 1 == len ? 0 : state->idx + 1;
+		for (size_t j = 0; j < c; ) {
+			const size_t r = c - j < len - w ? c - j : len - w;
+			for (size_t k = 0; k < r; k++)
+				buf[w + k] = xc[j + k];
+			j += r;
+			w = w + r == len ? 0 : w + r;
+		}
+
+		size_t n = state->idx + 1 + (state->idx + 1 >= di ? 0 : len) - di;
+		n = n >= len ? n - len : n;
+		for (size_t j = 0; j < c; ) {
+			if (n == 0) {
+				yc[j] = buf[0] + df * (buf[len - 1] - buf[0]);
+				j++;
+				n = 1;
+				continue;
+			}
+			const size_t r = c - j < len - n ? c - j : len - n;
+			for (size_t k = 0; k < r; k++)
+				yc[j + k] = buf[n + k] + df * (buf[n + k - 1] - buf[n + k]);
+			j += r;
+			n = n + r == len ? 0 : n + r;
+		}
+
+		state->idx += c;
+		state->idx = state->idx >= len ? state->idx - len : state->idx;
+		i += c;
+	}
+
+	state->n_zero = n_zero < len ? n_zero : len;
+}
+
 static inline void bw_delay_process(
 		bw_delay_coeffs * BW_RESTRICT coeffs,
 		bw_delay_state * BW_RESTRICT  state,
@@ -642,8 +791,7 @@ static inline void bw_delay_process(
 	BW_ASSERT(y != BW_NULL);
 
 	bw_delay_update_coeffs_ctrl(coeffs);
-	for (size_t i = 0; i < n_samples; i++)
-		y[i] = bw_delay_process1(coeffs, state, x[i]);
+	bw_delay_do_process(coeffs, state, x, y, n_samples);
 
 	BW_ASSERT_DEEP(bw_delay_coeffs_is_valid(coeffs));
 	BW_ASSERT_DEEP(coeffs->state >= bw_delay_coeffs_state_reset_coeffs);
@@ -680,9 +828,8 @@ static inline void bw_delay_process_multi(
 #endif
 
 	bw_delay_update_coeffs_ctrl(coeffs);
-	for (size_t i = 0; i < n_samples; i++)
-		for (size_t j = 0; j < n_channels; j++)
-			y[j][i] = bw_delay_process1(coeffs, state[j], x[j][i]);
+	for (size_t i = 0; i < n_channels; i++)
+		bw_delay_do_process(coeffs, state[i], x[i], y[i], n_samples);
 
 	BW_ASSERT_DEEP(bw_delay_coeffs_is_valid(coeffs));
 	BW_ASSERT_DEEP(coeffs->state >= bw_delay_coeffs_state_reset_coeffs);
@@ -705,6 +852,19 @@ static inline void bw_delay_set_delay(
 	BW_ASSERT_DEEP(coeffs->state >= bw_delay_coeffs_state_init);
 }
 
+static inline void bw_delay_set_pow2_length(
+		bw_delay_coeffs * BW_RESTRICT coeffs,
+		char                          value) {
+	BW_ASSERT(coeffs != BW_NULL);
+	BW_ASSERT_DEEP(bw_delay_coeffs_is_valid(coeffs));
+	BW_ASSERT_DEEP(coeffs->state >= bw_delay_coeffs_state_init);
+
+	coeffs->pow2_length = value;
+
+	BW_ASSERT_DEEP(bw_delay_coeffs_is_valid(coeffs));
+	BW_ASSERT_DEEP(coeffs->state >= bw_delay_coeffs_state_init);
+}
+
 static inline size_t bw_delay_get_length(
 		const bw_delay_coeffs * BW_RESTRICT coeffs) {
 	BW_ASSERT(coeffs != BW_NULL);
@@ -714,6 +874,38 @@ static inline size_t bw_delay_get_length(
 	return coeffs->len;
 }
 
+static inline char bw_delay_is_silent(
+		const bw_delay_coeffs * BW_RESTRICT coeffs,
+		const bw_delay_state * BW_RESTRICT  state) {
+	BW_ASSERT(coeffs != BW_NULL);
+	BW_ASSERT_DEEP(bw_delay_coeffs_is_valid(coeffs));
+	BW_ASSERT_DEEP(coeffs->state >= bw_delay_coeffs_state_reset_coeffs);
+	BW_ASSERT(state != BW_NULL);
+	BW_ASSERT_DEEP(bw_delay_state_is_valid(coeffs, state));
+	BW_ASSERT_DEEP(state->state >= bw_delay_state_state_reset_state);
+
+	return state->n_zero == coeffs->len;
+}
+
+static inline float bw_delay_get_peak(
+		const bw_delay_coeffs * BW_RESTRICT coeffs,
+		const bw_delay_state * BW_RESTRICT  state) {
+	BW_ASSERT(coeffs != BW_NULL);
+	BW_ASSERT_DEEP(bw_delay_coeffs_is_valid(coeffs));
+	BW_ASSERT_DEEP(coeffs->state >= bw_delay_coeffs_state_reset_coeffs);
+	BW_ASSERT(state != BW_NULL);
+	BW_ASSERT_DEEP(bw_delay_state_is_valid(coeffs, state));
+	BW_ASSERT_DEEP(state->state >= bw_delay_state_state_reset_state);
+
+	float v = 0.f;
+	for (size_t i = 0; i < coeffs->len; i++)
+		v = bw_maxf(v, bw_absf(state->buf[i]));
+
+	BW_ASSERT(bw_is_finite(v));
+
+	return v;
+}
+
 static inline char bw_delay_coeffs_is_valid(
 		const bw_delay_coeffs * BW_RESTRICT coeffs) {
 	BW_ASSERT(coeffs != BW_NULL);
@@ -736,6 +928,10 @@ static inline char bw_delay_coeffs_is_valid(
 			return 0;
 		if (coeffs->len == 0)
 			return 0;
+		if (coeffs->mask != coeffs->len - 1)
+			return 0;
+		if (coeffs->pow2_length && (coeffs->len & coeffs->mask) != 0)
+			return 0;
 	}
 
 	if (coeffs->state >= bw_delay_coeffs_state_reset_coeffs) {
@@ -773,6 +969,8 @@ static inline char bw_delay_state_is_valid(
 
 		if (state->idx >= coeffs->len)
 			return 0;
+		if (state->n_zero > coeffs->len)
+			return 0;
 	}
 #endif
 
@@ -839,7 +1037,16 @@ public:
 	void setDelay(
 		float value);
 
+	void setPow2Length(
+		bool value);
+
 	size_t getLength();
+
+	bool isSilent(
+		size_t channel);
+
+	float getPeak(
+		size_t channel);
 /*! <<<...
  *  }
  *  ```
@@ -947,11 +1154,29 @@ inline void Delay<N_CHANNELS>::setDelay(
 	bw_delay_set_delay(&coeffs, value);
 }
 
+template<size_t N_CHANNELS>
+inline void Delay<N_CHANNELS>::setPow2Length(
+		bool value) {
+	bw_delay_set_pow2_length(&coeffs, value);
+}
+
 template<size_t N_CHANNELS>
 inline size_t Delay<N_CHANNELS>::getLength() {
 	return bw_delay_get_length(&coeffs);
 }
 
+template<size_t N_CHANNELS>
+inline bool Delay<N_CHANNELS>::isSilent(
+		size_t channel) {
+	return bw_delay_is_silent(&coeffs, states + channel);
+}
+
+template<size_t N_CHANNELS>
+inline float Delay<N_CHANNELS>::getPeak(
+		size_t channel) {
+	return bw_delay_get_peak(&coeffs, states + channel);
+}
+
 }
 #endif
 
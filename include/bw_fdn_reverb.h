@@ -0,0 +1,1424 @@
+/*
+ * Brickworks
+ *
+ * Copyright (C) 2024 Orastron Srl unipersonale
+ *
+ * Brickworks is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3 of the License.
+ *
+ * Brickworks is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Brickworks.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * File author: Stefano D'Angelo
+ */
+
+/*!
+ *  module_type {{{ dsp }}}
+ *  version {{{ 1.0.0 }}}
+ *  requires {{{
+ *    bw_buf bw_common bw_delay bw_dry_wet bw_lp1 bw_math bw_one_pole
+ *  }}}
+ *  description {{{
+ *    Stereo feedback delay network reverb.
+ *
+ *    It uses either 8 or 16 delay lines, each followed by a first-order
+ *    lowpass damping filter and a decay gain, which are then mixed by a
+ *    normalized Hadamard matrix and fed back into the delay lines together
+ *    with the (predelayed and lowpass filtered) mono sum of the input signals.
+ *
+ *    The processing of all delay lines is performed lane by lane on plain
+ *    arrays, so that reads, damping, decay, and mixing can be vectorized by
+ *    the compiler. All delay lines are stored in a single memory block, one
+ *    frame of samples per time step, which is aligned to 64 bytes internally.
+ *  }}}
+ *  changelog {{{
+ *    <ul>
+ *      <li>Version <strong>1.0.0</strong>:
+ *        <ul>
+ *          <li>First release.</li>
+ *        </ul>
+ *      </li>
+ *    </ul>
+ *  }}}
+ */
+
+#ifndef BW_FDN_REVERB_H
+#define BW_FDN_REVERB_H
+
+#include <bw_common.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*! api {{{
+ *    #### bw_fdn_reverb_coeffs
+ *  ```>>> */
+typedef struct bw_fdn_reverb_coeffs bw_fdn_reverb_coeffs;
+/*! <<<```
+ *    Coefficients and related.
+ *
+ *    #### bw_fdn_reverb_state
+ *  ```>>> */
+typedef struct bw_fdn_reverb_state bw_fdn_reverb_state;
+/*! <<<```
+ *    Internal state and related.
+ *
+ *    #### bw_fdn_reverb_init()
+ *  ```>>> */
+static inline void bw_fdn_reverb_init(
+	bw_fdn_reverb_coeffs * BW_RESTRICT coeffs,
+	size_t                             n_lines);
+/*! <<<```
+ *    Initializes input parameter values in `coeffs` using the given number of
+ *    delay lines `n_lines`, which must be either `8` or `16`.
+ *
+ *    #### bw_fdn_reverb_set_sample_rate()
+ *  ```>>> */
+static inline void bw_fdn_reverb_set_sample_rate(
+	bw_fdn_reverb_coeffs * BW_RESTRICT coeffs,
+	float                              sample_rate);
+/*! <<<```
+ *    Sets the `sample_rate` (Hz) value in `coeffs`.
+ *
+ *    #### bw_fdn_reverb_mem_req()
+ *  ```>>> */
+static inline size_t bw_fdn_reverb_mem_req(
+	const bw_fdn_reverb_coeffs * BW_RESTRICT coeffs);
+/*! <<<```
+ *    Returns the size, in bytes, of contiguous memory to be supplied to
+ *    `bw_fdn_reverb_mem_set()` using `coeffs`.
+ *
+ *    #### bw_fdn_reverb_mem_set()
+ *  ```>>> */
+static inline void bw_fdn_reverb_mem_set(
+	const bw_fdn_reverb_coeffs * BW_RESTRICT coeffs,
+	bw_fdn_reverb_state * BW_RESTRICT        state,
+	void * BW_RESTRICT                       mem);
+/*! <<<```
+ *    Associates the contiguous memory block `mem` to the given `state` using
+ *    `coeffs`.
+ *
+ *    #### bw_fdn_reverb_reset_coeffs()
+ *  ```>>> */
+static inline void bw_fdn_reverb_reset_coeffs(
+	bw_fdn_reverb_coeffs * BW_RESTRICT coeffs);
+/*! <<<```
+ *    Resets coefficients in `coeffs` to assume their target values.
+ *
+ *    #### bw_fdn_reverb_reset_state()
+ *  ```>>> */
+static inline void bw_fdn_reverb_reset_state(
+	const bw_fdn_reverb_coeffs * BW_RESTRICT coeffs,
+	bw_fdn_reverb_state * BW_RESTRICT        state,
+	float                                    x_l_0,
+	float                                    x_r_0,
+	float * BW_RESTRICT                      y_l_0,
+	float * BW_RESTRICT                      y_r_0);
+/*! <<<```
+ *    Resets the given `state` to its initial values using the given `coeffs`
+ *    and the initial input values `x_l_0` (left) and `x_r_0` (right).
+ *
+ *    The corresponding initial output values are put into `y_l_0` (left) and
+ *    `y_r_0` (right).
+ *
+ *    #### bw_fdn_reverb_reset_state_multi()
+ *  ```>>> */
+static inline void bw_fdn_reverb_reset_state_multi(
+	const bw_fdn_reverb_coeffs * BW_RESTRICT              coeffs,
+	bw_fdn_reverb_state * BW_RESTRICT const * BW_RESTRICT state,
+	const float *                                         x_l_0,
+	const float *                                         x_r_0,
+	float *                                               y_l_0,
+	float *                                               y_r_0,
+	size_t                                                n_channels);
+/*! <<<```
+ *    Resets each of the `n_channels` `state`s to its initial values using the
+ *    given `coeffs` and the corresponding initial input values in the `x_l_0`
+ *    (left) and `x_r_0` (right) arrays.
+ *
+ *    The corresponding initial output values are written into the `y_l_0`
+ *    (left) and `y_r_0` arrays, if each is not `BW_NULL`.
+ *
+ *    #### bw_fdn_reverb_update_coeffs_ctrl()
+ *  ```>>> */
+static inline void bw_fdn_reverb_update_coeffs_ctrl(
+	bw_fdn_reverb_coeffs * BW_RESTRICT coeffs);
+/*! <<<```
+ *    Triggers control-rate update of coefficients in `coeffs`.
+ *
+ *    #### bw_fdn_reverb_update_coeffs_audio()
+ *  ```>>> */
+static inline void bw_fdn_reverb_update_coeffs_audio(
+	bw_fdn_reverb_coeffs * BW_RESTRICT coeffs);
+/*! <<<```
+ *    Triggers audio-rate update of coefficients in `coeffs`.
+ *
+ *    #### bw_fdn_reverb_process1()
+ *  ```>>> */
+static inline void bw_fdn_reverb_process1(
+	const bw_fdn_reverb_coeffs * BW_RESTRICT coeffs,
+	bw_fdn_reverb_state * BW_RESTRICT        state,
+	float                                    x_l,
+	float                                    x_r,
+	float *                                  y_l,
+	float *                                  y_r);
+/*! <<<```
+ *    Processes one set of input samples `x_l` (left) and `x_r` (right) using
+ *    `coeffs`, while using and updating `state`. The left and right output
+ *    samples are put into `y_l` (left) and `y_r` (right) respectively.
+ *
+ *    #### bw_fdn_reverb_process()
+ *  ```>>> */
+static inline void bw_fdn_reverb_process(
+	bw_fdn_reverb_coeffs * BW_RESTRICT coeffs,
+	bw_fdn_reverb_state * BW_RESTRICT  state,
+	const float *                      x_l,
+	const float *                      x_r,
+	float *                            y_l,
+	float *                            y_r,
+	size_t                             n_samples);
+/*! <<<```
+ *    Processes the first `n_samples` of the input buffers `x_l` (left) and
+ *    `x_r` (right) and fills the first `n_samples` of the output buffers `y_l`
+ *    (left) and `y_r` (right), while using and updating both `coeffs` and
+ *    `state` (control and audio rate).
+ *
+ *    #### bw_fdn_reverb_process_multi()
+ *  ```>>> */
+static inline void bw_fdn_reverb_process_multi(
+	bw_fdn_reverb_coeffs * BW_RESTRICT                    coeffs,
+	bw_fdn_reverb_state * BW_RESTRICT const * BW_RESTRICT state,
+	const float * const *                                 x_l,
+	const float * const *                                 x_r,
+	float * const *                                       y_l,
+	float * const *                                       y_r,
+	size_t                                                n_channels,
+	size_t                                                n_samples);
+/*! <<<```
+ *    Processes the first `n_samples` of the `n_channels` input buffers `x_l`
+ *    (left) and `x_r` (right) and fills the first `n_samples` of the
+ *    `n_channels` output buffers `y_l` (left) and `y_r` (right), while using
+ *    and updating both the common `coeffs` and each of the `n_channels`
+ *    `state`s (control and audio rate).
+ *
+ *    #### bw_fdn_reverb_set_predelay()
+ *  ```>>> */
+static inline void bw_fdn_reverb_set_predelay(
+	bw_fdn_reverb_coeffs * BW_RESTRICT coeffs,
+	float                              value);
+/*! <<<```
+ *    Sets the predelay time `value` (s) in `coeffs`.
+ *
+ *    Valid input range: [`0.f`, `0.1f`].
+ *
+ *    Default value: `0.f`.
+ *
+ *    #### bw_fdn_reverb_set_bandwidth()
+ *  ```>>> */
+static inline void bw_fdn_reverb_set_bandwidth(
+	bw_fdn_reverb_coeffs * BW_RESTRICT coeffs,
+	float                              value);
+/*! <<<```
+ *    Sets the input high-frequency attenuation cutoff `value` (Hz) in `coeffs`.
+ *
+ *    Valid range: [`20.f`, `20e3f`].
+ *
+ *    Default value: `20e3f`.
+ *
+ *    #### bw_fdn_reverb_set_damping()
+ *  ```>>> */
+static inline void bw_fdn_reverb_set_damping(
+	bw_fdn_reverb_coeffs * BW_RESTRICT coeffs,
+	float                              value);
+/*! <<<```
+ *    Sets the high-frequency damping cutoff `value` (Hz) in `coeffs`.
+ *
+ *    Valid range: [`20.f`, `20e3f`].
+ *
+ *    Default value: `20e3f`.
+ *
+ *    #### bw_fdn_reverb_set_decay()
+ *  ```>>> */
+static inline void bw_fdn_reverb_set_decay(
+	bw_fdn_reverb_coeffs * BW_RESTRICT coeffs,
+	float                              value);
+/*! <<<```
+ *    Sets the decay rate `value` in `coeffs`, that is the gain applied to the
+ *    signal circulating in the network every 100 ms.
+ *
+ *    Valid input range: [`0.f`, `1.f`).
+ *
+ *    Default value: `0.5f`.
+ *
+ *    #### bw_fdn_reverb_set_wet()
+ *  ```>>> */
+static inline void bw_fdn_reverb_set_wet(
+	bw_fdn_reverb_coeffs * BW_RESTRICT coeffs,
+	float                              value);
+/*! <<<```
+ *    Sets the output wet mixing `value` (linear gain) in `coeffs`.
+ *
+ *    Valid range: [`0.f`, `1.f`].
+ *
+ *    Default value: `0.5f`.
+ *
+ *    #### bw_fdn_reverb_get_n_lines()
+ *  ```>>> */
+static inline size_t bw_fdn_reverb_get_n_lines(
+	const bw_fdn_reverb_coeffs * BW_RESTRICT coeffs);
+/*! <<<```
+ *    Returns the number of delay lines used by `coeffs`.
+ *
+ *    #### bw_fdn_reverb_is_silent()
+ *  ```>>> */
+static inline char bw_fdn_reverb_is_silent(
+	const bw_fdn_reverb_coeffs * BW_RESTRICT coeffs,
+	const bw_fdn_reverb_state * BW_RESTRICT  state);
+/*! <<<```
+ *    Returns non-`0` if `state` is currently silent, `0` otherwise.
+ *
+ *    `bw_fdn_reverb_process()` and `bw_fdn_reverb_process_multi()` keep track
+ *    of how long both inputs have been exactly `0.f`. Each time that exceeds
+ *    the maximum predelay, they check whether the whole tail has decayed below
+ *    -120 dB. If so, they clear all internal delay lines and consider `state`
+ *    silent, in which case they just zero-fill the outputs until non-`0.f`
+ *    input comes in. Processing then resumes exactly as from a state reset
+ *    with `0.f` initial inputs.
+ *
+ *    `bw_fdn_reverb_process1()` and `bw_fdn_reverb_reset_state()` make
+ *    `state` non-silent.
+ *
+ *    #### bw_fdn_reverb_coeffs_is_valid()
+ *  ```>>> */
+static inline char bw_fdn_reverb_coeffs_is_valid(
+	const bw_fdn_reverb_coeffs * BW_RESTRICT coeffs);
+/*! <<<```
+ *    Tries to determine whether `coeffs` is valid and returns non-`0` if it
+ *    seems to be the case and `0` if it is certainly not. False positives are
+ *    possible, false negatives are not.
+ *
+ *    `coeffs` must at least point to a readable memory block of size greater
+ *    than or equal to that of `bw_fdn_reverb_coeffs`.
+ *
+ *    #### bw_fdn_reverb_state_is_valid()
+ *  ```>>> */
+static inline char bw_fdn_reverb_state_is_valid(
+	const bw_fdn_reverb_coeffs * BW_RESTRICT coeffs,
+	const bw_fdn_reverb_state * BW_RESTRICT  state);
+/*! <<<```
+ *    Tries to determine whether `state` is valid and returns non-`0` if it
+ *    seems to be the case and `0` if it is certainly not. False positives are
+ *    possible, false negatives are not.
+ *
+ *    If `coeffs` is not `BW_NULL` extra cross-checks might be performed
+ *    (`state` is supposed to be associated to `coeffs`).
+ *
+ *    `state` must at least point to a readable memory block of size greater
+ *    than or equal to that of `bw_fdn_reverb_state`.
+ *  }}} */
+
+#ifdef __cplusplus
+}
+#endif
+
+/*** Implementation ***/
+
+/* WARNING: This part of the file is not part of the public API. Its content may
+ * change at any time in future versions. Please, do not use it directly. */
+
+#include <bw_delay.h>
+#include <bw_lp1.h>
+#include <bw_dry_wet.h>
+#include <bw_one_pole.h>
+#include <bw_math.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifdef BW_DEBUG_DEEP
+enum bw_fdn_reverb_coeffs_state {
+	bw_fdn_reverb_coeffs_state_invalid,
+	bw_fdn_reverb_coeffs_state_init,
+	bw_fdn_reverb_coeffs_state_set_sample_rate,
+	bw_fdn_reverb_coeffs_state_reset_coeffs
+};
+#endif
+
+#ifdef BW_DEBUG_DEEP
+enum bw_fdn_reverb_state_state {
+	bw_fdn_reverb_state_state_invalid,
+	bw_fdn_reverb_state_state_mem_set,
+	bw_fdn_reverb_state_state_reset_state
+};
+#endif
+
+struct bw_fdn_reverb_coeffs {
+#ifdef BW_DEBUG_DEEP
+	uint32_t				hash;
+	enum bw_fdn_reverb_coeffs_state		state;
+	uint32_t				reset_id;
+#endif
+
+	// Sub-components
+	bw_delay_coeffs				predelay_coeffs;
+	bw_lp1_coeffs				bandwidth_coeffs;
+	bw_dry_wet_coeffs			dry_wet_coeffs;
+	bw_one_pole_coeffs			smooth_coeffs;
+	bw_one_pole_state			smooth_predelay_state;
+	bw_one_pole_state			smooth_damping_state;
+	bw_one_pole_state			smooth_decay_state;
+
+	// Coefficients
+	float					fs;
+	float					T;
+	float					t_k;
+	size_t					n_lines;
+	size_t					len;		// in frames of n_lines samples
+	size_t					d[16];
+	float					l[16];		// d[i] / (0.1 * fs)
+	float					g[16];
+	float					in_k[16];
+	float					out_l_k[16];
+	float					out_r_k[16];
+	float					h_k;
+	float					damping_k;
+
+	// Parameters
+	float					predelay;
+	float					damping;
+	float					decay;
+};
+
+struct bw_fdn_reverb_state {
+#ifdef BW_DEBUG_DEEP
+	uint32_t				hash;
+	enum bw_fdn_reverb_state_state		state;
+	uint32_t				coeffs_reset_id;
+#endif
+
+	// Sub-components
+	bw_delay_state				predelay_state;
+	bw_lp1_state				bandwidth_state;
+
+	// Buffers
+	float *					buf;
+
+	// States
+	size_t					idx;
+	float					damping_z1[16];
+
+	// Silence detection
+	size_t					n_silent;
+	char					silent;
+};
+
+static inline void bw_fdn_reverb_init(
+		bw_fdn_reverb_coeffs * BW_RESTRICT coeffs,
+		size_t                             n_lines) {
+	BW_ASSERT(coeffs != BW_NULL);
+	BW_ASSERT(n_lines == 8 || n_lines == 16);
+
+	bw_delay_init(&coeffs->predelay_coeffs, 0.1f);
+	bw_lp1_init(&coeffs->bandwidth_coeffs);
+	bw_dry_wet_init(&coeffs->dry_wet_coeffs);
+	bw_one_pole_init(&coeffs->smooth_coeffs);
+
+	bw_lp1_set_cutoff(&coeffs->bandwidth_coeffs, 20e3f);
+	bw_dry_wet_set_wet(&coeffs->dry_wet_coeffs, 0.5f);
+	bw_one_pole_set_tau(&coeffs->smooth_coeffs, 0.05f);
+	bw_one_pole_set_sticky_thresh(&coeffs->smooth_coeffs, 1e-6f);
+
+	// input and output tap signs, mutually orthogonal both over the first 8
+	// and over all 16 lines
+	const float in_k[16] = {
+		1.f, 1.f, -1.f, 1.f, -1.f, -1.f, 1.f, -1.f,
+		1.f, -1.f, 1.f, 1.f, -1.f, 1.f, -1.f, -1.f };
+	const float out_l_k[16] = {
+		1.f, -1.f, 1.f, -1.f, 1.f, -1.f, 1.f, -1.f,
+		1.f, -1.f, 1.f, -1.f, 1.f, -1.f, 1.f, -1.f };
+	const float out_r_k[16] = {
+		1.f, 1.f, -1.f, -1.f, 1.f, 1.f, -1.f, -1.f,
+		1.f, 1.f, -1.f, -1.f, 1.f, 1.f, -1.f, -1.f };
+	coeffs->n_lines = n_lines;
+	coeffs->h_k = n_lines == 8 ? 0.3535533905932738f : 0.25f;
+	for (size_t i = 0; i < 16; i++) {
+		coeffs->in_k[i] = coeffs->h_k * in_k[i];
+		coeffs->out_l_k[i] = 0.3535533905932738f * out_l_k[i]; // same loudness for 8 and 16 lines
+		coeffs->out_r_k[i] = 0.3535533905932738f * out_r_k[i];
+	}
+
+	coeffs->predelay = 0.f;
+	coeffs->damping = 20e3f;
+	coeffs->decay = 0.5f;
+
+#ifdef BW_DEBUG_DEEP
+	coeffs->hash = bw_hash_sdbm("bw_fdn_reverb_coeffs");
+	coeffs->state = bw_fdn_reverb_coeffs_state_init;
+	coeffs->reset_id = coeffs->hash + 1;
+#endif
+	BW_ASSERT_DEEP(bw_fdn_reverb_coeffs_is_valid(coeffs));
+	BW_ASSERT_DEEP(coeffs->state == bw_fdn_reverb_coeffs_state_init);
+}
+
+static inline void bw_fdn_reverb_set_sample_rate(
+		bw_fdn_reverb_coeffs * BW_RESTRICT coeffs,
+		float                              sample_rate) {
+	BW_ASSERT(coeffs != BW_NULL);
+	BW_ASSERT_DEEP(bw_fdn_reverb_coeffs_is_valid(coeffs));
+	BW_ASSERT_DEEP(coeffs->state >= bw_fdn_reverb_coeffs_state_init);
+	BW_ASSERT(bw_is_finite(sample_rate) && sample_rate > 0.f);
+
+	bw_delay_set_sample_rate(&coeffs->predelay_coeffs, sample_rate);
+	bw_lp1_set_sample_rate(&coeffs->bandwidth_coeffs, sample_rate);
+	bw_dry_wet_set_sample_rate(&coeffs->dry_wet_coeffs, sample_rate);
+	bw_one_pole_set_sample_rate(&coeffs->smooth_coeffs, sample_rate);
+	bw_one_pole_reset_coeffs(&coeffs->smooth_coeffs);
+	coeffs->fs = sample_rate;
+	coeffs->T = 1.f / sample_rate;
+	coeffs->t_k = 3.141592653589793f / sample_rate;
+
+	// the first 8 lengths are used by the 8-line network, the 16-line one
+	// interleaves the others
+	const float t[16] = {
+		0.0313f, 0.0367f, 0.0419f, 0.0491f, 0.0577f, 0.0673f, 0.0791f, 0.0937f,
+		0.0289f, 0.0341f, 0.0397f, 0.0453f, 0.0533f, 0.0629f, 0.0731f, 0.0863f };
+	size_t max = 0;
+	for (size_t i = 0; i < coeffs->n_lines; i++) {
+		const size_t d = (size_t)bw_roundf(sample_rate * t[i]);
+		coeffs->d[i] = d > 0 ? d : 1;
+		coeffs->l[i] = 10.f * coeffs->T * (float)coeffs->d[i];
+		max = coeffs->d[i] > max ? coeffs->d[i] : max;
+	}
+	coeffs->len = max + 1;
+
+#ifdef BW_DEBUG_DEEP
+	coeffs->state = bw_fdn_reverb_coeffs_state_set_sample_rate;
+#endif
+	BW_ASSERT_DEEP(bw_fdn_reverb_coeffs_is_valid(coeffs));
+	BW_ASSERT_DEEP(coeffs->state == bw_fdn_reverb_coeffs_state_set_sample_rate);
+}
+
+static inline size_t bw_fdn_reverb_mem_req(
+		const bw_fdn_reverb_coeffs * BW_RESTRICT coeffs) {
+	BW_ASSERT(coeffs != BW_NULL);
+	BW_ASSERT_DEEP(bw_fdn_reverb_coeffs_is_valid(coeffs));
+	BW_ASSERT_DEEP(coeffs->state >= bw_fdn_reverb_coeffs_state_set_sample_rate);
+
+	// 63 extra bytes to align delay lines to 64 bytes
+	return 63 + coeffs->len * coeffs->n_lines * sizeof(float) + bw_delay_mem_req(&coeffs->predelay_coeffs);
+}
+
+static inline void bw_fdn_reverb_mem_set(
+		const bw_fdn_reverb_coeffs * BW_RESTRICT coeffs,
+		bw_fdn_reverb_state * BW_RESTRICT        state,
+		void * BW_RESTRICT                       mem) {
+	BW_ASSERT(coeffs != BW_NULL);
+	BW_ASSERT_DEEP(bw_fdn_reverb_coeffs_is_valid(coeffs));
+	BW_ASSERT_DEEP(coeffs->state >= bw_fdn_reverb_coeffs_state_set_sample_rate);
+	BW_ASSERT(state != BW_NULL);
+	BW_ASSERT(mem != BW_NULL);
+
+	char *m = (char *)mem + ((64 - (uintptr_t)mem % 64) % 64);
+	state->buf = (float *)m;
+	m += coeffs->len * coeffs->n_lines * sizeof(float);
+	bw_delay_mem_set(&coeffs->predelay_coeffs, &state->predelay_state, m);
+
+#ifdef BW_DEBUG_DEEP
+	state->hash = bw_hash_sdbm("bw_fdn_reverb_state");
+	state->state = bw_fdn_reverb_state_state_mem_set;
+#endif
+	BW_ASSERT_DEEP(bw_fdn_reverb_coeffs_is_valid(coeffs));
+	BW_ASSERT_DEEP(coeffs->state >= bw_fdn_reverb_coeffs_state_set_sample_rate);
+	BW_ASSERT_DEEP(bw_fdn_reverb_state_is_valid(coeffs, state));
+	BW_ASSERT_DEEP(state->state == bw_fdn_reverb_state_state_mem_set);
+}
+
+static inline void bw_fdn_reverb_do_update_coeffs(
+		bw_fdn_reverb_coeffs * BW_RESTRICT coeffs,
+		char                               force) {
+	float damping_cur = bw_one_pole_get_y_z1(&coeffs->smooth_damping_state);
+	if (force || coeffs->damping != damping_cur) {
+		damping_cur = bw_one_pole_process1_sticky_rel(&coeffs->smooth_coeffs, &coeffs->smooth_damping_state, coeffs->damping);
+		const float t = bw_tanf(bw_minf(coeffs->t_k * damping_cur, 1.567654734141306f)); // max = 0.499 * fs
+		coeffs->damping_k = t * bw_rcpf(1.f + t);
+	}
+	float decay_cur = bw_one_pole_get_y_z1(&coeffs->smooth_decay_state);
+	if (force || coeffs->decay != decay_cur) {
+		decay_cur = bw_one_pole_process1_sticky_abs(&coeffs->smooth_coeffs, &coeffs->smooth_decay_state, coeffs->decay);
+		if (decay_cur >= 1.175494350822287e-38f) {
+			const float k = bw_log2f(decay_cur);
+			for (size_t i = 0; i < coeffs->n_lines; i++)
+				coeffs->g[i] = bw_pow2f(k * coeffs->l[i]);
+		} else
+			for (size_t i = 0; i < coeffs->n_lines; i++)
+				coeffs->g[i] = 0.f;
+	}
+}
+
+static inline void bw_fdn_reverb_reset_coeffs(
+		bw_fdn_reverb_coeffs * BW_RESTRICT coeffs) {
+	BW_ASSERT(coeffs != BW_NULL);
+	BW_ASSERT_DEEP(bw_fdn_reverb_coeffs_is_valid(coeffs));
+	BW_ASSERT_DEEP(coeffs->state >= bw_fdn_reverb_coeffs_state_set_sample_rate);
+
+	bw_delay_reset_coeffs(&coeffs->predelay_coeffs);
+	bw_lp1_reset_coeffs(&coeffs->bandwidth_coeffs);
+	bw_dry_wet_reset_coeffs(&coeffs->dry_wet_coeffs);
+	coeffs->predelay = coeffs->T * bw_roundf(coeffs->fs * coeffs->predelay); // rounded
+	bw_one_pole_reset_state(&coeffs->smooth_coeffs, &coeffs->smooth_predelay_state, coeffs->predelay);
+	bw_one_pole_reset_state(&coeffs->smooth_coeffs, &coeffs->smooth_damping_state, coeffs->damping);
+	bw_one_pole_reset_state(&coeffs->smooth_coeffs, &coeffs->smooth_decay_state, coeffs->decay);
+	bw_fdn_reverb_do_update_coeffs(coeffs, 1);
+
+#ifdef BW_DEBUG_DEEP
+	coeffs->state = bw_fdn_reverb_coeffs_state_reset_coeffs;
+	coeffs->reset_id++;
+#endif
+	BW_ASSERT_DEEP(bw_fdn_reverb_coeffs_is_valid(coeffs));
+	BW_ASSERT_DEEP(coeffs->state == bw_fdn_reverb_coeffs_state_reset_coeffs);
+}
+
+static inline void bw_fdn_reverb_reset_state(
+		const bw_fdn_reverb_coeffs * BW_RESTRICT coeffs,
+		bw_fdn_reverb_state * BW_RESTRICT        state,
+		float                                    x_l_0,
+		float                                    x_r_0,
+		float * BW_RESTRICT                      y_l_0,
+		float * BW_RESTRICT                      y_r_0) {
+	BW_ASSERT(coeffs != BW_NULL);
+	BW_ASSERT_DEEP(bw_fdn_reverb_coeffs_is_valid(coeffs));
+	BW_ASSERT_DEEP(coeffs->state >= bw_fdn_reverb_coeffs_state_reset_coeffs);
+	BW_ASSERT(state != BW_NULL);
+	BW_ASSERT_DEEP(bw_fdn_reverb_state_is_valid(coeffs, state));
+	BW_ASSERT_DEEP(state->state >= bw_fdn_reverb_state_state_mem_set);
+	BW_ASSERT(bw_is_finite(x_l_0));
+	BW_ASSERT(bw_is_finite(x_r_0));
+	BW_ASSERT(y_l_0 != BW_NULL);
+	BW_ASSERT(y_r_0 != BW_NULL);
+	BW_ASSERT(y_l_0 != y_r_0);
+
+	const size_t n = coeffs->n_lines;
+
+	const float i = 0.5f * (x_l_0 + x_r_0);
+	const float pd = bw_delay_reset_state(&coeffs->predelay_coeffs, &state->predelay_state, i);
+	const float bw = bw_lp1_reset_state(&coeffs->bandwidth_coeffs, &state->bandwidth_state, pd);
+
+	// steady-state delay line outputs v solve (I - h_k * H * G) v = in_k * bw,
+	// where H is the (unnormalized) Hadamard matrix and G = diag(g)
+	float a[16][17];
+	for (size_t j = 0; j < n; j++) {
+		for (size_t k = 0; k < n; k++) {
+			size_t p = j & k;
+			char s = 0;
+			for (; p != 0; p >>= 1)
+				s ^= p & 1;
+			a[j][k] = (j == k ? 1.f : 0.f) - (s ? -coeffs->h_k : coeffs->h_k) * coeffs->g[k];
+		}
+		a[j][n] = coeffs->in_k[j] * bw;
+	}
+	for (size_t j = 0; j < n; j++) {
+		size_t p = j;
+		for (size_t k = j + 1; k < n; k++)
+			if (bw_absf(a[k][j]) > bw_absf(a[p][j]))
+				p = k;
+		if (p != j)
+			for (size_t k = j; k <= n; k++) {
+				const float t = a[j][k];
+				a[j][k] = a[p][k];
+				a[p][k] = t;
+			}
+		const float r = bw_rcpf(a[j][j]);
+		for (size_t k = j + 1; k < n; k++) {
+			const float f = r * a[k][j];
+			for (size_t m = j; m <= n; m++)
+				a[k][m] -= f * a[j][m];
+		}
+	}
+	float v[16];
+	for (size_t j = n; j > 0; j--) {
+		float s = a[j - 1][n];
+		for (size_t k = j; k < n; k++)
+			s -= a[j - 1][k] * v[k];
+		v[j - 1] = s / a[j - 1][j - 1];
+	}
+
+	for (size_t j = 0; j < coeffs->len; j++)
+		for (size_t k = 0; k < n; k++)
+			state->buf[n * j + k] = v[k];
+	for (size_t k = 0; k < n; k++)
+		state->damping_z1[k] = v[k];
+	state->idx = 0;
+
+	float yl = 0.f;
+	float yr = 0.f;
+	for (size_t k = 0; k < n; k++) {
+		yl += coeffs->out_l_k[k] * v[k];
+		yr += coeffs->out_r_k[k] * v[k];
+	}
+
+	*y_l_0 = bw_dry_wet_process1(&coeffs->dry_wet_coeffs, x_l_0, yl);
+	*y_r_0 = bw_dry_wet_process1(&coeffs->dry_wet_coeffs, x_r_0, yr);
+
+	state->n_silent = 0;
+	state->silent = 0;
+
+#ifdef BW_DEBUG_DEEP
+	state->state = bw_fdn_reverb_state_state_reset_state;
+	state->coeffs_reset_id = coeffs->reset_id;
+#endif
+	BW_ASSERT_DEEP(bw_fdn_reverb_coeffs_is_valid(coeffs));
+	BW_ASSERT_DEEP(coeffs->state >= bw_fdn_reverb_coeffs_state_reset_coeffs);
+	BW_ASSERT_DEEP(bw_fdn_reverb_state_is_valid(coeffs, state));
+	BW_ASSERT_DEEP(state->state >= bw_fdn_reverb_state_state_reset_state);
+	BW_ASSERT(bw_is_finite(*y_l_0));
+	BW_ASSERT(bw_is_finite(*y_r_0));
+}
+
+static inline void bw_fdn_reverb_reset_state_multi(
+		const bw_fdn_reverb_coeffs * BW_RESTRICT              coeffs,
+		bw_fdn_reverb_state * BW_RESTRICT const * BW_RESTRICT state,
+		const float *                                         x_l_0,
+		const float *                                         x_r_0,
+		float *                                               y_l_0,
+		float *                                               y_r_0,
+		size_t                                                n_channels) {
+	BW_ASSERT(coeffs != BW_NULL);
+	BW_ASSERT_DEEP(bw_fdn_reverb_coeffs_is_valid(coeffs));
+	BW_ASSERT_DEEP(coeffs->state >= bw_fdn_reverb_coeffs_state_reset_coeffs);
+	BW_ASSERT(state != BW_NULL);
+#ifndef BW_NO_DEBUG
+	for (size_t i = 0; i < n_channels; i++)
+		for (size_t j = i + 1; j < n_channels; j++)
+			BW_ASSERT(state[i] != state[j]);
+#endif
+	BW_ASSERT(x_l_0 != BW_NULL);
+	BW_ASSERT(x_r_0 != BW_NULL);
+	BW_ASSERT(y_l_0 != BW_NULL && y_r_0 != BW_NULL ? y_l_0 != y_r_0 : 1);
+
+	if (y_l_0 != BW_NULL) {
+		if (y_r_0 != BW_NULL) {
+			for (size_t i = 0; i < n_channels; i++)
+				bw_fdn_reverb_reset_state(coeffs, state[i], x_l_0[i], x_r_0[i], y_l_0 + i, y_r_0 + i);
+		} else {
+			float yr;
+			for (size_t i = 0; i < n_channels; i++)
+				bw_fdn_reverb_reset_state(coeffs, state[i], x_l_0[i], x_r_0[i], y_l_0 + i, &yr);
+		}
+	} else {
+		if (y_r_0 != BW_NULL) {
+			float yl;
+			for (size_t i = 0; i < n_channels; i++)
+				bw_fdn_reverb_reset_state(coeffs, state[i], x_l_0[i], x_r_0[i], &yl, y_r_0 + i);
+		} else {
+			float yl, yr;
+			for (size_t i = 0; i < n_channels; i++)
+				bw_fdn_reverb_reset_state(coeffs, state[i], x_l_0[i], x_r_0[i], &yl, &yr);
+		}
+	}
+
+	BW_ASSERT_DEEP(bw_fdn_reverb_coeffs_is_valid(coeffs));
+	BW_ASSERT_DEEP(coeffs->state >= bw_fdn_reverb_coeffs_state_reset_coeffs);
+	BW_ASSERT_DEEP(y_l_0 != BW_NULL ? bw_has_only_finite(y_l_0, n_channels) : 1);
+	BW_ASSERT_DEEP(y_r_0 != BW_NULL ? bw_has_only_finite(y_r_0, n_channels) : 1);
+}
+
+static inline void bw_fdn_reverb_update_coeffs_ctrl(
+		bw_fdn_reverb_coeffs * BW_RESTRICT coeffs) {
+	BW_ASSERT(coeffs != BW_NULL);
+	BW_ASSERT_DEEP(bw_fdn_reverb_coeffs_is_valid(coeffs));
+	BW_ASSERT_DEEP(coeffs->state >= bw_fdn_reverb_coeffs_state_reset_coeffs);
+
+	bw_lp1_update_coeffs_ctrl(&coeffs->bandwidth_coeffs);
+	bw_dry_wet_update_coeffs_ctrl(&coeffs->dry_wet_coeffs);
+
+	BW_ASSERT_DEEP(bw_fdn_reverb_coeffs_is_valid(coeffs));
+	BW_ASSERT_DEEP(coeffs->state >= bw_fdn_reverb_coeffs_state_reset_coeffs);
+}
+
+static inline void bw_fdn_reverb_update_coeffs_audio(
+		bw_fdn_reverb_coeffs * BW_RESTRICT coeffs) {
+	BW_ASSERT(coeffs != BW_NULL);
+	BW_ASSERT_DEEP(bw_fdn_reverb_coeffs_is_valid(coeffs));
+	BW_ASSERT_DEEP(coeffs->state >= bw_fdn_reverb_coeffs_state_reset_coeffs);
+
+	bw_lp1_update_coeffs_audio(&coeffs->bandwidth_coeffs);
+	const float pd = bw_one_pole_process1_sticky_abs(&coeffs->smooth_coeffs, &coeffs->smooth_predelay_state, coeffs->predelay);
+	bw_delay_set_delay(&coeffs->predelay_coeffs, pd);
+	bw_delay_update_coeffs_ctrl(&coeffs->predelay_coeffs);
+	bw_delay_update_coeffs_audio(&coeffs->predelay_coeffs);
+	bw_fdn_reverb_do_update_coeffs(coeffs, 0);
+	bw_dry_wet_update_coeffs_audio(&coeffs->dry_wet_coeffs);
+
+	BW_ASSERT_DEEP(bw_fdn_reverb_coeffs_is_valid(coeffs));
+	BW_ASSERT_DEEP(coeffs->state >= bw_fdn_reverb_coeffs_state_reset_coeffs);
+}
+
+static inline void bw_fdn_reverb_process1(
+		const bw_fdn_reverb_coeffs * BW_RESTRICT coeffs,
+		bw_fdn_reverb_state * BW_RESTRICT        state,
+		float                                    x_l,
+		float                                    x_r,
+		float *                                  y_l,
+		float *                                  y_r) {
+	BW_ASSERT(coeffs != BW_NULL);
+	BW_ASSERT_DEEP(bw_fdn_reverb_coeffs_is_valid(coeffs));
+	BW_ASSERT_DEEP(coeffs->state >= bw_fdn_reverb_coeffs_state_reset_coeffs);
+	BW_ASSERT(state != BW_NULL);
+	BW_ASSERT_DEEP(bw_fdn_reverb_state_is_valid(coeffs, state));
+	BW_ASSERT_DEEP(state->state >= bw_fdn_reverb_state_state_reset_state);
+	BW_ASSERT(bw_is_finite(x_l));
+	BW_ASSERT(bw_is_finite(x_r));
+	BW_ASSERT(y_l != BW_NULL);
+	BW_ASSERT(y_r != BW_NULL);
+	BW_ASSERT(y_l != y_r);
+
+	const size_t n = coeffs->n_lines;
+	float * BW_RESTRICT buf = state->buf;
+
+	const float i = 0.5f * (x_l + x_r);
+	const float pd = bw_delay_process1(&coeffs->predelay_coeffs, &state->predelay_state, i);
+	const float bw = bw_lp1_process1(&coeffs->bandwidth_coeffs, &state->bandwidth_state, pd);
+
+	// read
+	float v[16];
+	for (size_t k = 0; k < n; k++) {
+		const size_t d = coeffs->d[k];
+		const size_t j = state->idx >= d ? state->idx - d : state->idx + coeffs->len - d;
+		v[k] = buf[n * j + k];
+	}
+
+	// output taps
+	float yl = 0.f;
+	float yr = 0.f;
+	for (size_t k = 0; k < n; k++) {
+		yl += coeffs->out_l_k[k] * v[k];
+		yr += coeffs->out_r_k[k] * v[k];
+	}
+
+	// damping (TPT one-pole lowpass) and decay
+	for (size_t k = 0; k < n; k++) {
+		const float x = coeffs->damping_k * (v[k] - state->damping_z1[k]);
+		const float lp = x + state->damping_z1[k];
+		state->damping_z1[k] = lp + x;
+		v[k] = coeffs->g[k] * lp;
+	}
+
+	// mixing (fast Walsh-Hadamard transform)
+	for (size_t h = 1; h < n; h <<= 1)
+		for (size_t j = 0; j < n; j += h << 1)
+			for (size_t k = j; k < j + h; k++) {
+				const float a = v[k];
+				const float b = v[k + h];
+				v[k] = a + b;
+				v[k + h] = a - b;
+			}
+
+	// write
+	float * BW_RESTRICT w = buf + n * state->idx;
+	for (size_t k = 0; k < n; k++)
+		w[k] = coeffs->h_k * v[k] + coeffs->in_k[k] * bw;
+	state->idx = state->idx + 1 == coeffs->len ? 0 : state->idx + 1;
+
+	*y_l = bw_dry_wet_process1(&coeffs->dry_wet_coeffs, x_l, yl);
+	*y_r = bw_dry_wet_process1(&coeffs->dry_wet_coeffs, x_r, yr);
+	state->silent = 0;
+
+	BW_ASSERT_DEEP(bw_fdn_reverb_coeffs_is_valid(coeffs));
+	BW_ASSERT_DEEP(coeffs->state >= bw_fdn_reverb_coeffs_state_reset_coeffs);
+	BW_ASSERT_DEEP(bw_fdn_reverb_state_is_valid(coeffs, state));
+	BW_ASSERT_DEEP(state->state >= bw_fdn_reverb_state_state_reset_state);
+	BW_ASSERT(bw_is_finite(*y_l));
+	BW_ASSERT(bw_is_finite(*y_r));
+}
+
+static inline void bw_fdn_reverb_silence_track(
+		bw_fdn_reverb_state * BW_RESTRICT state,
+		const float *                     x_l,
+		const float *                     x_r,
+		size_t                            n_samples) {
+	size_t z = 0;
+	while (z < n_samples && x_l[n_samples - 1 - z] == 0.f && x_r[n_samples - 1 - z] == 0.f)
+		z++;
+	if (z < n_samples) {
+		state->n_silent = z;
+		state->silent = 0;
+	} else if (!state->silent)
+		state->n_silent += n_samples;
+}
+
+static inline void bw_fdn_reverb_silence_check(
+		const bw_fdn_reverb_coeffs * BW_RESTRICT coeffs,
+		bw_fdn_reverb_state * BW_RESTRICT        state) {
+	if (state->silent || state->n_silent < bw_delay_get_length(&coeffs->predelay_coeffs))
+		return;
+	state->n_silent = 0;
+
+	float v = bw_delay_get_peak(&coeffs->predelay_coeffs, &state->predelay_state);
+	const size_t n = coeffs->n_lines * coeffs->len;
+	for (size_t i = 0; i < n; i++)
+		v = bw_maxf(v, bw_absf(state->buf[i]));
+
+	if (v < 1e-6f /* -120 dB */) {
+		float y_l, y_r;
+		bw_fdn_reverb_reset_state(coeffs, state, 0.f, 0.f, &y_l, &y_r);
+		state->silent = 1;
+	}
+}
+
+static inline void bw_fdn_reverb_process(
+		bw_fdn_reverb_coeffs * BW_RESTRICT coeffs,
+		bw_fdn_reverb_state * BW_RESTRICT  state,
+		const float *                      x_l,
+		const float *                      x_r,
+		float *                            y_l,
+		float *                            y_r,
+		size_t                             n_samples) {
+	BW_ASSERT(coeffs != BW_NULL);
+	BW_ASSERT_DEEP(bw_fdn_reverb_coeffs_is_valid(coeffs));
+	BW_ASSERT_DEEP(coeffs->state >= bw_fdn_reverb_coeffs_state_reset_coeffs);
+	BW_ASSERT(state != BW_NULL);
+	BW_ASSERT_DEEP(bw_fdn_reverb_state_is_valid(coeffs, state));
+	BW_ASSERT_DEEP(state->state >= bw_fdn_reverb_state_state_reset_state);
+	BW_ASSERT(x_l != BW_NULL);
+	BW_ASSERT_DEEP(bw_has_only_finite(x_l, n_samples));
+	BW_ASSERT(x_r != BW_NULL);
+	BW_ASSERT_DEEP(bw_has_only_finite(x_r, n_samples));
+	BW_ASSERT(y_l != BW_NULL);
+	BW_ASSERT(y_r != BW_NULL);
+	BW_ASSERT(y_l != y_r);
+
+	bw_fdn_reverb_update_coeffs_ctrl(coeffs);
+	bw_fdn_reverb_silence_track(state, x_l, x_r, n_samples);
+	if (state->silent) {
+		for (size_t i = 0; i < n_samples; i++)
+			bw_fdn_reverb_update_coeffs_audio(coeffs);
+		bw_buf_fill(0.f, y_l, n_samples);
+		bw_buf_fill(0.f, y_r, n_samples);
+	} else
+		for (size_t i = 0; i < n_samples; i++) {
+			bw_fdn_reverb_update_coeffs_audio(coeffs);
+			bw_fdn_reverb_process1(coeffs, state, x_l[i], x_r[i], y_l + i, y_r + i);
+		}
+	bw_fdn_reverb_silence_check(coeffs, state);
+
+	BW_ASSERT_DEEP(bw_fdn_reverb_coeffs_is_valid(coeffs));
+	BW_ASSERT_DEEP(coeffs->state >= bw_fdn_reverb_coeffs_state_reset_coeffs);
+	BW_ASSERT_DEEP(bw_fdn_reverb_state_is_valid(coeffs, state));
+	BW_ASSERT_DEEP(state->state >= bw_fdn_reverb_state_state_reset_state);
+	BW_ASSERT_DEEP(bw_has_only_finite(y_l, n_samples));
+	BW_ASSERT_DEEP(bw_has_only_finite(y_r, n_samples));
+}
+
+static inline void bw_fdn_reverb_process_multi(
+		bw_fdn_reverb_coeffs * BW_RESTRICT                    coeffs,
+		bw_fdn_reverb_state * BW_RESTRICT const * BW_RESTRICT state,
+		const float * const *                                 x_l,
+		const float * const *                                 x_r,
+		float * const *                                       y_l,
+		float * const *                                       y_r,
+		size_t                                                n_channels,
+		size_t                                                n_samples) {
+	BW_ASSERT(coeffs != BW_NULL);
+	BW_ASSERT_DEEP(bw_fdn_reverb_coeffs_is_valid(coeffs));
+	BW_ASSERT_DEEP(coeffs->state >= bw_fdn_reverb_coeffs_state_reset_coeffs);
+	BW_ASSERT(state != BW_NULL);
+#ifndef BW_NO_DEBUG
+	for (size_t i = 0; i < n_channels; i++)
+		for (size_t j = i + 1; j < n_channels; j++)
+			BW_ASSERT(state[i] != state[j]);
+#endif
+	BW_ASSERT(x_l != BW_NULL);
+	BW_ASSERT(x_r != BW_NULL);
+	BW_ASSERT(y_l != BW_NULL);
+	BW_ASSERT(y_r != BW_NULL);
+	BW_ASSERT(y_l != y_r);
+#ifndef BW_NO_DEBUG
+	for (size_t i = 0; i < n_channels; i++)
+		for (size_t j = i + 1; j < n_channels; j++) {
+			BW_ASSERT(y_l[i] != y_l[j]);
+			BW_ASSERT(y_r[i] != y_r[j]);
+		}
+	for (size_t i = 0; i < n_channels; i++)
+		for (size_t j = 0; j < n_channels; j++)
+			BW_ASSERT(y_l[i] != y_r[j]);
+	for (size_t i = 0; i < n_channels; i++)
+		for (size_t j = 0; j < n_channels; j++) {
+			BW_ASSERT(i == j || x_l[i] != y_l[j]);
+			BW_ASSERT(i == j || x_l[i] != y_r[j]);
+			BW_ASSERT(i == j || x_r[i] != y_l[j]);
+			BW_ASSERT(i == j || x_r[i] != y_r[j]);
+		}
+#endif
+
+	bw_fdn_reverb_update_coeffs_ctrl(coeffs);
+	for (size_t j = 0; j < n_channels; j++)
+		bw_fdn_reverb_silence_track(state[j], x_l[j], x_r[j], n_samples);
+	for (size_t i = 0; i < n_samples; i++) {
+		bw_fdn_reverb_update_coeffs_audio(coeffs);
+		for (size_t j = 0; j < n_channels; j++) {
+			if (state[j]->silent) {
+				y_l[j][i] = 0.f;
+				y_r[j][i] = 0.f;
+			} else
+				bw_fdn_reverb_process1(coeffs, state[j], x_l[j][i], x_r[j][i], y_l[j] + i, y_r[j] + i);
+		}
+	}
+	for (size_t j = 0; j < n_channels; j++)
+		bw_fdn_reverb_silence_check(coeffs, state[j]);
+
+	BW_ASSERT_DEEP(bw_fdn_reverb_coeffs_is_valid(coeffs));
+	BW_ASSERT_DEEP(coeffs->state >= bw_fdn_reverb_coeffs_state_reset_coeffs);
+}
+
+static inline void bw_fdn_reverb_set_predelay(
+		bw_fdn_reverb_coeffs * BW_RESTRICT coeffs,
+		float                              value) {
+	BW_ASSERT(coeffs != BW_NULL);
+	BW_ASSERT_DEEP(bw_fdn_reverb_coeffs_is_valid(coeffs));
+	BW_ASSERT_DEEP(coeffs->state >= bw_fdn_reverb_coeffs_state_init);
+	BW_ASSERT(bw_is_finite(value));
+	BW_ASSERT(value >= 0.f && value <= 0.1f);
+
+	coeffs->predelay = coeffs->T * bw_roundf(coeffs->fs * value);
+
+	BW_ASSERT_DEEP(bw_fdn_reverb_coeffs_is_valid(coeffs));
+	BW_ASSERT_DEEP(coeffs->state >= bw_fdn_reverb_coeffs_state_init);
+}
+
+static inline void bw_fdn_reverb_set_bandwidth(
+		bw_fdn_reverb_coeffs * BW_RESTRICT coeffs,
+		float                              value) {
+	BW_ASSERT(coeffs != BW_NULL);
+	BW_ASSERT_DEEP(bw_fdn_reverb_coeffs_is_valid(coeffs));
+	BW_ASSERT_DEEP(coeffs->state >= bw_fdn_reverb_coeffs_state_init);
+	BW_ASSERT(bw_is_finite(value));
+	BW_ASSERT(value >= 20.f && value <= 20e3f);
+
+	bw_lp1_set_cutoff(&coeffs->bandwidth_coeffs, value);
+
+	BW_ASSERT_DEEP(bw_fdn_reverb_coeffs_is_valid(coeffs));
+	BW_ASSERT_DEEP(coeffs->state >= bw_fdn_reverb_coeffs_state_init);
+}
+
+static inline void bw_fdn_reverb_set_damping(
+		bw_fdn_reverb_coeffs * BW_RESTRICT coeffs,
+		float                              value) {
+	BW_ASSERT(coeffs != BW_NULL);
+	BW_ASSERT_DEEP(bw_fdn_reverb_coeffs_is_valid(coeffs));
+	BW_ASSERT_DEEP(coeffs->state >= bw_fdn_reverb_coeffs_state_init);
+	BW_ASSERT(bw_is_finite(value));
+	BW_ASSERT(value >= 20.f && value <= 20e3f);
+
+	coeffs->damping = value;
+
+	BW_ASSERT_DEEP(bw_fdn_reverb_coeffs_is_valid(coeffs));
+	BW_ASSERT_DEEP(coeffs->state >= bw_fdn_reverb_coeffs_state_init);
+}
+
+static inline void bw_fdn_reverb_set_decay(
+		bw_fdn_reverb_coeffs * BW_RESTRICT coeffs,
+		float                              value) {
+	BW_ASSERT(coeffs != BW_NULL);
+	BW_ASSERT_DEEP(bw_fdn_reverb_coeffs_is_valid(coeffs));
+	BW_ASSERT_DEEP(coeffs->state >= bw_fdn_reverb_coeffs_state_init);
+	BW_ASSERT(bw_is_finite(value));
+	BW_ASSERT(value >= 0.f && value < 1.f);
+
+	coeffs->decay = value;
+
+	BW_ASSERT_DEEP(bw_fdn_reverb_coeffs_is_valid(coeffs));
+	BW_ASSERT_DEEP(coeffs->state >= bw_fdn_reverb_coeffs_state_init);
+}
+
+static inline void bw_fdn_reverb_set_wet(
+		bw_fdn_reverb_coeffs * BW_RESTRICT coeffs,
+		float                              value) {
+	BW_ASSERT(coeffs != BW_NULL);
+	BW_ASSERT_DEEP(bw_fdn_reverb_coeffs_is_valid(coeffs));
+	BW_ASSERT_DEEP(coeffs->state >= bw_fdn_reverb_coeffs_state_init);
+	BW_ASSERT(bw_is_finite(value));
+	BW_ASSERT(value >= 0.f && value <= 1.f);
+
+	bw_dry_wet_set_wet(&coeffs->dry_wet_coeffs, value);
+
+	BW_ASSERT_DEEP(bw_fdn_reverb_coeffs_is_valid(coeffs));
+	BW_ASSERT_DEEP(coeffs->state >= bw_fdn_reverb_coeffs_state_init);
+}
+
+static inline size_t bw_fdn_reverb_get_n_lines(
+		const bw_fdn_reverb_coeffs * BW_RESTRICT coeffs) {
+	BW_ASSERT(coeffs != BW_NULL);
+	BW_ASSERT_DEEP(bw_fdn_reverb_coeffs_is_valid(coeffs));
+	BW_ASSERT_DEEP(coeffs->state >= bw_fdn_reverb_coeffs_state_init);
+
+	return coeffs->n_lines;
+}
+
+static inline char bw_fdn_reverb_is_silent(
+		const bw_fdn_reverb_coeffs * BW_RESTRICT coeffs,
+		const bw_fdn_reverb_state * BW_RESTRICT  state) {
+	BW_ASSERT(coeffs != BW_NULL);
+	BW_ASSERT_DEEP(bw_fdn_reverb_coeffs_is_valid(coeffs));
+	BW_ASSERT_DEEP(coeffs->state >= bw_fdn_reverb_coeffs_state_reset_coeffs);
+	BW_ASSERT(state != BW_NULL);
+	BW_ASSERT_DEEP(bw_fdn_reverb_state_is_valid(coeffs, state));
+	BW_ASSERT_DEEP(state->state >= bw_fdn_reverb_state_state_reset_state);
+
+	(void)coeffs;
+
+	return state->silent;
+}
+
+static inline char bw_fdn_reverb_coeffs_is_valid(
+		const bw_fdn_reverb_coeffs * BW_RESTRICT coeffs) {
+	BW_ASSERT(coeffs != BW_NULL);
+
+#ifdef BW_DEBUG_DEEP
+	if (coeffs->hash != bw_hash_sdbm("bw_fdn_reverb_coeffs"))
+		return 0;
+	if (coeffs->state < bw_fdn_reverb_coeffs_state_init || coeffs->state > bw_fdn_reverb_coeffs_state_reset_coeffs)
+		return 0;
+#endif
+
+	if (coeffs->n_lines != 8 && coeffs->n_lines != 16)
+		return 0;
+	if (!bw_is_finite(coeffs->predelay) || coeffs->predelay < 0.f || coeffs->predelay > 0.1f)
+		return 0;
+	if (!bw_is_finite(coeffs->damping) || coeffs->damping < 20.f || coeffs->damping > 20e3f)
+		return 0;
+	if (!bw_is_finite(coeffs->decay) || coeffs->decay < 0.f || coeffs->decay >= 1.f)
+		return 0;
+
+	if (!bw_one_pole_coeffs_is_valid(&coeffs->smooth_coeffs))
+		return 0;
+
+#ifdef BW_DEBUG_DEEP
+	if (coeffs->state >= bw_fdn_reverb_coeffs_state_set_sample_rate) {
+		if (!bw_is_finite(coeffs->fs) || coeffs->fs <= 0.f)
+			return 0;
+		if (!bw_is_finite(coeffs->T) || coeffs->T <= 0.f)
+			return 0;
+		if (!bw_is_finite(coeffs->t_k) || coeffs->t_k <= 0.f)
+			return 0;
+		for (size_t i = 0; i < coeffs->n_lines; i++)
+			if (coeffs->d[i] < 1 || coeffs->d[i] >= coeffs->len)
+				return 0;
+	}
+
+	if (coeffs->state >= bw_fdn_reverb_coeffs_state_reset_coeffs) {
+		if (!bw_is_finite(coeffs->damping_k) || coeffs->damping_k <= 0.f || coeffs->damping_k >= 1.f)
+			return 0;
+		for (size_t i = 0; i < coeffs->n_lines; i++)
+			if (!bw_is_finite(coeffs->g[i]) || coeffs->g[i] < 0.f || coeffs->g[i] >= 1.f)
+				return 0;
+
+		if (!bw_one_pole_state_is_valid(&coeffs->smooth_coeffs, &coeffs->smooth_predelay_state))
+			return 0;
+		if (!bw_one_pole_state_is_valid(&coeffs->smooth_coeffs, &coeffs->smooth_damping_state))
+			return 0;
+		if (!bw_one_pole_state_is_valid(&coeffs->smooth_coeffs, &coeffs->smooth_decay_state))
+			return 0;
+	}
+#endif
+
+	return bw_delay_coeffs_is_valid(&coeffs->predelay_coeffs)
+		&& bw_lp1_coeffs_is_valid(&coeffs->bandwidth_coeffs)
+		&& bw_dry_wet_coeffs_is_valid(&coeffs->dry_wet_coeffs);
+}
+
+static inline char bw_fdn_reverb_state_is_valid(
+		const bw_fdn_reverb_coeffs * BW_RESTRICT coeffs,
+		const bw_fdn_reverb_state * BW_RESTRICT  state) {
+	BW_ASSERT(state != BW_NULL);
+
+#ifdef BW_DEBUG_DEEP
+	if (state->hash != bw_hash_sdbm("bw_fdn_reverb_state"))
+		return 0;
+	if (state->state < bw_fdn_reverb_state_state_mem_set || state->state > bw_fdn_reverb_state_state_reset_state)
+		return 0;
+
+	if (state->state >= bw_fdn_reverb_state_state_reset_state) {
+		if (coeffs != BW_NULL && coeffs->reset_id != state->coeffs_reset_id)
+			return 0;
+
+		if (coeffs != BW_NULL) {
+			if (state->idx >= coeffs->len)
+				return 0;
+			for (size_t i = 0; i < coeffs->n_lines; i++)
+				if (!bw_is_finite(state->damping_z1[i]))
+					return 0;
+		}
+
+		if (!bw_lp1_state_is_valid(coeffs ? &coeffs->bandwidth_coeffs : BW_NULL, &state->bandwidth_state))
+			return 0;
+	}
+#endif
+
+	if (state->buf == BW_NULL || (uintptr_t)state->buf % 64 != 0)
+		return 0;
+
+	return bw_delay_state_is_valid(coeffs ? &coeffs->predelay_coeffs : BW_NULL, &state->predelay_state);
+}
+
+#ifdef __cplusplus
+}
+
+#ifndef BW_CXX_NO_ARRAY
+# include <array>
+#endif
+
+namespace Brickworks {
+
+/*** Public C++ API ***/
+
+/*! api_cpp {{{
+ *    ##### Brickworks::FDNReverb
+ *  ```>>> */
+template<size_t N_CHANNELS>
+class FDNReverb {
+public:
+	FDNReverb(
+		size_t nLines = 8);
+
+	~FDNReverb();
+
+	void setSampleRate(
+		float sampleRate);
+
+	void reset(
+		float               xL0 = 0.f,
+		float               xR0 = 0.f,
+		float * BW_RESTRICT yL0 = nullptr,
+		float * BW_RESTRICT yR0 = nullptr);
+
+#ifndef BW_CXX_NO_ARRAY
+	void reset(
+		float                                       xL0,
+		float                                       xR0,
+		std::array<float, N_CHANNELS> * BW_RESTRICT yL0,
+		std::array<float, N_CHANNELS> * BW_RESTRICT yR0);
+#endif
+
+	void reset(
+		const float * xL0,
+		const float * xR0,
+		float *       yL0 = nullptr,
+		float *       yR0 = nullptr);
+
+#ifndef BW_CXX_NO_ARRAY
+	void reset(
+		std::array<float, N_CHANNELS>               xL0,
+		std::array<float, N_CHANNELS>               xR0,
+		std::array<float, N_CHANNELS> * BW_RESTRICT yL0 = nullptr,
+		std::array<float, N_CHANNELS> * BW_RESTRICT yR0 = nullptr);
+#endif
+
+	void process(
+		const float * const * xL,
+		const float * const * xR,
+		float * const *       yL,
+		float * const *       yR,
+		size_t                nSamples);
+
+#ifndef BW_CXX_NO_ARRAY
+	void process(
+		std::array<const float *, N_CHANNELS> xL,
+		std::array<const float *, N_CHANNELS> xR,
+		std::array<float *, N_CHANNELS>       yL,
+		std::array<float *, N_CHANNELS>       yR,
+		size_t                                nSamples);
+#endif
+
+	void setPredelay(
+		float value);
+
+	void setBandwidth(
+		float value);
+
+	void setDamping(
+		float value);
+
+	void setDecay(
+		float value);
+
+	void setWet(
+		float value);
+
+	bool isSilent(
+		size_t channel);
+/*! <<<...
+ *  }
+ *  ```
+ *  }}} */
+
+/*** Implementation ***/
+
+/* WARNING: This part of the file is not part of the public API. Its content may
+ * change at any time in future versions. Please, do not use it directly. */
+
+private:
+	bw_fdn_reverb_coeffs		coeffs;
+	bw_fdn_reverb_state		states[N_CHANNELS];
+	bw_fdn_reverb_state * BW_RESTRICT	statesP[N_CHANNELS];
+	void * BW_RESTRICT		mem;
+};
+
+template<size_t N_CHANNELS>
+inline FDNReverb<N_CHANNELS>::FDNReverb(
+		size_t nLines) {
+	bw_fdn_reverb_init(&coeffs, nLines);
+	for (size_t i = 0; i < N_CHANNELS; i++)
+		statesP[i] = states + i;
+	mem = nullptr;
+}
+
+template<size_t N_CHANNELS>
+inline FDNReverb<N_CHANNELS>::~FDNReverb() {
+	if (mem != nullptr)
+		operator delete(mem);
+}
+
+template<size_t N_CHANNELS>
+inline void FDNReverb<N_CHANNELS>::setSampleRate(
+		float sampleRate) {
+	bw_fdn_reverb_set_sample_rate(&coeffs, sampleRate);
+	size_t req = bw_fdn_reverb_mem_req(&coeffs);
+	if (mem != nullptr)
+		operator delete(mem);
+	mem = operator new(req * N_CHANNELS);
+	void *m = mem;
+	for (size_t i = 0; i < N_CHANNELS; i++, m = static_cast<char *>(m) + req)
+		bw_fdn_reverb_mem_set(&coeffs, states + i, m);
+}
+
+template<size_t N_CHANNELS>
+inline void FDNReverb<N_CHANNELS>::reset(
+		float               xL0,
+		float               xR0,
+		float * BW_RESTRICT yL0,
+		float * BW_RESTRICT yR0) {
+	bw_fdn_reverb_reset_coeffs(&coeffs);
+	if (yL0 != nullptr) {
+		if (yR0 != nullptr) {
+			for (size_t i = 0; i < N_CHANNELS; i++)
+				bw_fdn_reverb_reset_state(&coeffs, states + i, xL0, xR0, yL0 + i, yR0 + i);
+		} else {
+			float yr;
+			for (size_t i = 0; i < N_CHANNELS; i++)
+				bw_fdn_reverb_reset_state(&coeffs, states + i, xL0, xR0, yL0 + i, &yr);
+		}
+	} else {
+		if (yR0 != nullptr) {
+			float yl;
+			for (size_t i = 0; i < N_CHANNELS; i++)
+				bw_fdn_reverb_reset_state(&coeffs, states + i, xL0, xR0, &yl, yR0 + i);
+		} else {
+			float yl, yr;
+			for (size_t i = 0; i < N_CHANNELS; i++)
+				bw_fdn_reverb_reset_state(&coeffs, states + i, xL0, xR0, &yl, &yr);
+		}
+	}
+}
+
+#ifndef BW_CXX_NO_ARRAY
+template<size_t N_CHANNELS>
+inline void FDNReverb<N_CHANNELS>::reset(
+		float                                       xL0,
+		float                                       xR0,
+		std::array<float, N_CHANNELS> * BW_RESTRICT yL0,
+		std::array<float, N_CHANNELS> * BW_RESTRICT yR0) {
+	reset(xL0, xR0, yL0 != nullptr ? yL0->data() : nullptr, yR0 != nullptr ? yR0->data() : nullptr);
+}
+#endif
+
+template<size_t N_CHANNELS>
+inline void FDNReverb<N_CHANNELS>::reset(
+		const float * xL0,
+		const float * xR0,
+		float *       yL0,
+		float *       yR0) {
+	bw_fdn_reverb_reset_coeffs(&coeffs);
+	bw_fdn_reverb_reset_state_multi(&coeffs, statesP, xL0, xR0, yL0, yR0, N_CHANNELS);
+}
+
+#ifndef BW_CXX_NO_ARRAY
+template<size_t N_CHANNELS>
+inline void FDNReverb<N_CHANNELS>::reset(
+		std::array<float, N_CHANNELS>               xL0,
+		std::array<float, N_CHANNELS>               xR0,
+		std::array<float, N_CHANNELS> * BW_RESTRICT yL0,
+		std::array<float, N_CHANNELS> * BW_RESTRICT yR0) {
+	reset(xL0.data(), xR0.data(), yL0 != nullptr ? yL0->data() : nullptr, yR0 != nullptr ? yR0->data() : nullptr);
+}
+#endif
+
+template<size_t N_CHANNELS>
+inline void FDNReverb<N_CHANNELS>::process(
+		const float * const * xL,
+		const float * const * xR,
+		float * const *       yL,
+		float * const *       yR,
+		size_t                nSamples) {
+	bw_fdn_reverb_process_multi(&coeffs, statesP, xL, xR, yL, yR, N_CHANNELS, nSamples);
+}
+
+#ifndef BW_CXX_NO_ARRAY
+template<size_t N_CHANNELS>
+inline void FDNReverb<N_CHANNELS>::process(
+		std::array<const float *, N_CHANNELS> xL,
+		std::array<const float *, N_CHANNELS> xR,
+		std::array<float *, N_CHANNELS>       yL,
+		std::array<float *, N_CHANNELS>       yR,
+		size_t                                nSamples) {
+	process(xL.data(), xR.data(), yL.data(), yR.data(), nSamples);
+}
+#endif
+
+template<size_t N_CHANNELS>
+inline void FDNReverb<N_CHANNELS>::setPredelay(
+		float value) {
+	bw_fdn_reverb_set_predelay(&coeffs, value);
+}
+
+template<size_t N_CHANNELS>
+inline void FDNReverb<N_CHANNELS>::setBandwidth(
+		float value) {
+	bw_fdn_reverb_set_bandwidth(&coeffs, value);
+}
+
+template<size_t N_CHANNELS>
+inline void FDNReverb<N_CHANNELS>::setDamping(
+		float value) {
+	bw_fdn_reverb_set_damping(&coeffs, value);
+}
+
+template<size_t N_CHANNELS>
+inline void FDNReverb<N_CHANNELS>::setDecay(
+		float value) {
+	bw_fdn_reverb_set_decay(&coeffs, value);
+}
+
+template<size_t N_CHANNELS>
+inline void FDNReverb<N_CHANNELS>::setWet(
+		float value) {
+	bw_fdn_reverb_set_wet(&coeffs, value);
+}
+
+template<size_t N_CHANNELS>
+inline bool FDNReverb<N_CHANNELS>::isSilent(
+		size_t channel) {
+	return bw_fdn_reverb_is_silent(&coeffs, states + channel);
+}
+
+}
+#endif
+
+#endif
@@ -0,0 +1,674 @@
+/*
+ * Brickworks
+ *
+ * Copyright (C) 2024 Orastron Srl unipersonale
+ *
+ * Brickworks is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3 of the License.
+ *
+ * Brickworks is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Brickworks.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * File author: Stefano D'Angelo
+ */
+
+/*!
+ *  module_type {{{ utility }}}
+ *  version {{{ 1.0.0 }}}
+ *  requires {{{ bw_common }}}
+ *  description {{{
+ *    Fast Fourier transform of real or complex data for power-of-two sizes
+ *    between `32` and `65536`.
+ *
+ *    Transforms are computed in place (when input and output buffers
+ *    coincide) or out of place, in-order, using an iterative radix-2²
+ *    decimation-in-time algorithm, i.e., two radix-2 stages are fused in each
+ *    pass over data. Real transforms of size `n` are computed by means of a
+ *    complex transform of size `n / 2` plus a pre/post-processing step.
+ *
+ *    Twiddle factors and the bit reversal permutation are precomputed into
+ *    caller-provided memory, then no memory is allocated when transforming.
+ *
+ *    Complex data is stored as interleaved real and imaginary parts. The
+ *    spectrum of real data of size `n` is stored in packed format in `n`
+ *    values: the first two are the real parts of the DC and Nyquist bins
+ *    (whose imaginary parts are always zero), followed by the interleaved
+ *    real and imaginary parts of bins `1` to `n / 2 - 1`.
+ *
+ *    Neither the forward nor the inverse transform are normalized, hence
+ *    an inverse transform after a forward transform multiplies data by `n`.
+ *  }}}
+ *  changelog {{{
+ *    <ul>
+ *      <li>Version <strong>1.0.0</strong>:
+ *        <ul>
+ *          <li>First release.</li>
+ *        </ul>
+ *      </li>
+ *    </ul>
+ *  }}}
+ */
+
+#ifndef BW_FFT_H
+#define BW_FFT_H
+
+#include <bw_common.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*** Public API ***/
+
+/*! api {{{
+ *    #### bw_fft
+ *  ```>>> */
+typedef struct bw_fft bw_fft;
+/*! <<<```
+ *    Transform plan.
+ *
+ *    #### bw_fft_init()
+ *  ```>>> */
+static inline void bw_fft_init(
+	bw_fft * BW_RESTRICT fft,
+	size_t               n,
+	char                 real);
+/*! <<<```
+ *    Initializes `fft` to compute transforms of `n` real values, if `real` is
+ *    non-`0`, or `n` complex values, otherwise.
+ *
+ *    `n` must be a power of `2` between `32` and `65536`.
+ *
+ *    #### bw_fft_mem_req()
+ *  ```>>> */
+static inline size_t bw_fft_mem_req(
+	const bw_fft * BW_RESTRICT fft);
+/*! <<<```
+ *    Returns the size, in bytes, of contiguous memory to be supplied to
+ *    `bw_fft_mem_set()` using `fft`.
+ *
+ *    #### bw_fft_mem_set()
+ *  ```>>> */
+static inline void bw_fft_mem_set(
+	bw_fft * BW_RESTRICT fft,
+	void * BW_RESTRICT   mem);
+/*! <<<```
+ *    Associates the contiguous memory block `mem` to `fft` and precomputes
+ *    twiddle factors and the bit reversal permutation into it.
+ *
+ *    This function is not [RT-safe](api#rt-safe-function) as it may take
+ *    considerable time for large sizes.
+ *
+ *    #### bw_fft_forward()
+ *  ```>>> */
+static inline void bw_fft_forward(
+	const bw_fft * BW_RESTRICT fft,
+	const float *              x,
+	float *                    y);
+/*! <<<```
+ *    Computes the forward transform of the input buffer `x` and writes the
+ *    result into the output buffer `y` using `fft`.
+ *
+ *    For complex transforms both `x` and `y` contain `2 * n` values, while
+ *    for real transforms `x` contains `n` real values and `y` contains the
+ *    packed spectrum (`n` values).
+ *
+ *    `x` and `y` can either point to the same buffer or to non-overlapping
+ *    buffers.
+ *
+ *    #### bw_fft_inverse()
+ *  ```>>> */
+static inline void bw_fft_inverse(
+	const bw_fft * BW_RESTRICT fft,
+	const float *              x,
+	float *                    y);
+/*! <<<```
+ *    Computes the (non-normalized) inverse transform of the input buffer `x`
+ *    and writes the result into the output buffer `y` using `fft`.
+ *
+ *    For complex transforms both `x` and `y` contain `2 * n` values, while
+ *    for real transforms `x` contains the packed spectrum (`n` values) and `y`
+ *    contains `n` real values.
+ *
+ *    `x` and `y` can either point to the same buffer or to non-overlapping
+ *    buffers.
+ *
+ *    #### bw_fft_mul_add()
+ *  ```>>> */
+static inline void bw_fft_mul_add(
+	const bw_fft * BW_RESTRICT fft,
+	const float * BW_RESTRICT  a,
+	const float * BW_RESTRICT  b,
+	float * BW_RESTRICT        y);
+/*! <<<```
+ *    Multiplies the spectra `a` and `b` bin by bin and adds the result to
+ *    the spectrum `y`, all in the format used by `fft`.
+ *
+ *    This is the core operation of frequency-domain convolution.
+ *
+ *    `y` must not overlap with `a` or `b`.
+ *
+ *    #### bw_fft_get_size()
+ *  ```>>> */
+static inline size_t bw_fft_get_size(
+	const bw_fft * BW_RESTRICT fft);
+/*! <<<```
+ *    Returns the transform size `n` of `fft`.
+ *
+ *    #### bw_fft_is_valid()
+ *  ```>>> */
+static inline char bw_fft_is_valid(
+	const bw_fft * BW_RESTRICT fft);
+/*! <<<```
+ *    Tries to determine whether `fft` is valid and returns non-`0` if it
+ *    seems to be the case and `0` if it is certainly not. False positives are
+ *    possible, false negatives are not.
+ *
+ *    `fft` must at least point to a readable memory block of size greater
+ *    than or equal to that of `bw_fft`.
+ *  }}} */
+
+#ifdef __cplusplus
+}
+#endif
+
+/*** Implementation ***/
+
+/* WARNING: This part of the file is not part of the public API. Its content may
+ * change at any time in future versions. Please, do not use it directly. */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifdef BW_DEBUG_DEEP
+enum bw_fft_state {
+	bw_fft_state_invalid,
+	bw_fft_state_init,
+	bw_fft_state_mem_set
+};
+#endif
+
+struct bw_fft {
+#ifdef BW_DEBUG_DEEP
+	uint32_t			hash;
+	enum bw_fft_state		state;
+#endif
+
+	size_t				n;
+	char				real;
+	size_t				n_c;		// complex transform size
+	size_t				log2_n_c;
+	size_t				tw_len;		// floats
+	size_t				rtw_len;	// floats
+
+	uint32_t * BW_RESTRICT		rev;		// bit reversal permutation
+	float * BW_RESTRICT		tw;		// twiddles of fused passes
+	float * BW_RESTRICT		rtw;		// twiddles of real pre/post-processing
+};
+
+static inline void bw_fft_init(
+		bw_fft * BW_RESTRICT fft,
+		size_t               n,
+		char                 real) {
+	BW_ASSERT(fft != BW_NULL);
+	BW_ASSERT(n >= 32 && n <= 65536 && (n & (n - 1)) == 0);
+
+	fft->n = n;
+	fft->real = real;
+	fft->n_c = real ? n >> 1 : n;
+	fft->log2_n_c = 0;
+	while (((size_t)1 << fft->log2_n_c) < fft->n_c)
+		fft->log2_n_c++;
+	// each fused pass with half-span h needs h couples of complex twiddles
+	fft->tw_len = 0;
+	for (size_t h = fft->log2_n_c & 1 ? 2 : 1; 4 * h <= fft->n_c; h <<= 2)
+		fft->tw_len += 4 * h;
+	fft->rtw_len = real ? 2 * ((fft->n_c >> 1) + 1) : 0;
+	fft->rev = BW_NULL;
+	fft->tw = BW_NULL;
+	fft->rtw = BW_NULL;
+
+#ifdef BW_DEBUG_DEEP
+	fft->hash = bw_hash_sdbm("bw_fft");
+	fft->state = bw_fft_state_init;
+#endif
+	BW_ASSERT_DEEP(bw_fft_is_valid(fft));
+	BW_ASSERT_DEEP(fft->state == bw_fft_state_init);
+}
+
+static inline size_t bw_fft_mem_req(
+		const bw_fft * BW_RESTRICT fft) {
+	BW_ASSERT(fft != BW_NULL);
+	BW_ASSERT_DEEP(bw_fft_is_valid(fft));
+	BW_ASSERT_DEEP(fft->state >= bw_fft_state_init);
+
+	return fft->n_c * sizeof(uint32_t) + (fft->tw_len + fft->rtw_len) * sizeof(float);
+}
+
+// Twiddles need more accuracy than what bw_math provides, hence this double
+// precision helper, only used in bw_fft_mem_set().
+static inline void bw_fft_sincos2pi(
+		double   x,
+		double * BW_RESTRICT s,
+		double * BW_RESTRICT c) {
+	// x in [0, 1), reduced to [-1/8, 1/8] by octant symmetries
+	const int o = (int)(8.0 * x + 0.5);
+	const double t = 6.283185307179586 * (x - 0.125 * o);
+	const double t2 = t * t;
+	double ts = t;
+	double tc = 1.0;
+	double ss = t;
+	double cc = 1.0;
+	for (int k = 1; k < 10; k++) {
+		ts *= -t2 / (double)((2 * k) * (2 * k + 1));
+		tc *= -t2 / (double)((2 * k - 1) * (2 * k));
+		ss += ts;
+		cc += tc;
+	}
+	// rotate by o * pi / 4
+	static const double r[8][2] = {
+		{ 1.0, 0.0 }, { 0.7071067811865476, 0.7071067811865476 }, { 0.0, 1.0 }, { -0.7071067811865476, 0.7071067811865476 },
+		{ -1.0, 0.0 }, { -0.7071067811865476, -0.7071067811865476 }, { 0.0, -1.0 }, { 0.7071067811865476, -0.7071067811865476 }
+	};
+	const double rc = r[o & 7][0];
+	const double rs = r[o & 7][1];
+	*c = cc * rc - ss * rs;
+	*s = ss * rc + cc * rs;
+}
+
+static inline void bw_fft_mem_set(
+		bw_fft * BW_RESTRICT fft,
+		void * BW_RESTRICT   mem) {
+	BW_ASSERT(fft != BW_NULL);
+	BW_ASSERT_DEEP(bw_fft_is_valid(fft));
+	BW_ASSERT_DEEP(fft->state >= bw_fft_state_init);
+	BW_ASSERT(mem != BW_NULL);
+
+	fft->rev = (uint32_t *)mem;
+	fft->tw = (float *)(fft->rev + fft->n_c);
+	fft->rtw = fft->real ? fft->tw + fft->tw_len : BW_NULL;
+
+	for (size_t i = 0; i < fft->n_c; i++) {
+		uint32_t r = 0;
+		for (size_t j = 0; j < fft->log2_n_c; j++)
+			r |= ((i >> j) & 1) << (fft->log2_n_c - 1 - j);
+		fft->rev[i] = r;
+	}
+
+	// for each fused pass with half-span h: w_{2h}^j, w_{4h}^j, j < h
+	float *tw = fft->tw;
+	for (size_t h = fft->log2_n_c & 1 ? 2 : 1; 4 * h <= fft->n_c; h <<= 2)
+		for (size_t j = 0; j < h; j++) {
+			double s, c;
+			bw_fft_sincos2pi((double)j / (double)(2 * h), &s, &c);
+			tw[0] = (float)c;
+			tw[1] = (float)s;
+			bw_fft_sincos2pi((double)j / (double)(4 * h), &s, &c);
+			tw[2] = (float)c;
+			tw[3] = (float)s;
+			tw += 4;
+		}
+
+	// w_n^k, k <= n / 4
+	if (fft->real)
+		for (size_t k = 0; k <= (fft->n_c >> 1); k++) {
+			double s, c;
+			bw_fft_sincos2pi((double)k / (double)fft->n, &s, &c);
+			fft->rtw[2 * k] = (float)c;
+			fft->rtw[2 * k + 1] = (float)s;
+		}
+
+#ifdef BW_DEBUG_DEEP
+	fft->state = bw_fft_state_mem_set;
+#endif
+	BW_ASSERT_DEEP(bw_fft_is_valid(fft));
+	BW_ASSERT_DEEP(fft->state == bw_fft_state_mem_set);
+}
+
+// sd is the sign of the imaginary part of twiddles: -1 forward, 1 inverse
+static inline void bw_fft_complex(
+		const bw_fft * BW_RESTRICT fft,
+		float * BW_RESTRICT        y,
+		float                      sd) {
+	const size_t n = fft->n_c;
+
+	for (size_t i = 0; i < n; i++) {
+		const size_t j = fft->rev[i];
+		if (i < j) {
+			const float r = y[2 * i];
+			const float m = y[2 * i + 1];
+			y[2 * i] = y[2 * j];
+			y[2 * i + 1] = y[2 * j + 1];
+			y[2 * j] = r;
+			y[2 * j + 1] = m;
+		}
+	}
+
+	size_t h = 1;
+	if (fft->log2_n_c & 1) {
+		// single radix-2 pass
+		for (size_t i = 0; i < 2 * n; i += 4) {
+			const float ar = y[i];
+			const float ai = y[i + 1];
+			const float br = y[i + 2];
+			const float bi = y[i + 3];
+			y[i] = ar + br;
+			y[i + 1] = ai + bi;
+			y[i + 2] = ar - br;
+			y[i + 3] = ai - bi;
+		}
+		h = 2;
+	}
+
+	// fused radix-2 passes: half-spans h and 2 h
+	const float * BW_RESTRICT tw = fft->tw;
+	for (; 4 * h <= n; h <<= 2) {
+		for (size_t b = 0; b < 2 * n; b += 8 * h) {
+			float * BW_RESTRICT y0 = y + b;
+			float * BW_RESTRICT y1 = y0 + 2 * h;
+			float * BW_RESTRICT y2 = y1 + 2 * h;
+			float * BW_RESTRICT y3 = y2 + 2 * h;
+			for (size_t j = 0; j < h; j++) {
+				const float tc = tw[4 * j];
+				const float ts = sd * tw[4 * j + 1];
+				const float uc = tw[4 * j + 2];
+				const float us = sd * tw[4 * j + 3];
+				const size_t r = 2 * j;
+				const size_t m = r + 1;
+
+				// first stage, twiddle t
+				const float t1r = tc * y1[r] - ts * y1[m];
+				const float t1i = tc * y1[m] + ts * y1[r];
+				const float t3r = tc * y3[r] - ts * y3[m];
+				const float t3i = tc * y3[m] + ts * y3[r];
+				const float b0r = y0[r] + t1r;
+				const float b0i = y0[m] + t1i;
+				const float b1r = y0[r] - t1r;
+				const float b1i = y0[m] - t1i;
+				const float b2r = y2[r] + t3r;
+				const float b2i = y2[m] + t3i;
+				const float b3r = y2[r] - t3r;
+				const float b3i = y2[m] - t3i;
+
+				// second stage, twiddles u and u * (sd * i)
+				const float u2r = uc * b2r - us * b2i;
+				const float u2i = uc * b2i + us * b2r;
+				const float v3r = uc * b3r - us * b3i;
+				const float v3i = uc * b3i + us * b3r;
+				const float u3r = -sd * v3i;
+				const float u3i = sd * v3r;
+				y0[r] = b0r + u2r;
+				y0[m] = b0i + u2i;
+				y2[r] = b0r - u2r;
+				y2[m] = b0i - u2i;
+				y1[r] = b1r + u3r;
+				y1[m] = b1i + u3i;
+				y3[r] = b1r - u3r;
+				y3[m] = b1i - u3i;
+			}
+		}
+		tw += 4 * h;
+	}
+}
+
+static inline void bw_fft_forward(
+		const bw_fft * BW_RESTRICT fft,
+		const float *              x,
+		float *                    y) {
+	BW_ASSERT(fft != BW_NULL);
+	BW_ASSERT_DEEP(bw_fft_is_valid(fft));
+	BW_ASSERT_DEEP(fft->state >= bw_fft_state_mem_set);
+	BW_ASSERT(x != BW_NULL);
+	BW_ASSERT_DEEP(bw_has_only_finite(x, fft->real ? fft->n : 2 * fft->n));
+	BW_ASSERT(y != BW_NULL);
+	BW_ASSERT(x == y || x + (fft->real ? fft->n : 2 * fft->n) <= y || y + (fft->real ? fft->n : 2 * fft->n) <= x);
+
+	if (x != y)
+		for (size_t i = 0; i < 2 * fft->n_c; i++)
+			y[i] = x[i];
+	bw_fft_complex(fft, y, -1.f);
+
+	if (fft->real) {
+		// X[k] = E[k] + w^k O[k], X[N - k] = conj(E[k] - w^k O[k]), where
+		// E[k] = (Z[k] + conj(Z[N - k])) / 2, O[k] = -i (Z[k] - conj(Z[N - k])) / 2
+		const size_t n = fft->n_c;
+		const float z0r = y[0];
+		const float z0i = y[1];
+		y[0] = z0r + z0i;
+		y[1] = z0r - z0i;
+		for (size_t k = 1; k <= (n >> 1); k++) {
+			const size_t l = n - k;
+			const float ar = y[2 * k];
+			const float ai = y[2 * k + 1];
+			const float br = y[2 * l];
+			const float bi = -y[2 * l + 1];
+			const float er = 0.5f * (ar + br);
+			const float ei = 0.5f * (ai + bi);
+			const float or_ = 0.5f * (ai - bi);
+			const float oi = -0.5f * (ar - br);
+			const float wc = fft->rtw[2 * k];
+			const float ws = -fft->rtw[2 * k + 1];
+			const float pr = wc * or_ - ws * oi;
+			const float pi = wc * oi + ws * or_;
+			y[2 * k] = er + pr;
+			y[2 * k + 1] = ei + pi;
+			y[2 * l] = er - pr;
+			y[2 * l + 1] = pi - ei;
+		}
+	}
+
+	BW_ASSERT_DEEP(bw_fft_is_valid(fft));
+	BW_ASSERT_DEEP(fft->state >= bw_fft_state_mem_set);
+	BW_ASSERT_DEEP(bw_has_only_finite(y, fft->real ? fft->n : 2 * fft->n));
+}
+
+static inline void bw_fft_inverse(
+		const bw_fft * BW_RESTRICT fft,
+		const float *              x,
+		float *                    y) {
+	BW_ASSERT(fft != BW_NULL);
+	BW_ASSERT_DEEP(bw_fft_is_valid(fft));
+	BW_ASSERT_DEEP(fft->state >= bw_fft_state_mem_set);
+	BW_ASSERT(x != BW_NULL);
+	BW_ASSERT_DEEP(bw_has_only_finite(x, fft->real ? fft->n : 2 * fft->n));
+	BW_ASSERT(y != BW_NULL);
+	BW_ASSERT(x == y || x + (fft->real ? fft->n : 2 * fft->n) <= y || y + (fft->real ? fft->n : 2 * fft->n) <= x);
+
+	if (x != y)
+		for (size_t i = 0; i < 2 * fft->n_c; i++)
+			y[i] = x[i];
+
+	if (fft->real) {
+		// Z[k] = 2 E[k] + 2 i O[k], Z[N - k] = conj(2 E[k] - 2 i O[k]), where
+		// 2 E[k] = X[k] + conj(X[N - k]), 2 O[k] = conj(w^k) (X[k] - conj(X[N - k]))
+		const size_t n = fft->n_c;
+		const float x0 = y[0];
+		const float xn = y[1];
+		y[0] = x0 + xn;
+		y[1] = x0 - xn;
+		for (size_t k = 1; k <= (n >> 1); k++) {
+			const size_t l = n - k;
+			const float ar = y[2 * k];
+			const float ai = y[2 * k + 1];
+			const float br = y[2 * l];
+			const float bi = -y[2 * l + 1];
+			const float er = ar + br;
+			const float ei = ai + bi;
+			const float dr = ar - br;
+			const float di = ai - bi;
+			const float wc = fft->rtw[2 * k];
+			const float ws = fft->rtw[2 * k + 1];
+			const float or_ = wc * dr - ws * di;
+			const float oi = wc * di + ws * dr;
+			// i O = -oi + i or_
+			y[2 * k] = er - oi;
+			y[2 * k + 1] = ei + or_;
+			y[2 * l] = er + oi;
+			y[2 * l + 1] = or_ - ei;
+		}
+	}
+
+	bw_fft_complex(fft, y, 1.f);
+
+	BW_ASSERT_DEEP(bw_fft_is_valid(fft));
+	BW_ASSERT_DEEP(fft->state >= bw_fft_state_mem_set);
+	BW_ASSERT_DEEP(bw_has_only_finite(y, fft->real ? fft->n : 2 * fft->n));
+}
+
+static inline void bw_fft_mul_add(
+		const bw_fft * BW_RESTRICT fft,
+		const float * BW_RESTRICT  a,
+		const float * BW_RESTRICT  b,
+		float * BW_RESTRICT        y) {
+	BW_ASSERT(fft != BW_NULL);
+	BW_ASSERT_DEEP(bw_fft_is_valid(fft));
+	BW_ASSERT(a != BW_NULL);
+	BW_ASSERT_DEEP(bw_has_only_finite(a, fft->real ? fft->n : 2 * fft->n));
+	BW_ASSERT(b != BW_NULL);
+	BW_ASSERT_DEEP(bw_has_only_finite(b, fft->real ? fft->n : 2 * fft->n));
+	BW_ASSERT(y != BW_NULL);
+	BW_ASSERT_DEEP(bw_has_only_finite(y, fft->real ? fft->n : 2 * fft->n));
+
+	size_t i = 0;
+	if (fft->real) {
+		// DC and Nyquist are real
+		y[0] += a[0] * b[0];
+		y[1] += a[1] * b[1];
+		i = 2;
+	}
+	for (; i < 2 * fft->n_c; i += 2) {
+		y[i] += a[i] * b[i] - a[i + 1] * b[i + 1];
+		y[i + 1] += a[i] * b[i + 1] + a[i + 1] * b[i];
+	}
+
+	BW_ASSERT_DEEP(bw_fft_is_valid(fft));
+	BW_ASSERT_DEEP(bw_has_only_finite(y, fft->real ? fft->n : 2 * fft->n));
+}
+
+static inline size_t bw_fft_get_size(
+		const bw_fft * BW_RESTRICT fft) {
+	BW_ASSERT(fft != BW_NULL);
+	BW_ASSERT_DEEP(bw_fft_is_valid(fft));
+
+	return fft->n;
+}
+
+static inline char bw_fft_is_valid(
+		const bw_fft * BW_RESTRICT fft) {
+	BW_ASSERT(fft != BW_NULL);
+
+#ifdef BW_DEBUG_DEEP
+	if (fft->hash != bw_hash_sdbm("bw_fft"))
+		return 0;
+	if (fft->state < bw_fft_state_init || fft->state > bw_fft_state_mem_set)
+		return 0;
+#endif
+
+	if (fft->n < 32 || fft->n > 65536 || (fft->n & (fft->n - 1)) != 0)
+		return 0;
+	if (fft->n_c != (fft->real ? fft->n >> 1 : fft->n) || ((size_t)1 << fft->log2_n_c) != fft->n_c)
+		return 0;
+
+#ifdef BW_DEBUG_DEEP
+	if (fft->state >= bw_fft_state_mem_set) {
+		if (fft->rev == BW_NULL || fft->tw == BW_NULL || (fft->real && fft->rtw == BW_NULL))
+			return 0;
+	}
+#endif
+
+	return 1;
+}
+
+#ifdef __cplusplus
+}
+
+namespace Brickworks {
+
+/*** Public C++ API ***/
+
+/*! api_cpp {{{
+ *    ##### Brickworks::FFT
+ *  ```>>> */
+class FFT {
+public:
+	FFT(
+		size_t n,
+		bool   real = true);
+
+	~FFT();
+
+	void forward(
+		const float * x,
+		float *       y);
+
+	void inverse(
+		const float * x,
+		float *       y);
+
+	void mulAdd(
+		const float * BW_RESTRICT a,
+		const float * BW_RESTRICT b,
+		float * BW_RESTRICT       y);
+
+	size_t getSize();
+/*! <<<...
+ *  }
+ *  ```
+ *  }}} */
+
+/*** Implementation ***/
+
+/* WARNING: This part of the file is not part of the public API. Its content may
+ * change at any time in future versions. Please, do not use it directly. */
+
+private:
+	bw_fft			fft;
+	void * BW_RESTRICT	mem;
+};
+
+inline FFT::FFT(
+		size_t n,
+		bool   real) {
+	bw_fft_init(&fft, n, real);
+	mem = operator new(bw_fft_mem_req(&fft));
+	bw_fft_mem_set(&fft, mem);
+}
+
+inline FFT::~FFT() {
+	operator delete(mem);
+}
+
+inline void FFT::forward(
+		const float * x,
+		float *       y) {
+	bw_fft_forward(&fft, x, y);
+}
+
+inline void FFT::inverse(
+		const float * x,
+		float *       y) {
+	bw_fft_inverse(&fft, x, y);
+}
+
+inline void FFT::mulAdd(
+		const float * BW_RESTRICT a,
+		const float * BW_RESTRICT b,
+		float * BW_RESTRICT       y) {
+	bw_fft_mul_add(&fft, a, b, y);
+}
+
+inline size_t FFT::getSize() {
+	return bw_fft_get_size(&fft);
+}
+
+}
+#endif
+
+#endif
@@ -0,0 +1,633 @@
+/*
+ * Brickworks
+ *
+ * Copyright (C) 2024 Orastron Srl unipersonale
+ *
+ * Brickworks is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3 of the License.
+ *
+ * Brickworks is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Brickworks.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * File author: Stefano D'Angelo
+ */
+
+/*!
+ *  module_type {{{ dsp }}}
+ *  version {{{ 1.0.0 }}}
+ *  requires {{{ bw_common }}}
+ *  description {{{
+ *    Finite impulse response filter with up to `512` taps in direct form.
+ *
+ *    The input history is stored twice in a row, so that each output sample
+ *    is computed as a single contiguous dot product that the compiler can
+ *    vectorize. Coefficients are shared among all channels.
+ *
+ *    Filters with symmetric taps (linear phase) introduce a latency of
+ *    `(n_taps - 1) / 2` samples.
+ *  }}}
+ *  changelog {{{
+ *    <ul>
+ *      <li>Version <strong>1.0.0</strong>:
+ *        <ul>
+ *          <li>First release.</li>
+ *        </ul>
+ *      </li>
+ *    </ul>
+ *  }}}
+ */
+
+#ifndef BW_FIR_H
+#define BW_FIR_H
+
+#include <bw_common.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*! api {{{
+ *    #### bw_fir_coeffs
+ *  ```>>> */
+typedef struct bw_fir_coeffs bw_fir_coeffs;
+/*! <<<```
+ *    Coefficients and related.
+ *
+ *    #### bw_fir_state
+ *  ```>>> */
+typedef struct bw_fir_state bw_fir_state;
+/*! <<<```
+ *    Internal state and related.
+ *
+ *    #### bw_fir_init()
+ *  ```>>> */
+static inline void bw_fir_init(
+	bw_fir_coeffs * BW_RESTRICT coeffs,
+	size_t                      n_taps);
+/*! <<<```
+ *    Initializes `coeffs` for a filter with `n_taps` taps, which must be
+ *    between `1` and `512`. The first tap is set to `1.f` and the others to
+ *    `0.f` (i.e., the filter does nothing).
+ *
+ *    #### bw_fir_reset_state()
+ *  ```>>> */
+static inline float bw_fir_reset_state(
+	const bw_fir_coeffs * BW_RESTRICT coeffs,
+	bw_fir_state * BW_RESTRICT        state,
+	float                             x_0);
+/*! <<<```
+ *    Resets the given `state` to its initial values using the given `coeffs`
+ *    and the initial input value `x_0`.
+ *
+ *    Returns the corresponding initial output value.
+ *
+ *    #### bw_fir_reset_state_multi()
+ *  ```>>> */
+static inline void bw_fir_reset_state_multi(
+	const bw_fir_coeffs * BW_RESTRICT              coeffs,
+	bw_fir_state * BW_RESTRICT const * BW_RESTRICT state,
+	const float *                                  x_0,
+	float *                                        y_0,
+	size_t                                         n_channels);
+/*! <<<```
+ *    Resets each of the `n_channels` `state`s to its initial values using the
+ *    given `coeffs` and the corresponding initial input value in the `x_0`
+ *    array.
+ *
+ *    The corresponding initial output values are written into the `y_0` array,
+ *    if not `BW_NULL`.
+ *
+ *    #### bw_fir_process1()
+ *  ```>>> */
+static inline float bw_fir_process1(
+	const bw_fir_coeffs * BW_RESTRICT coeffs,
+	bw_fir_state * BW_RESTRICT        state,
+	float                             x);
+/*! <<<```
+ *    Processes one input sample `x` using `coeffs`, while using and updating
+ *    `state`. Returns the corresponding output sample.
+ *
+ *    #### bw_fir_process()
+ *  ```>>> */
+static inline void bw_fir_process(
+	const bw_fir_coeffs * BW_RESTRICT coeffs,
+	bw_fir_state * BW_RESTRICT        state,
+	const float *                     x,
+	float *                           y,
+	size_t                            n_samples);
+/*! <<<```
+ *    Processes the first `n_samples` of the input buffer `x` and fills the
+ *    first `n_samples` of the output buffer `y`, while using and updating
+ *    `state`.
+ *
+ *    `x` and `y` can either point to the same buffer or to non-overlapping
+ *    buffers.
+ *
+ *    #### bw_fir_process_multi()
+ *  ```>>> */
+static inline void bw_fir_process_multi(
+	const bw_fir_coeffs * BW_RESTRICT              coeffs,
+	bw_fir_state * BW_RESTRICT const * BW_RESTRICT state,
+	const float * const *                          x,
+	float * const *                                y,
+	size_t                                         n_channels,
+	size_t                                         n_samples);
+/*! <<<```
+ *    Processes the first `n_samples` of the `n_channels` input buffers `x` and
+ *    fills the first `n_samples` of the `n_channels` output buffers `y`, while
+ *    using and updating each of the `n_channels` `state`s.
+ *
+ *    #### bw_fir_set_taps()
+ *  ```>>> */
+static inline void bw_fir_set_taps(
+	bw_fir_coeffs * BW_RESTRICT coeffs,
+	const float *               taps);
+/*! <<<```
+ *    Sets the filter taps in `coeffs` to the first `n_taps` values in `taps`,
+ *    where `n_taps` is the value given to `bw_fir_init()`. `taps[0]` is the
+ *    first sample of the impulse response.
+ *
+ *    This function can be called at any time, also between calls to
+ *    `bw_fir_process()` and similar, without resetting associated states.
+ *
+ *    #### bw_fir_get_n_taps()
+ *  ```>>> */
+static inline size_t bw_fir_get_n_taps(
+	const bw_fir_coeffs * BW_RESTRICT coeffs);
+/*! <<<```
+ *    Returns the number of taps of the filter using `coeffs`.
+ *
+ *    #### bw_fir_coeffs_is_valid()
+ *  ```>>> */
+static inline char bw_fir_coeffs_is_valid(
+	const bw_fir_coeffs * BW_RESTRICT coeffs);
+/*! <<<```
+ *    Tries to determine whether `coeffs` is valid and returns non-`0` if it
+ *    seems to be the case and `0` if it is certainly not. False positives are
+ *    possible, false negatives are not.
+ *
+ *    `coeffs` must at least point to a readable memory block of size greater
+ *    than or equal to that of `bw_fir_coeffs`.
+ *
+ *    #### bw_fir_state_is_valid()
+ *  ```>>> */
+static inline char bw_fir_state_is_valid(
+	const bw_fir_coeffs * BW_RESTRICT coeffs,
+	const bw_fir_state * BW_RESTRICT  state);
+/*! <<<```
+ *    Tries to determine whether `state` is valid and returns non-`0` if it
+ *    seems to be the case and `0` if it is certainly not. False positives are
+ *    possible, false negatives are not.
+ *
+ *    If `coeffs` is not `BW_NULL` extra cross-checks might be performed
+ *    (`state` is supposed to be associated to `coeffs`).
+ *
+ *    `state` must at least point to a readable memory block of size greater
+ *    than or equal to that of `bw_fir_state`.
+ *  }}} */
+
+#ifdef __cplusplus
+}
+#endif
+
+/*** Implementation ***/
+
+/* WARNING: This part of the file is not part of the public API. Its content may
+ * change at any time in future versions. Please, do not use it directly. */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define BW_FIR_TAPS_MAX	512
+
+struct bw_fir_coeffs {
+#ifdef BW_DEBUG_DEEP
+	uint32_t	hash;
+	uint32_t	reset_id;
+#endif
+
+	// Coefficients
+	size_t		len;			// n_taps rounded up to a multiple of 4
+	float		h[BW_FIR_TAPS_MAX];	// reversed and zero-padded at the beginning
+	float		sum;
+
+	// Parameters
+	size_t		n_taps;
+};
+
+struct bw_fir_state {
+#ifdef BW_DEBUG_DEEP
+	uint32_t	hash;
+	uint32_t	coeffs_reset_id;
+#endif
+
+	// Buffers (history is stored twice in a row)
+	float		buf[2 * BW_FIR_TAPS_MAX];
+
+	// States
+	size_t		idx;
+};
+
+static inline void bw_fir_init(
+		bw_fir_coeffs * BW_RESTRICT coeffs,
+		size_t                      n_taps) {
+	BW_ASSERT(coeffs != BW_NULL);
+	BW_ASSERT(n_taps >= 1 && n_taps <= BW_FIR_TAPS_MAX);
+
+	coeffs->n_taps = n_taps;
+	coeffs->len = (n_taps + 3) & ~(size_t)3;
+	for (size_t i = 0; i < coeffs->len - 1; i++)
+		coeffs->h[i] = 0.f;
+	coeffs->h[coeffs->len - 1] = 1.f;
+	coeffs->sum = 1.f;
+
+#ifdef BW_DEBUG_DEEP
+	coeffs->hash = bw_hash_sdbm("bw_fir_coeffs");
+	coeffs->reset_id = coeffs->hash + 1;
+#endif
+	BW_ASSERT_DEEP(bw_fir_coeffs_is_valid(coeffs));
+}
+
+static inline float bw_fir_reset_state(
+		const bw_fir_coeffs * BW_RESTRICT coeffs,
+		bw_fir_state * BW_RESTRICT        state,
+		float                             x_0) {
+	BW_ASSERT(coeffs != BW_NULL);
+	BW_ASSERT_DEEP(bw_fir_coeffs_is_valid(coeffs));
+	BW_ASSERT(state != BW_NULL);
+	BW_ASSERT(bw_is_finite(x_0));
+
+	for (size_t i = 0; i < 2 * coeffs->len; i++)
+		state->buf[i] = x_0;
+	state->idx = 0;
+	const float y = coeffs->sum * x_0;
+
+#ifdef BW_DEBUG_DEEP
+	state->hash = bw_hash_sdbm("bw_fir_state");
+	state->coeffs_reset_id = coeffs->reset_id;
+#endif
+	BW_ASSERT_DEEP(bw_fir_coeffs_is_valid(coeffs));
+	BW_ASSERT_DEEP(bw_fir_state_is_valid(coeffs, state));
+	BW_ASSERT(bw_is_finite(y));
+
+	return y;
+}
+
+static inline void bw_fir_reset_state_multi(
+		const bw_fir_coeffs * BW_RESTRICT              coeffs,
+		bw_fir_state * BW_RESTRICT const * BW_RESTRICT state,
+		const float *                                  x_0,
+		float *                                        y_0,
+		size_t                                         n_channels) {
+	BW_ASSERT(coeffs != BW_NULL);
+	BW_ASSERT_DEEP(bw_fir_coeffs_is_valid(coeffs));
+	BW_ASSERT(state != BW_NULL);
+#ifndef BW_NO_DEBUG
+	for (size_t i = 0; i < n_channels; i++)
+		for (size_t j = i + 1; j < n_channels; j++)
+			BW_ASSERT(state[i] != state[j]);
+#endif
+	BW_ASSERT(x_0 != BW_NULL);
+
+	if (y_0 != BW_NULL)
+		for (size_t i = 0; i < n_channels; i++)
+			y_0[i] = bw_fir_reset_state(coeffs, state[i], x_0[i]);
+	else
+		for (size_t i = 0; i < n_channels; i++)
+			bw_fir_reset_state(coeffs, state[i], x_0[i]);
+
+	BW_ASSERT_DEEP(bw_fir_coeffs_is_valid(coeffs));
+	BW_ASSERT_DEEP(y_0 != BW_NULL ? bw_has_only_finite(y_0, n_channels) : 1);
+}
+
+static inline float bw_fir_dot(
+		const float * BW_RESTRICT h,
+		const float * BW_RESTRICT w,
+		size_t                    n) {
+	// n is a multiple of 4, 4 independent partial sums can be vectorized
+	float v[4] = { 0.f, 0.f, 0.f, 0.f };
+	for (size_t k = 0; k < n; k += 4) {
+		v[0] += h[k] * w[k];
+		v[1] += h[k + 1] * w[k + 1];
+		v[2] += h[k + 2] * w[k + 2];
+		v[3] += h[k + 3] * w[k + 3];
+	}
+	return (v[0] + v[1]) + (v[2] + v[3]);
+}
+
+static inline float bw_fir_process1(
+		const bw_fir_coeffs * BW_RESTRICT coeffs,
+		bw_fir_state * BW_RESTRICT        state,
+		float                             x) {
+	BW_ASSERT(coeffs != BW_NULL);
+	BW_ASSERT_DEEP(bw_fir_coeffs_is_valid(coeffs));
+	BW_ASSERT(state != BW_NULL);
+	BW_ASSERT_DEEP(bw_fir_state_is_valid(coeffs, state));
+	BW_ASSERT(bw_is_finite(x));
+
+	const size_t n = coeffs->len;
+	state->idx = state->idx + 1 == n ? 0 : state->idx + 1;
+	state->buf[state->idx] = x;
+	state->buf[state->idx + n] = x;
+	// w[0] is the oldest sample and w[n - 1] the newest
+	const float y = bw_fir_dot(coeffs->h, state->buf + state->idx + 1, n);
+
+	BW_ASSERT_DEEP(bw_fir_coeffs_is_valid(coeffs));
+	BW_ASSERT_DEEP(bw_fir_state_is_valid(coeffs, state));
+	BW_ASSERT(bw_is_finite(y));
+
+	return y;
+}
+
+static inline void bw_fir_process(
+		const bw_fir_coeffs * BW_RESTRICT coeffs,
+		bw_fir_state * BW_RESTRICT        state,
+		const float *                     x,
+		float *                           y,
+		size_t                            n_samples) {
+	BW_ASSERT(coeffs != BW_NULL);
+	BW_ASSERT_DEEP(bw_fir_coeffs_is_valid(coeffs));
+	BW_ASSERT(state != BW_NULL);
+	BW_ASSERT_DEEP(bw_fir_state_is_valid(coeffs, state));
+	BW_ASSERT(x != BW_NULL);
+	BW_ASSERT_DEEP(bw_has_only_finite(x, n_samples));
+	BW_ASSERT(y != BW_NULL);
+	BW_ASSERT(x == y || x + n_samples <= y || y + n_samples <= x);
+
+	const size_t n = coeffs->len;
+	float * BW_RESTRICT buf = state->buf;
+	size_t idx = state->idx;
+	for (size_t i = 0; i < n_samples; i++) {
+		idx = idx + 1 == n ? 0 : idx + 1;
+		const float v = x[i];
+		buf[idx] = v;
+		buf[idx + n] = v;
+		y[i] = bw_fir_dot(coeffs->h, buf + idx + 1, n);
+	}
+	state->idx = idx;
+
+	BW_ASSERT_DEEP(bw_fir_coeffs_is_valid(coeffs));
+	BW_ASSERT_DEEP(bw_fir_state_is_valid(coeffs, state));
+	BW_ASSERT_DEEP(bw_has_only_finite(y, n_samples));
+}
+
+static inline void bw_fir_process_multi(
+		const bw_fir_coeffs * BW_RESTRICT              coeffs,
+		bw_fir_state * BW_RESTRICT const * BW_RESTRICT state,
+		const float * const *                          x,
+		float * const *                                y,
+		size_t                                         n_channels,
+		size_t                                         n_samples) {
+	BW_ASSERT(coeffs != BW_NULL);
+	BW_ASSERT_DEEP(bw_fir_coeffs_is_valid(coeffs));
+	BW_ASSERT(state != BW_NULL);
+#ifndef BW_NO_DEBUG
+	for (size_t i = 0; i < n_channels; i++)
+		for (size_t j = i + 1; j < n_channels; j++)
+			BW_ASSERT(state[i] != state[j]);
+#endif
+	BW_ASSERT(x != BW_NULL);
+	BW_ASSERT(y != BW_NULL);
+#ifndef BW_NO_DEBUG
+	for (size_t i = 0; i < n_channels; i++)
+		for (size_t j = i + 1; j < n_channels; j++)
+			BW_ASSERT(y[i] != y[j]);
+#endif
+
+	for (size_t i = 0; i < n_channels; i++)
+		bw_fir_process(coeffs, state[i], x[i], y[i], n_samples);
+
+	BW_ASSERT_DEEP(bw_fir_coeffs_is_valid(coeffs));
+}
+
+static inline void bw_fir_set_taps(
+		bw_fir_coeffs * BW_RESTRICT coeffs,
+		const float *               taps) {
+	BW_ASSERT(coeffs != BW_NULL);
+	BW_ASSERT_DEEP(bw_fir_coeffs_is_valid(coeffs));
+	BW_ASSERT(taps != BW_NULL);
+	BW_ASSERT_DEEP(bw_has_only_finite(taps, coeffs->n_taps));
+
+	const size_t n = coeffs->len;
+	coeffs->sum = 0.f;
+	for (size_t i = 0; i < coeffs->n_taps; i++) {
+		coeffs->h[n - 1 - i] = taps[i];
+		coeffs->sum += taps[i];
+	}
+
+	BW_ASSERT_DEEP(bw_fir_coeffs_is_valid(coeffs));
+}
+
+static inline size_t bw_fir_get_n_taps(
+		const bw_fir_coeffs * BW_RESTRICT coeffs) {
+	BW_ASSERT(coeffs != BW_NULL);
+	BW_ASSERT_DEEP(bw_fir_coeffs_is_valid(coeffs));
+
+	return coeffs->n_taps;
+}
+
+static inline char bw_fir_coeffs_is_valid(
+		const bw_fir_coeffs * BW_RESTRICT coeffs) {
+	BW_ASSERT(coeffs != BW_NULL);
+
+#ifdef BW_DEBUG_DEEP
+	if (coeffs->hash != bw_hash_sdbm("bw_fir_coeffs"))
+		return 0;
+#endif
+
+	if (coeffs->n_taps < 1 || coeffs->n_taps > BW_FIR_TAPS_MAX)
+		return 0;
+	if (coeffs->len != ((coeffs->n_taps + 3) & ~(size_t)3))
+		return 0;
+	if (!bw_is_finite(coeffs->sum))
+		return 0;
+
+#ifdef BW_DEBUG_DEEP
+	if (!bw_has_only_finite(coeffs->h, coeffs->len))
+		return 0;
+	for (size_t i = 0; i < coeffs->len - coeffs->n_taps; i++)
+		if (coeffs->h[i] != 0.f)
+			return 0;
+#endif
+
+	return 1;
+}
+
+static inline char bw_fir_state_is_valid(
+		const bw_fir_coeffs * BW_RESTRICT coeffs,
+		const bw_fir_state * BW_RESTRICT  state) {
+	BW_ASSERT(state != BW_NULL);
+
+#ifdef BW_DEBUG_DEEP
+	if (state->hash != bw_hash_sdbm("bw_fir_state"))
+		return 0;
+
+	if (coeffs != BW_NULL && coeffs->reset_id != state->coeffs_reset_id)
+		return 0;
+#endif
+
+	if (coeffs != BW_NULL && state->idx >= coeffs->len)
+		return 0;
+
+	return 1;
+}
+
+#undef BW_FIR_TAPS_MAX
+
+#ifdef __cplusplus
+}
+
+#ifndef BW_CXX_NO_ARRAY
+# include <array>
+#endif
+
+namespace Brickworks {
+
+/*** Public C++ API ***/
+
+/*! api_cpp {{{
+ *    ##### Brickworks::FIR
+ *  ```>>> */
+template<size_t N_CHANNELS>
+class FIR {
+public:
+	FIR(
+		size_t nTaps);
+
+	void reset(
+		float               x0 = 0.f,
+		float * BW_RESTRICT y0 = nullptr);
+
+#ifndef BW_CXX_NO_ARRAY
+	void reset(
+		float                                       x0,
+		std::array<float, N_CHANNELS> * BW_RESTRICT y0);
+#endif
+
+	void reset(
+		const float * x0,
+		float *       y0 = nullptr);
+
+#ifndef BW_CXX_NO_ARRAY
+	void reset(
+		std::array<float, N_CHANNELS>               x0,
+		std::array<float, N_CHANNELS> * BW_RESTRICT y0 = nullptr);
+#endif
+
+	void process(
+		const float * const * x,
+		float * const *       y,
+		size_t                nSamples);
+
+#ifndef BW_CXX_NO_ARRAY
+	void process(
+		std::array<const float *, N_CHANNELS> x,
+		std::array<float *, N_CHANNELS>       y,
+		size_t                                nSamples);
+#endif
+
+	void setTaps(
+		const float * taps);
+
+	size_t getNTaps();
+/*! <<<...
+ *  }
+ *  ```
+ *  }}} */
+
+/*** Implementation ***/
+
+/* WARNING: This part of the file is not part of the public API. Its content may
+ * change at any time in future versions. Please, do not use it directly. */
+
+private:
+	bw_fir_coeffs			coeffs;
+	bw_fir_state			states[N_CHANNELS];
+	bw_fir_state * BW_RESTRICT	statesP[N_CHANNELS];
+};
+
+template<size_t N_CHANNELS>
+inline FIR<N_CHANNELS>::FIR(
+		size_t nTaps) {
+	bw_fir_init(&coeffs, nTaps);
+	for (size_t i = 0; i < N_CHANNELS; i++)
+		statesP[i] = states + i;
+}
+
+template<size_t N_CHANNELS>
+inline void FIR<N_CHANNELS>::reset(
+		float               x0,
+		float * BW_RESTRICT y0) {
+	if (y0 != nullptr)
+		for (size_t i = 0; i < N_CHANNELS; i++)
+			y0[i] = bw_fir_reset_state(&coeffs, states + i, x0);
+	else
+		for (size_t i = 0; i < N_CHANNELS; i++)
+			bw_fir_reset_state(&coeffs, states + i, x0);
+}
+
+#ifndef BW_CXX_NO_ARRAY
+template<size_t N_CHANNELS>
+inline void FIR<N_CHANNELS>::reset(
+		float                                       x0,
+		std::array<float, N_CHANNELS> * BW_RESTRICT y0) {
+	reset(x0, y0 != nullptr ? y0->data() : nullptr);
+}
+#endif
+
+template<size_t N_CHANNELS>
+inline void FIR<N_CHANNELS>::reset(
+		const float * x0,
+		float *       y0) {
+	bw_fir_reset_state_multi(&coeffs, statesP, x0, y0, N_CHANNELS);
+}
+
+#ifndef BW_CXX_NO_ARRAY
+template<size_t N_CHANNELS>
+inline void FIR<N_CHANNELS>::reset(
+		std::array<float, N_CHANNELS>               x0,
+		std::array<float, N_CHANNELS> * BW_RESTRICT y0) {
+	reset(x0.data(), y0 != nullptr ? y0->data() : nullptr);
+}
+#endif
+
+template<size_t N_CHANNELS>
+inline void FIR<N_CHANNELS>::process(
+		const float * const * x,
+		float * const *       y,
+		size_t                nSamples) {
+	bw_fir_process_multi(&coeffs, statesP, x, y, N_CHANNELS, nSamples);
+}
+
+#ifndef BW_CXX_NO_ARRAY
+template<size_t N_CHANNELS>
+inline void FIR<N_CHANNELS>::process(
+		std::array<const float *, N_CHANNELS> x,
+		std::array<float *, N_CHANNELS>       y,
+		size_t                                nSamples) {
+	process(x.data(), y.data(), nSamples);
+}
+#endif
+
+template<size_t N_CHANNELS>
+inline void FIR<N_CHANNELS>::setTaps(
+		const float * taps) {
+	bw_fir_set_taps(&coeffs, taps);
+}
+
+template<size_t N_CHANNELS>
+inline size_t FIR<N_CHANNELS>::getNTaps() {
+	return bw_fir_get_n_taps(&coeffs);
+}
+
+}
+#endif
+
+#endif
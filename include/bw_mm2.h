@@ -20,13 +20,18 @@
 
 /*!
  *  module_type {{{ dsp }}}
- *  version {{{ 1.1.1 }}}
+ *  version {{{ 1.2.0 }}}
  *  requires {{{ bw_common bw_gain bw_math bw_one_pole bw_svf }}}
  *  description {{{
  *    Second-order multimode filter.
  *  }}}
  *  changelog {{{
  *    <ul>
+ *      <li>Version <strong>1.2.0</strong>:
+ *        <ul>
+ *          <li>Added <code>bw_mm2_set_block_mode()</code>.</li>
+ *        </ul>
+ *      </li>
  *      <li>Version <strong>1.1.1</strong>:
  *        <ul>
  *          <li>Added debugging check in <code>bw_mm2_process_multi()</code> to
@@ -311,6 +316,22 @@ static inline void bw_mm2_set_coeff_hp(
  *
  *    Default value: `0.f`.
  *
+ *    #### bw_mm2_set_block_mode()
+ *  ```>>> */
+static inline void bw_mm2_set_block_mode(
+	bw_mm2_coeffs * BW_RESTRICT coeffs,
+	char                        value);
+/*! <<<```
+ *    Sets whether block processing should be used (non-`0`) or not (`0`) in
+ *    `coeffs`.
+ *
+ *    When on, `bw_mm2_process()` and `bw_mm2_process_multi()` use block
+ *    state-space processing for the internal state variable filter (see
+ *    `bw_svf_set_block_mode()`) whenever neither filter parameters nor mode
+ *    coefficients are being smoothed.
+ *
+ *    Default value: `0` (off).
+ *
  *    #### bw_mm2_coeffs_is_valid()
  *  ```>>> */
 static inline char bw_mm2_coeffs_is_valid(
@@ -576,6 +597,38 @@ static inline float bw_mm2_process1(
 	return y;
 }
 
+static inline char bw_mm2_block_is_ready(
+		const bw_mm2_coeffs * BW_RESTRICT coeffs) {
+	return bw_svf_block_is_ready(&coeffs->svf_coeffs)
+		&& bw_gain_get_gain_cur(&coeffs->gain_x_coeffs) == bw_gain_get_gain_lin(&coeffs->gain_x_coeffs)
+		&& bw_gain_get_gain_cur(&coeffs->gain_lp_coeffs) == bw_gain_get_gain_lin(&coeffs->gain_lp_coeffs)
+		&& bw_gain_get_gain_cur(&coeffs->gain_bp_coeffs) == bw_gain_get_gain_lin(&coeffs->gain_bp_coeffs)
+		&& bw_gain_get_gain_cur(&coeffs->gain_hp_coeffs) == bw_gain_get_gain_lin(&coeffs->gain_hp_coeffs);
+}
+
+static inline size_t bw_mm2_block_process(
+		const bw_mm2_coeffs * BW_RESTRICT coeffs,
+		bw_mm2_state * BW_RESTRICT        state,
+		const float *                     x,
+		float *                           y,
+		size_t                            n_samples) {
+	const float gx = bw_gain_get_gain_cur(&coeffs->gain_x_coeffs);
+	const float glp = bw_gain_get_gain_cur(&coeffs->gain_lp_coeffs);
+	const float gbp = bw_gain_get_gain_cur(&coeffs->gain_bp_coeffs);
+	const float ghp = bw_gain_get_gain_cur(&coeffs->gain_hp_coeffs);
+	size_t n = 0;
+	while (n < n_samples) {
+		float lp[64], bp[64], hp[64];
+		const size_t m = bw_svf_block_process(&coeffs->svf_coeffs, &state->svf_state, x + n, lp, bp, hp, n_samples - n > 64 ? 64 : n_samples - n);
+		if (m == 0)
+			break;
+		for (size_t i = 0; i < m; i++)
+			y[n + i] = gx * x[n + i] + glp * lp[i] + gbp * bp[i] + ghp * hp[i];
+		n += m;
+	}
+	return n;
+}
+
 static inline void bw_mm2_process(
 		bw_mm2_coeffs * BW_RESTRICT coeffs,
 		bw_mm2_state * BW_RESTRICT  state,
@@ -592,7 +645,12 @@ static inline void bw_mm2_process(
 	BW_ASSERT(y != BW_NULL);
 
 	bw_mm2_update_coeffs_ctrl(coeffs);
-	for (size_t i = 0; i < n_samples; i++) {
+	size_t n_block = 0;
+	if (bw_mm2_block_is_ready(coeffs) && bw_svf_block_state_is_ready(&coeffs->svf_coeffs, &state->svf_state)) {
+		bw_svf_block_update(&coeffs->svf_coeffs);
+		n_block = bw_mm2_block_process(coeffs, state, x, y, n_samples);
+	}
+	for (size_t i = n_block; i < n_samples; i++) {
 		bw_mm2_update_coeffs_audio(coeffs);
 		y[i] = bw_mm2_process1(coeffs, state, x[i]);
 	}
@@ -631,7 +689,18 @@ static inline void bw_mm2_process_multi(
 #endif
 
 	bw_mm2_update_coeffs_ctrl(coeffs);
-	for (size_t i = 0; i < n_samples; i++) {
+	size_t n_block = 0;
+	if (bw_mm2_block_is_ready(coeffs)) {
+		char ready = 1;
+		for (size_t j = 0; j < n_channels; j++)
+			ready = ready && bw_svf_block_state_is_ready(&coeffs->svf_coeffs, &state[j]->svf_state);
+		if (ready) {
+			bw_svf_block_update(&coeffs->svf_coeffs);
+			for (size_t j = 0; j < n_channels; j++)
+				n_block = bw_mm2_block_process(coeffs, state[j], x[j], y[j], n_samples);
+		}
+	}
+	for (size_t i = n_block; i < n_samples; i++) {
 		bw_mm2_update_coeffs_audio(coeffs);
 		for (size_t j = 0; j < n_channels; j++)
 			y[j][i] = bw_mm2_process1(coeffs, state[j], x[j][i]);
@@ -755,6 +824,19 @@ static inline void bw_mm2_set_coeff_hp(
 	BW_ASSERT_DEEP(coeffs->state >= bw_mm2_coeffs_state_init);
 }
 
+static inline void bw_mm2_set_block_mode(
+		bw_mm2_coeffs * BW_RESTRICT coeffs,
+		char                        value) {
+	BW_ASSERT(coeffs != BW_NULL);
+	BW_ASSERT_DEEP(bw_mm2_coeffs_is_valid(coeffs));
+	BW_ASSERT_DEEP(coeffs->state >= bw_mm2_coeffs_state_init);
+
+	bw_svf_set_block_mode(&coeffs->svf_coeffs, value);
+
+	BW_ASSERT_DEEP(bw_mm2_coeffs_is_valid(coeffs));
+	BW_ASSERT_DEEP(coeffs->state >= bw_mm2_coeffs_state_init);
+}
+
 static inline char bw_mm2_coeffs_is_valid(
 		const bw_mm2_coeffs * BW_RESTRICT coeffs) {
 	BW_ASSERT(coeffs != BW_NULL);
@@ -866,6 +948,9 @@ public:
 
 	void setCoeffHp(
 		float value);
+
+	void setBlockMode(
+		bool value);
 /*! <<<...
  *  }
  *  ```
@@ -1000,6 +1085,13 @@ inline void MM2<N_CHANNELS>::setCoeffHp(
 	bw_mm2_set_coeff_hp(&coeffs, value);
 }
 
+
+template<size_t N_CHANNELS>
+inline void MM2<N_CHANNELS>::setBlockMode(
+		bool value) {
+	bw_mm2_set_block_mode(&coeffs, value);
+}
+
 }
 #endif
 
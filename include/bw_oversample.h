@@ -0,0 +1,1128 @@
+/*
+ * Brickworks
+ *
+ * Copyright (C) 2024 Orastron Srl unipersonale
+ *
+ * Brickworks is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3 of the License.
+ *
+ * Brickworks is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Brickworks.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * File author: Stefano D'Angelo
+ */
+
+/*!
+ *  module_type {{{ dsp }}}
+ *  version {{{ 1.0.0 }}}
+ *  requires {{{ bw_common }}}
+ *  description {{{
+ *    Polyphase FIR oversampler by factors of 2, 4, or 8.
+ *
+ *    Upsampling and downsampling are performed by cascades of 2x polyphase
+ *    half-band FIR filters, either linear-phase or minimum-phase. The first
+ *    stage (the one closest to the original sample rate) uses 63 taps, the
+ *    second 23, and the third 15, all giving more than 100 dB of image/alias
+ *    rejection with the passband extending up to 0.4 times the original
+ *    sample rate. Linear-phase filters have only one non-zero odd-phase
+ *    coefficient, hence they are cheaper than minimum-phase ones.
+ *
+ *    Filter histories are stored twice in a row, so that convolutions are
+ *    computed on contiguous memory and can be vectorized by the compiler.
+ *
+ *    A helper function is also provided that runs a given callback at the
+ *    oversampled rate in chunks of fixed maximum size, using caller-provided
+ *    scratch buffers, so that several modules can share the same filters and
+ *    memory.
+ *  }}}
+ *  changelog {{{
+ *    <ul>
+ *      <li>Version <strong>1.0.0</strong>:
+ *        <ul>
+ *          <li>First release.</li>
+ *        </ul>
+ *      </li>
+ *    </ul>
+ *  }}}
+ */
+
+#ifndef BW_OVERSAMPLE_H
+#define BW_OVERSAMPLE_H
+
+#include <bw_common.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*! api {{{
+ *    #### bw_oversample_coeffs
+ *  ```>>> */
+typedef struct bw_oversample_coeffs bw_oversample_coeffs;
+/*! <<<```
+ *    Coefficients and related.
+ *
+ *    #### bw_oversample_state
+ *  ```>>> */
+typedef struct bw_oversample_state bw_oversample_state;
+/*! <<<```
+ *    Internal state and related. It contains both upsampling and downsampling
+ *    filter states for one channel.
+ *
+ *    #### bw_oversample_callback
+ *  ```>>> */
+typedef void (*bw_oversample_callback)(
+	void *        data,
+	const float * x,
+	float *       y,
+	size_t        n_samples);
+/*! <<<```
+ *    Callback type used by `bw_oversample_process()`.
+ *
+ *    It should process the first `n_samples` of the input buffer `x` and fill
+ *    the first `n_samples` of the output buffer `y`. `data` is the opaque
+ *    pointer passed to `bw_oversample_process()`.
+ *
+ *    `x` and `y` point to the same buffer.
+ *
+ *    #### bw_oversample_callback_multi
+ *  ```>>> */
+typedef void (*bw_oversample_callback_multi)(
+	void *                data,
+	const float * const * x,
+	float * const *       y,
+	size_t                n_channels,
+	size_t                n_samples);
+/*! <<<```
+ *    Callback type used by `bw_oversample_process_multi()`.
+ *
+ *    It should process the first `n_samples` of the `n_channels` input
+ *    buffers `x` and fill the first `n_samples` of the `n_channels` output
+ *    buffers `y`. `data` is the opaque pointer passed to
+ *    `bw_oversample_process_multi()`.
+ *
+ *    `x` and `y` point to the same buffers.
+ *
+ *    #### bw_oversample_init()
+ *  ```>>> */
+static inline void bw_oversample_init(
+	bw_oversample_coeffs * BW_RESTRICT coeffs,
+	size_t                             factor,
+	char                               min_phase);
+/*! <<<```
+ *    Initializes `coeffs` using the given oversampling `factor` and filter
+ *    type, i.e., minimum-phase if `min_phase` is non-`0` or linear-phase
+ *    otherwise.
+ *
+ *    `factor` must be either `2`, `4`, or `8`.
+ *
+ *    #### bw_oversample_reset_state()
+ *  ```>>> */
+static inline float bw_oversample_reset_state(
+	const bw_oversample_coeffs * BW_RESTRICT coeffs,
+	bw_oversample_state * BW_RESTRICT        state,
+	float                                    x_0);
+/*! <<<```
+ *    Resets the given `state` to its initial values using the given `coeffs`
+ *    and the initial input value `x_0`, both at the original and at the
+ *    oversampled rate.
+ *
+ *    Returns the corresponding initial output value.
+ *
+ *    #### bw_oversample_reset_state_multi()
+ *  ```>>> */
+static inline void bw_oversample_reset_state_multi(
+	const bw_oversample_coeffs * BW_RESTRICT              coeffs,
+	bw_oversample_state * BW_RESTRICT const * BW_RESTRICT state,
+	const float *                                         x_0,
+	float *                                               y_0,
+	size_t                                                n_channels);
+/*! <<<```
+ *    Resets each of the `n_channels` `state`s to its initial values using the
+ *    given `coeffs` and the corresponding initial input value in the `x_0`
+ *    array.
+ *
+ *    The corresponding initial output values are written into the `y_0` array,
+ *    if not `BW_NULL`.
+ *
+ *    #### bw_oversample_up1()
+ *  ```>>> */
+static inline void bw_oversample_up1(
+	const bw_oversample_coeffs * BW_RESTRICT coeffs,
+	bw_oversample_state * BW_RESTRICT        state,
+	float                                    x,
+	float * BW_RESTRICT                      y);
+/*! <<<```
+ *    Upsamples one input sample `x`, writing `factor` output samples into `y`,
+ *    using `coeffs`, while using and updating `state`.
+ *
+ *    #### bw_oversample_down1()
+ *  ```>>> */
+static inline float bw_oversample_down1(
+	const bw_oversample_coeffs * BW_RESTRICT coeffs,
+	bw_oversample_state * BW_RESTRICT        state,
+	const float * BW_RESTRICT                x);
+/*! <<<```
+ *    Downsamples `factor` input samples from `x` using `coeffs`, while using
+ *    and updating `state`.
+ *
+ *    Returns the corresponding output sample.
+ *
+ *    #### bw_oversample_up()
+ *  ```>>> */
+static inline void bw_oversample_up(
+	const bw_oversample_coeffs * BW_RESTRICT coeffs,
+	bw_oversample_state * BW_RESTRICT        state,
+	const float * BW_RESTRICT                x,
+	float * BW_RESTRICT                      y,
+	size_t                                   n_samples);
+/*! <<<```
+ *    Upsamples the first `n_samples` of the input buffer `x` and fills the
+ *    first `factor` times `n_samples` of the output buffer `y` using
+ *    `coeffs`, while using and updating `state`.
+ *
+ *    `x` and `y` must point to different buffers.
+ *
+ *    #### bw_oversample_up_multi()
+ *  ```>>> */
+static inline void bw_oversample_up_multi(
+	const bw_oversample_coeffs * BW_RESTRICT              coeffs,
+	bw_oversample_state * BW_RESTRICT const * BW_RESTRICT state,
+	const float * BW_RESTRICT const * BW_RESTRICT         x,
+	float * BW_RESTRICT const * BW_RESTRICT               y,
+	size_t                                                n_channels,
+	size_t                                                n_samples);
+/*! <<<```
+ *    Upsamples the first `n_samples` of the `n_channels` input buffers `x` and
+ *    fills the first `factor` times `n_samples` of the `n_channels` output
+ *    buffers `y` using `coeffs`, while using and updating each of the
+ *    `n_channels` `state`s.
+ *
+ *    A given buffer cannot be used both as an input and output buffer.
+ *
+ *    #### bw_oversample_down()
+ *  ```>>> */
+static inline void bw_oversample_down(
+	const bw_oversample_coeffs * BW_RESTRICT coeffs,
+	bw_oversample_state * BW_RESTRICT        state,
+	const float * BW_RESTRICT                x,
+	float * BW_RESTRICT                      y,
+	size_t                                   n_samples);
+/*! <<<```
+ *    Downsamples the first `factor` times `n_samples` of the input buffer `x`
+ *    and fills the first `n_samples` of the output buffer `y` using `coeffs`,
+ *    while using and updating `state`.
+ *
+ *    `x` and `y` must point to different buffers.
+ *
+ *    #### bw_oversample_down_multi()
+ *  ```>>> */
+static inline void bw_oversample_down_multi(
+	const bw_oversample_coeffs * BW_RESTRICT              coeffs,
+	bw_oversample_state * BW_RESTRICT const * BW_RESTRICT state,
+	const float * BW_RESTRICT const * BW_RESTRICT         x,
+	float * BW_RESTRICT const * BW_RESTRICT               y,
+	size_t                                                n_channels,
+	size_t                                                n_samples);
+/*! <<<```
+ *    Downsamples the first `factor` times `n_samples` of the `n_channels`
+ *    input buffers `x` and fills the first `n_samples` of the `n_channels`
+ *    output buffers `y` using `coeffs`, while using and updating each of the
+ *    `n_channels` `state`s.
+ *
+ *    A given buffer cannot be used both as an input and output buffer.
+ *
+ *    #### bw_oversample_process()
+ *  ```>>> */
+static inline void bw_oversample_process(
+	const bw_oversample_coeffs * BW_RESTRICT coeffs,
+	bw_oversample_state * BW_RESTRICT        state,
+	const float *                            x,
+	float *                                  y,
+	size_t                                   n_samples,
+	float * BW_RESTRICT                      buf,
+	size_t                                   buf_len,
+	bw_oversample_callback                   callback,
+	void *                                   data);
+/*! <<<```
+ *    Processes the first `n_samples` of the input buffer `x` and fills the
+ *    first `n_samples` of the output buffer `y` by upsampling, calling
+ *    `callback` on the upsampled signal, and downsampling, using `coeffs`,
+ *    while using and updating `state`.
+ *
+ *    This is done in chunks of at most `buf_len` samples at the oversampled
+ *    rate (i.e., `buf_len` divided by `factor` input samples), which are
+ *    stored in the scratch buffer `buf` (`buf_len` samples long). `callback`
+ *    is passed `data` and `buf` as both input and output buffer.
+ *
+ *    `buf_len` must be greater than or equal to `factor`.
+ *
+ *    #### bw_oversample_process_multi()
+ *  ```>>> */
+static inline void bw_oversample_process_multi(
+	const bw_oversample_coeffs * BW_RESTRICT              coeffs,
+	bw_oversample_state * BW_RESTRICT const * BW_RESTRICT state,
+	const float * const *                                 x,
+	float * const *                                       y,
+	size_t                                                n_channels,
+	size_t                                                n_samples,
+	float * const *                                       buf,
+	size_t                                                buf_len,
+	bw_oversample_callback_multi                          callback,
+	void *                                                data);
+/*! <<<```
+ *    Processes the first `n_samples` of the `n_channels` input buffers `x` and
+ *    fills the first `n_samples` of the `n_channels` output buffers `y` by
+ *    upsampling, calling `callback` on the upsampled signals, and
+ *    downsampling, using `coeffs`, while using and updating each of the
+ *    `n_channels` `state`s.
+ *
+ *    This is done in chunks of at most `buf_len` samples at the oversampled
+ *    rate (i.e., `buf_len` divided by `factor` input samples), which are
+ *    stored in the `n_channels` scratch buffers `buf` (each `buf_len` samples
+ *    long). `callback` is passed `data` and `buf` as both input and output
+ *    buffers.
+ *
+ *    `buf_len` must be greater than or equal to `factor`.
+ *
+ *    #### bw_oversample_get_factor()
+ *  ```>>> */
+static inline size_t bw_oversample_get_factor(
+	const bw_oversample_coeffs * BW_RESTRICT coeffs);
+/*! <<<```
+ *    Returns the oversampling factor used by `coeffs`.
+ *
+ *    #### bw_oversample_get_latency()
+ *  ```>>> */
+static inline float bw_oversample_get_latency(
+	const bw_oversample_coeffs * BW_RESTRICT coeffs);
+/*! <<<```
+ *    Returns the overall latency (samples at the original sample rate) of
+ *    upsampling followed by downsampling using `coeffs`.
+ *
+ *    With linear-phase filters this is the exact (constant) group delay,
+ *    while with minimum-phase filters it is the group delay at DC, which
+ *    increases with frequency.
+ *
+ *    #### bw_oversample_coeffs_is_valid()
+ *  ```>>> */
+static inline char bw_oversample_coeffs_is_valid(
+	const bw_oversample_coeffs * BW_RESTRICT coeffs);
+/*! <<<```
+ *    Tries to determine whether `coeffs` is valid and returns non-`0` if it
+ *    seems to be the case and `0` if it is certainly not. False positives are
+ *    possible, false negatives are not.
+ *
+ *    `coeffs` must at least point to a readable memory block of size greater
+ *    than or equal to that of `bw_oversample_coeffs`.
+ *
+ *    #### bw_oversample_state_is_valid()
+ *  ```>>> */
+static inline char bw_oversample_state_is_valid(
+	const bw_oversample_coeffs * BW_RESTRICT coeffs,
+	const bw_oversample_state * BW_RESTRICT  state);
+/*! <<<```
+ *    Tries to determine whether `state` is valid and returns non-`0` if it
+ *    seems to be the case and `0` if it is certainly not. False positives are
+ *    possible, false negatives are not.
+ *
+ *    If `coeffs` is not `BW_NULL` extra cross-checks might be performed
+ *    (`state` is supposed to be associated to `coeffs`).
+ *
+ *    `state` must at least point to a readable memory block of size greater
+ *    than or equal to that of `bw_oversample_state`.
+ *  }}} */
+
+#ifdef __cplusplus
+}
+#endif
+
+/*** Implementation ***/
+
+/* WARNING: This part of the file is not part of the public API. Its content may
+ * change at any time in future versions. Please, do not use it directly. */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Half-band filter polyphase components (even-phase e0, odd-phase e1), in
+// reverse order. Linear-phase filters only have one non-zero odd-phase
+// coefficient, which is 0.5f.
+
+static const float bw_oversample_lin_1_e0[32] = {
+	-1.931257538e-05f, 7.186001437e-05f, -1.939380584e-04f, 4.405910390e-04f,
+	-8.874321405e-04f, 1.640714621e-03f, -2.835415273e-03f, 4.647935099e-03f,
+	-7.303741918e-03f, 1.111425943e-02f, -1.654585002e-02f, 2.441265750e-02f,
+	-3.639707254e-02f, 5.686134510e-02f, -1.018889990e-01f, 3.168823988e-01f,
+	3.168823988e-01f, -1.018889990e-01f, 5.686134510e-02f, -3.639707254e-02f,
+	2.441265750e-02f, -1.654585002e-02f, 1.111425943e-02f, -7.303741918e-03f,
+	4.647935099e-03f, -2.835415273e-03f, 1.640714621e-03f, -8.874321405e-04f,
+	4.405910390e-04f, -1.939380584e-04f, 7.186001437e-05f, -1.931257538e-05f
+};
+static const float bw_oversample_min_1_e0[32] = {
+	9.142087502e-08f, 2.330298014e-06f, -1.007977079e-06f, -5.380151367e-06f,
+	2.280923443e-05f, -6.077677758e-05f, 1.294254023e-04f, -2.417557505e-04f,
+	4.089548740e-04f, -6.416598161e-04f, 9.460038190e-04f, -1.327642428e-03f,
+	1.794767248e-03f, -2.371410718e-03f, 3.084808056e-03f, -4.010924721e-03f,
+	5.269746327e-03f, -7.056477518e-03f, 9.670296896e-03f, -1.354684567e-02f,
+	1.930807400e-02f, -2.781698861e-02f, 4.024251918e-02f, -5.807234826e-02f,
+	8.289586078e-02f, -1.152830395e-01f, 1.505267767e-01f, -1.637943830e-01f,
+	6.291798893e-02f, 3.925193985e-01f, 1.204110255e-01f, 4.079763707e-03f
+};
+static const float bw_oversample_min_1_e1[31] = {
+	-7.224319140e-07f, -3.194523637e-06f, 8.852034348e-06f, -1.668085678e-05f,
+	2.387946551e-05f, -2.101877625e-05f, -7.590709607e-06f, 9.009646879e-05f,
+	-2.671626712e-04f, 5.978920537e-04f, -1.159478882e-03f, 2.051160828e-03f,
+	-3.388080005e-03f, 5.286756976e-03f, -7.880441232e-03f, 1.128360887e-02f,
+	-1.558666715e-02f, 2.083765694e-02f, -2.700557970e-02f, 3.394310448e-02f,
+	-4.129579486e-02f, 4.835288348e-02f, -5.372233594e-02f, 5.469487620e-02f,
+	-4.593942638e-02f, 1.706584912e-02f, 5.086242000e-02f, -1.821120619e-01f,
+	3.287632035e-01f, 2.723046247e-01f, 3.223937096e-02f
+};
+static const float bw_oversample_lin_2_e0[12] = {
+	-3.372062318e-04f, 2.478800068e-03f, -1.008522213e-02f, 3.045011542e-02f,
+	-8.188738959e-02f, 3.093809025e-01f, 3.093809025e-01f, -8.188738959e-02f,
+	3.045011542e-02f, -1.008522213e-02f, 2.478800068e-03f, -3.372062318e-04f
+};
+static const float bw_oversample_min_2_e0[12] = {
+	7.468916995e-06f, 8.360506215e-05f, -7.506354420e-04f, 3.131028682e-03f,
+	-9.421598831e-03f, 2.341438185e-02f, -5.145172659e-02f, 1.040972004e-01f,
+	-1.971303976e-01f, 3.173692728e-01f, 2.954272335e-01f, 1.522416742e-02f
+};
+static const float bw_oversample_min_2_e1[11] = {
+	-5.027023052e-05f, 1.932406441e-04f, -9.258533170e-05f, -1.705325280e-03f,
+	7.993472374e-03f, -2.128720851e-02f, 3.923609008e-02f, -4.435191902e-02f,
+	-2.991817651e-02f, 4.475150274e-01f, 1.024676544e-01f
+};
+static const float bw_oversample_lin_3_e0[8] = {
+	-1.585586107e-03f, 1.365554602e-02f, -6.271622932e-02f, 3.006462694e-01f,
+	3.006462694e-01f, -6.271622932e-02f, 1.365554602e-02f, -1.585586107e-03f
+};
+static const float bw_oversample_min_3_e0[8] = {
+	8.235352485e-05f, 2.871798370e-04f, -6.151503991e-03f, 3.068191944e-02f,
+	-8.326322748e-02f, 1.149898527e-01f, 4.128454879e-01f, 3.052793803e-02f
+};
+static const float bw_oversample_min_3_e1[7] = {
+	-4.818581561e-04f, 3.664037824e-03f, -1.542073270e-02f, 5.080445870e-02f,
+	-1.516665442e-01f, 4.344788254e-01f, 1.786218132e-01f
+};
+
+static const float bw_oversample_lin_e1[1] = { 0.5f };
+
+#define BW_OVERSAMPLE_LEN_MAX	32
+
+struct bw_oversample_coeffs {
+#ifdef BW_DEBUG_DEEP
+	uint32_t			hash;
+	uint32_t			reset_id;
+#endif
+
+	// Coefficients
+	size_t				factor;
+	size_t				n_stages;
+	const float *			e0[3];
+	const float *			e1[3];
+	size_t				n0[3];
+	size_t				n1[3];
+	size_t				len[3];		// history lengths
+	size_t				o0[3];		// offsets of even-phase taps in histories
+	size_t				o1[3];		// offsets of odd-phase taps in upsampling histories
+	float				latency;
+};
+
+struct bw_oversample_state {
+#ifdef BW_DEBUG_DEEP
+	uint32_t			hash;
+	uint32_t			coeffs_reset_id;
+#endif
+
+	// Buffers (each history is stored twice in a row)
+	float				up_buf[3][2 * BW_OVERSAMPLE_LEN_MAX];
+	float				down_e_buf[3][2 * BW_OVERSAMPLE_LEN_MAX];
+	float				down_o_buf[3][2 * BW_OVERSAMPLE_LEN_MAX];
+
+	// States
+	size_t				up_idx[3];
+	size_t				down_idx[3];
+};
+
+static inline void bw_oversample_init(
+		bw_oversample_coeffs * BW_RESTRICT coeffs,
+		size_t                             factor,
+		char                               min_phase) {
+	BW_ASSERT(coeffs != BW_NULL);
+	BW_ASSERT(factor == 2 || factor == 4 || factor == 8);
+
+	static const float * const lin_e0[3] = { bw_oversample_lin_1_e0, bw_oversample_lin_2_e0, bw_oversample_lin_3_e0 };
+	static const float * const min_e0[3] = { bw_oversample_min_1_e0, bw_oversample_min_2_e0, bw_oversample_min_3_e0 };
+	static const float * const min_e1[3] = { bw_oversample_min_1_e1, bw_oversample_min_2_e1, bw_oversample_min_3_e1 };
+	static const size_t n0[3] = { 32, 12, 8 };
+	static const float min_gd[3] = { 3.280439148f, 2.366602292f, 1.949220890f }; // group delays at DC
+
+	coeffs->factor = factor;
+	coeffs->n_stages = factor == 2 ? 1 : (factor == 4 ? 2 : 3);
+	coeffs->latency = 0.f;
+	for (size_t i = 0; i < coeffs->n_stages; i++) {
+		// round-trip group delay at 2^(i + 1) times the original rate
+		float gd;
+		coeffs->n0[i] = n0[i];
+		coeffs->len[i] = n0[i];
+		coeffs->o0[i] = 0;
+		if (min_phase) {
+			coeffs->e0[i] = min_e0[i];
+			coeffs->e1[i] = min_e1[i];
+			coeffs->n1[i] = n0[i] - 1;
+			coeffs->o1[i] = 1;
+			gd = 2.f * min_gd[i];
+		} else {
+			coeffs->e0[i] = lin_e0[i];
+			coeffs->e1[i] = bw_oversample_lin_e1;
+			coeffs->n1[i] = 1;
+			coeffs->o1[i] = n0[i] >> 1; // center tap
+			gd = (float)(2 * n0[i] - 2);
+		}
+		coeffs->latency += gd / (float)(2 << i);
+	}
+
+#ifdef BW_DEBUG_DEEP
+	coeffs->hash = bw_hash_sdbm("bw_oversample_coeffs");
+	coeffs->reset_id = coeffs->hash + 1;
+#endif
+	BW_ASSERT_DEEP(bw_oversample_coeffs_is_valid(coeffs));
+}
+
+static inline float bw_oversample_reset_state(
+		const bw_oversample_coeffs * BW_RESTRICT coeffs,
+		bw_oversample_state * BW_RESTRICT        state,
+		float                                    x_0) {
+	BW_ASSERT(coeffs != BW_NULL);
+	BW_ASSERT_DEEP(bw_oversample_coeffs_is_valid(coeffs));
+	BW_ASSERT(state != BW_NULL);
+	BW_ASSERT(bw_is_finite(x_0));
+
+	for (size_t i = 0; i < coeffs->n_stages; i++) {
+		for (size_t j = 0; j < 2 * coeffs->len[i]; j++) {
+			state->up_buf[i][j] = x_0;
+			state->down_e_buf[i][j] = x_0;
+			state->down_o_buf[i][j] = x_0;
+		}
+		state->up_idx[i] = 0;
+		state->down_idx[i] = 0;
+	}
+	const float y = x_0;
+
+#ifdef BW_DEBUG_DEEP
+	state->hash = bw_hash_sdbm("bw_oversample_state");
+	state->coeffs_reset_id = coeffs->reset_id;
+#endif
+	BW_ASSERT_DEEP(bw_oversample_coeffs_is_valid(coeffs));
+	BW_ASSERT_DEEP(bw_oversample_state_is_valid(coeffs, state));
+	BW_ASSERT(bw_is_finite(y));
+
+	return y;
+}
+
+static inline void bw_oversample_reset_state_multi(
+		const bw_oversample_coeffs * BW_RESTRICT              coeffs,
+		bw_oversample_state * BW_RESTRICT const * BW_RESTRICT state,
+		const float *                                         x_0,
+		float *                                               y_0,
+		size_t                                                n_channels) {
+	BW_ASSERT(coeffs != BW_NULL);
+	BW_ASSERT_DEEP(bw_oversample_coeffs_is_valid(coeffs));
+	BW_ASSERT(state != BW_NULL);
+#ifndef BW_NO_DEBUG
+	for (size_t i = 0; i < n_channels; i++)
+		for (size_t j = i + 1; j < n_channels; j++)
+			BW_ASSERT(state[i] != state[j]);
+#endif
+	BW_ASSERT(x_0 != BW_NULL);
+
+	if (y_0 != BW_NULL)
+		for (size_t i = 0; i < n_channels; i++)
+			y_0[i] = bw_oversample_reset_state(coeffs, state[i], x_0[i]);
+	else
+		for (size_t i = 0; i < n_channels; i++)
+			bw_oversample_reset_state(coeffs, state[i], x_0[i]);
+
+	BW_ASSERT_DEEP(bw_oversample_coeffs_is_valid(coeffs));
+	BW_ASSERT_DEEP(y_0 != BW_NULL ? bw_has_only_finite(y_0, n_channels) : 1);
+}
+
+static inline void bw_oversample_up_stage(
+		const bw_oversample_coeffs * BW_RESTRICT coeffs,
+		bw_oversample_state * BW_RESTRICT        state,
+		size_t                                   stage,
+		float                                    x,
+		float * BW_RESTRICT                      y) {
+	const size_t len = coeffs->len[stage];
+	float * BW_RESTRICT buf = state->up_buf[stage];
+	const size_t idx = state->up_idx[stage] + 1 == len ? 0 : state->up_idx[stage] + 1;
+	buf[idx] = x;
+	buf[idx + len] = x;
+	state->up_idx[stage] = idx;
+
+	// w[0] is the oldest sample and w[len - 1] the newest
+	const float * BW_RESTRICT w = buf + idx + 1;
+	const float * BW_RESTRICT e0 = coeffs->e0[stage];
+	const float * BW_RESTRICT e1 = coeffs->e1[stage];
+	const float * BW_RESTRICT w0 = w + coeffs->o0[stage];
+	const float * BW_RESTRICT w1 = w + coeffs->o1[stage];
+	float y0 = 0.f;
+	for (size_t i = 0; i < coeffs->n0[stage]; i++)
+		y0 += e0[i] * w0[i];
+	float y1 = 0.f;
+	for (size_t i = 0; i < coeffs->n1[stage]; i++)
+		y1 += e1[i] * w1[i];
+	y[0] = y0 + y0;
+	y[1] = y1 + y1;
+}
+
+static inline float bw_oversample_down_stage(
+		const bw_oversample_coeffs * BW_RESTRICT coeffs,
+		bw_oversample_state * BW_RESTRICT        state,
+		size_t                                   stage,
+		const float * BW_RESTRICT                x) {
+	const size_t len = coeffs->len[stage];
+	float * BW_RESTRICT buf_e = state->down_e_buf[stage];
+	float * BW_RESTRICT buf_o = state->down_o_buf[stage];
+	const size_t idx = state->down_idx[stage] + 1 == len ? 0 : state->down_idx[stage] + 1;
+	buf_e[idx] = x[0];
+	buf_e[idx + len] = x[0];
+	buf_o[idx] = x[1];
+	buf_o[idx + len] = x[1];
+	state->down_idx[stage] = idx;
+
+	// odd-phase taps start from x[-1], that is one sample before the newest
+	// one in the odd history
+	const float * BW_RESTRICT e0 = coeffs->e0[stage];
+	const float * BW_RESTRICT e1 = coeffs->e1[stage];
+	const float * BW_RESTRICT w0 = buf_e + idx + 1 + coeffs->o0[stage];
+	const float * BW_RESTRICT w1 = buf_o + idx + coeffs->o1[stage];
+	float y = 0.f;
+	for (size_t i = 0; i < coeffs->n0[stage]; i++)
+		y += e0[i] * w0[i];
+	for (size_t i = 0; i < coeffs->n1[stage]; i++)
+		y += e1[i] * w1[i];
+	return y;
+}
+
+static inline void bw_oversample_up1(
+		const bw_oversample_coeffs * BW_RESTRICT coeffs,
+		bw_oversample_state * BW_RESTRICT        state,
+		float                                    x,
+		float * BW_RESTRICT                      y) {
+	BW_ASSERT(coeffs != BW_NULL);
+	BW_ASSERT_DEEP(bw_oversample_coeffs_is_valid(coeffs));
+	BW_ASSERT(state != BW_NULL);
+	BW_ASSERT_DEEP(bw_oversample_state_is_valid(coeffs, state));
+	BW_ASSERT(bw_is_finite(x));
+	BW_ASSERT(y != BW_NULL);
+
+	if (coeffs->n_stages == 1)
+		bw_oversample_up_stage(coeffs, state, 0, x, y);
+	else {
+		float t[4];
+		bw_oversample_up_stage(coeffs, state, 0, x, t);
+		if (coeffs->n_stages == 2) {
+			bw_oversample_up_stage(coeffs, state, 1, t[0], y);
+			bw_oversample_up_stage(coeffs, state, 1, t[1], y + 2);
+		} else {
+			const float t1 = t[1];
+			bw_oversample_up_stage(coeffs, state, 1, t[0], t);
+			bw_oversample_up_stage(coeffs, state, 1, t1, t + 2);
+			for (size_t i = 0; i < 4; i++)
+				bw_oversample_up_stage(coeffs, state, 2, t[i], y + 2 * i);
+		}
+	}
+
+	BW_ASSERT_DEEP(bw_oversample_coeffs_is_valid(coeffs));
+	BW_ASSERT_DEEP(bw_oversample_state_is_valid(coeffs, state));
+	BW_ASSERT_DEEP(bw_has_only_finite(y, coeffs->factor));
+}
+
+static inline float bw_oversample_down1(
+		const bw_oversample_coeffs * BW_RESTRICT coeffs,
+		bw_oversample_state * BW_RESTRICT        state,
+		const float * BW_RESTRICT                x) {
+	BW_ASSERT(coeffs != BW_NULL);
+	BW_ASSERT_DEEP(bw_oversample_coeffs_is_valid(coeffs));
+	BW_ASSERT(state != BW_NULL);
+	BW_ASSERT_DEEP(bw_oversample_state_is_valid(coeffs, state));
+	BW_ASSERT(x != BW_NULL);
+	BW_ASSERT_DEEP(bw_has_only_finite(x, coeffs->factor));
+
+	float y;
+	if (coeffs->n_stages == 1)
+		y = bw_oversample_down_stage(coeffs, state, 0, x);
+	else {
+		float t[4];
+		if (coeffs->n_stages == 2) {
+			t[0] = bw_oversample_down_stage(coeffs, state, 1, x);
+			t[1] = bw_oversample_down_stage(coeffs, state, 1, x + 2);
+		} else {
+			for (size_t i = 0; i < 4; i++)
+				t[i] = bw_oversample_down_stage(coeffs, state, 2, x + 2 * i);
+			t[0] = bw_oversample_down_stage(coeffs, state, 1, t);
+			t[1] = bw_oversample_down_stage(coeffs, state, 1, t + 2);
+		}
+		y = bw_oversample_down_stage(coeffs, state, 0, t);
+	}
+
+	BW_ASSERT_DEEP(bw_oversample_coeffs_is_valid(coeffs));
+	BW_ASSERT_DEEP(bw_oversample_state_is_valid(coeffs, state));
+	BW_ASSERT(bw_is_finite(y));
+
+	return y;
+}
+
+static inline void bw_oversample_up(
+		const bw_oversample_coeffs * BW_RESTRICT coeffs,
+		bw_oversample_state * BW_RESTRICT        state,
+		const float * BW_RESTRICT                x,
+		float * BW_RESTRICT                      y,
+		size_t                                   n_samples) {
+	BW_ASSERT(coeffs != BW_NULL);
+	BW_ASSERT_DEEP(bw_oversample_coeffs_is_valid(coeffs));
+	BW_ASSERT(state != BW_NULL);
+	BW_ASSERT_DEEP(bw_oversample_state_is_valid(coeffs, state));
+	BW_ASSERT(x != BW_NULL);
+	BW_ASSERT_DEEP(bw_has_only_finite(x, n_samples));
+	BW_ASSERT(y != BW_NULL);
+	BW_ASSERT(x != y);
+
+	for (size_t i = 0; i < n_samples; i++)
+		bw_oversample_up1(coeffs, state, x[i], y + coeffs->factor * i);
+
+	BW_ASSERT_DEEP(bw_oversample_coeffs_is_valid(coeffs));
+	BW_ASSERT_DEEP(bw_oversample_state_is_valid(coeffs, state));
+	BW_ASSERT_DEEP(bw_has_only_finite(y, coeffs->factor * n_samples));
+}
+
+static inline void bw_oversample_up_multi(
+		const bw_oversample_coeffs * BW_RESTRICT              coeffs,
+		bw_oversample_state * BW_RESTRICT const * BW_RESTRICT state,
+		const float * BW_RESTRICT const * BW_RESTRICT         x,
+		float * BW_RESTRICT const * BW_RESTRICT               y,
+		size_t                                                n_channels,
+		size_t                                                n_samples) {
+	BW_ASSERT(coeffs != BW_NULL);
+	BW_ASSERT_DEEP(bw_oversample_coeffs_is_valid(coeffs));
+	BW_ASSERT(state != BW_NULL);
+#ifndef BW_NO_DEBUG
+	for (size_t i = 0; i < n_channels; i++)
+		for (size_t j = i + 1; j < n_channels; j++)
+			BW_ASSERT(state[i] != state[j]);
+#endif
+	BW_ASSERT(x != BW_NULL);
+	BW_ASSERT(y != BW_NULL);
+	BW_ASSERT((void *)x != (void *)y);
+#ifndef BW_NO_DEBUG
+	for (size_t i = 0; i < n_channels; i++)
+		for (size_t j = i + 1; j < n_channels; j++)
+			BW_ASSERT(y[i] != y[j]);
+	for (size_t i = 0; i < n_channels; i++)
+		for (size_t j = 0; j < n_channels; j++)
+			BW_ASSERT((void *)x[i] != (void *)y[j]);
+#endif
+
+	for (size_t i = 0; i < n_channels; i++)
+		bw_oversample_up(coeffs, state[i], x[i], y[i], n_samples);
+
+	BW_ASSERT_DEEP(bw_oversample_coeffs_is_valid(coeffs));
+}
+
+static inline void bw_oversample_down(
+		const bw_oversample_coeffs * BW_RESTRICT coeffs,
+		bw_oversample_state * BW_RESTRICT        state,
+		const float * BW_RESTRICT                x,
+		float * BW_RESTRICT                      y,
+		size_t                                   n_samples) {
+	BW_ASSERT(coeffs != BW_NULL);
+	BW_ASSERT_DEEP(bw_oversample_coeffs_is_valid(coeffs));
+	BW_ASSERT(state != BW_NULL);
+	BW_ASSERT_DEEP(bw_oversample_state_is_valid(coeffs, state));
+	BW_ASSERT(x != BW_NULL);
+	BW_ASSERT_DEEP(bw_has_only_finite(x, coeffs->factor * n_samples));
+	BW_ASSERT(y != BW_NULL);
+	BW_ASSERT(x != y);
+
+	for (size_t i = 0; i < n_samples; i++)
+		y[i] = bw_oversample_down1(coeffs, state, x + coeffs->factor * i);
+
+	BW_ASSERT_DEEP(bw_oversample_coeffs_is_valid(coeffs));
+	BW_ASSERT_DEEP(bw_oversample_state_is_valid(coeffs, state));
+	BW_ASSERT_DEEP(bw_has_only_finite(y, n_samples));
+}
+
+static inline void bw_oversample_down_multi(
+		const bw_oversample_coeffs * BW_RESTRICT              coeffs,
+		bw_oversample_state * BW_RESTRICT const * BW_RESTRICT state,
+		const float * BW_RESTRICT const * BW_RESTRICT         x,
+		float * BW_RESTRICT const * BW_RESTRICT               y,
+		size_t                                                n_channels,
+		size_t                                                n_samples) {
+	BW_ASSERT(coeffs != BW_NULL);
+	BW_ASSERT_DEEP(bw_oversample_coeffs_is_valid(coeffs));
+	BW_ASSERT(state != BW_NULL);
+#ifndef BW_NO_DEBUG
+	for (size_t i = 0; i < n_channels; i++)
+		for (size_t j = i + 1; j < n_channels; j++)
+			BW_ASSERT(state[i] != state[j]);
+#endif
+	BW_ASSERT(x != BW_NULL);
+	BW_ASSERT(y != BW_NULL);
+	BW_ASSERT((void *)x != (void *)y);
+#ifndef BW_NO_DEBUG
+	for (size_t i = 0; i < n_channels; i++)
+		for (size_t j = i + 1; j < n_channels; j++)
+			BW_ASSERT(y[i] != y[j]);
+	for (size_t i = 0; i < n_channels; i++)
+		for (size_t j = 0; j < n_channels; j++)
+			BW_ASSERT((void *)x[i] != (void *)y[j]);
+#endif
+
+	for (size_t i = 0; i < n_channels; i++)
+		bw_oversample_down(coeffs, state[i], x[i], y[i], n_samples);
+
+	BW_ASSERT_DEEP(bw_oversample_coeffs_is_valid(coeffs));
+}
+
+static inline void bw_oversample_process(
+		const bw_oversample_coeffs * BW_RESTRICT coeffs,
+		bw_oversample_state * BW_RESTRICT        state,
+		const float *                            x,
+		float *                                  y,
+		size_t                                   n_samples,
+		float * BW_RESTRICT                      buf,
+		size_t                                   buf_len,
+		bw_oversample_callback                   callback,
+		void *                                   data) {
+	BW_ASSERT(coeffs != BW_NULL);
+	BW_ASSERT_DEEP(bw_oversample_coeffs_is_valid(coeffs));
+	BW_ASSERT(state != BW_NULL);
+	BW_ASSERT_DEEP(bw_oversample_state_is_valid(coeffs, state));
+	BW_ASSERT(x != BW_NULL);
+	BW_ASSERT_DEEP(bw_has_only_finite(x, n_samples));
+	BW_ASSERT(y != BW_NULL);
+	BW_ASSERT(buf != BW_NULL);
+	BW_ASSERT(buf != x && buf != y);
+	BW_ASSERT(buf_len >= coeffs->factor);
+	BW_ASSERT(callback != BW_NULL);
+
+	const size_t n_chunk = buf_len / coeffs->factor;
+	for (size_t i = 0; i < n_samples; ) {
+		const size_t n = n_samples - i < n_chunk ? n_samples - i : n_chunk;
+		bw_oversample_up(coeffs, state, x + i, buf, n);
+		callback(data, buf, buf, coeffs->factor * n);
+		bw_oversample_down(coeffs, state, buf, y + i, n);
+		i += n;
+	}
+
+	BW_ASSERT_DEEP(bw_oversample_coeffs_is_valid(coeffs));
+	BW_ASSERT_DEEP(bw_oversample_state_is_valid(coeffs, state));
+	BW_ASSERT_DEEP(bw_has_only_finite(y, n_samples));
+}
+
+static inline void bw_oversample_process_multi(
+		const bw_oversample_coeffs * BW_RESTRICT              coeffs,
+		bw_oversample_state * BW_RESTRICT const * BW_RESTRICT state,
+		const float * const *                                 x,
+		float * const *                                       y,
+		size_t                                                n_channels,
+		size_t                                                n_samples,
+		float * const *                                       buf,
+		size_t                                                buf_len,
+		bw_oversample_callback_multi                          callback,
+		void *                                                data) {
+	BW_ASSERT(coeffs != BW_NULL);
+	BW_ASSERT_DEEP(bw_oversample_coeffs_is_valid(coeffs));
+	BW_ASSERT(state != BW_NULL);
+#ifndef BW_NO_DEBUG
+	for (size_t i = 0; i < n_channels; i++)
+		for (size_t j = i + 1; j < n_channels; j++)
+			BW_ASSERT(state[i] != state[j]);
+#endif
+	BW_ASSERT(x != BW_NULL);
+	BW_ASSERT(y != BW_NULL);
+	BW_ASSERT(buf != BW_NULL);
+#ifndef BW_NO_DEBUG
+	for (size_t i = 0; i < n_channels; i++)
+		for (size_t j = i + 1; j < n_channels; j++) {
+			BW_ASSERT(y[i] != y[j]);
+			BW_ASSERT(buf[i] != buf[j]);
+		}
+	for (size_t i = 0; i < n_channels; i++)
+		for (size_t j = 0; j < n_channels; j++) {
+			BW_ASSERT(i == j || x[i] != y[j]);
+			BW_ASSERT(buf[i] != x[j] && buf[i] != y[j]);
+		}
+#endif
+	BW_ASSERT(buf_len >= coeffs->factor);
+	BW_ASSERT(callback != BW_NULL);
+
+	const size_t n_chunk = buf_len / coeffs->factor;
+	for (size_t i = 0; i < n_samples; ) {
+		const size_t n = n_samples - i < n_chunk ? n_samples - i : n_chunk;
+		for (size_t j = 0; j < n_channels; j++)
+			bw_oversample_up(coeffs, state[j], x[j] + i, buf[j], n);
+		callback(data, (const float * const *)buf, buf, n_channels, coeffs->factor * n);
+		for (size_t j = 0; j < n_channels; j++)
+			bw_oversample_down(coeffs, state[j], buf[j], y[j] + i, n);
+		i += n;
+	}
+
+	BW_ASSERT_DEEP(bw_oversample_coeffs_is_valid(coeffs));
+}
+
+static inline size_t bw_oversample_get_factor(
+		const bw_oversample_coeffs * BW_RESTRICT coeffs) {
+	BW_ASSERT(coeffs != BW_NULL);
+	BW_ASSERT_DEEP(bw_oversample_coeffs_is_valid(coeffs));
+
+	return coeffs->factor;
+}
+
+static inline float bw_oversample_get_latency(
+		const bw_oversample_coeffs * BW_RESTRICT coeffs) {
+	BW_ASSERT(coeffs != BW_NULL);
+	BW_ASSERT_DEEP(bw_oversample_coeffs_is_valid(coeffs));
+
+	return coeffs->latency;
+}
+
+static inline char bw_oversample_coeffs_is_valid(
+		const bw_oversample_coeffs * BW_RESTRICT coeffs) {
+	BW_ASSERT(coeffs != BW_NULL);
+
+#ifdef BW_DEBUG_DEEP
+	if (coeffs->hash != bw_hash_sdbm("bw_oversample_coeffs"))
+		return 0;
+#endif
+
+	if (coeffs->factor != 2 && coeffs->factor != 4 && coeffs->factor != 8)
+		return 0;
+	if (coeffs->n_stages != (coeffs->factor == 2 ? 1u : (coeffs->factor == 4 ? 2u : 3u)))
+		return 0;
+	for (size_t i = 0; i < coeffs->n_stages; i++) {
+		if (coeffs->e0[i] == BW_NULL || coeffs->e1[i] == BW_NULL)
+			return 0;
+		if (coeffs->len[i] > BW_OVERSAMPLE_LEN_MAX)
+			return 0;
+		if (coeffs->o0[i] + coeffs->n0[i] > coeffs->len[i] || coeffs->o1[i] + coeffs->n1[i] > coeffs->len[i] || coeffs->o1[i] == 0)
+			return 0;
+	}
+
+	return bw_is_finite(coeffs->latency) && coeffs->latency > 0.f;
+}
+
+static inline char bw_oversample_state_is_valid(
+		const bw_oversample_coeffs * BW_RESTRICT coeffs,
+		const bw_oversample_state * BW_RESTRICT  state) {
+	BW_ASSERT(state != BW_NULL);
+
+#ifdef BW_DEBUG_DEEP
+	if (state->hash != bw_hash_sdbm("bw_oversample_state"))
+		return 0;
+
+	if (coeffs != BW_NULL && coeffs->reset_id != state->coeffs_reset_id)
+		return 0;
+#endif
+
+	if (coeffs != BW_NULL)
+		for (size_t i = 0; i < coeffs->n_stages; i++)
+			if (state->up_idx[i] >= coeffs->len[i] || state->down_idx[i] >= coeffs->len[i])
+				return 0;
+
+	return 1;
+}
+
+#undef BW_OVERSAMPLE_LEN_MAX
+
+#ifdef __cplusplus
+}
+
+#ifndef BW_CXX_NO_ARRAY
+# include <array>
+#endif
+
+namespace Brickworks {
+
+/*** Public C++ API ***/
+
+/*! api_cpp {{{
+ *    ##### Brickworks::Oversample
+ *  ```>>> */
+template<size_t N_CHANNELS>
+class Oversample {
+public:
+	Oversample(
+		size_t factor,
+		bool   minPhase = false);
+
+	void reset(
+		float               x0 = 0.f,
+		float * BW_RESTRICT y0 = nullptr);
+
+#ifndef BW_CXX_NO_ARRAY
+	void reset(
+		float                                       x0,
+		std::array<float, N_CHANNELS> * BW_RESTRICT y0);
+#endif
+
+	void reset(
+		const float * x0,
+		float *       y0 = nullptr);
+
+#ifndef BW_CXX_NO_ARRAY
+	void reset(
+		std::array<float, N_CHANNELS>               x0,
+		std::array<float, N_CHANNELS> * BW_RESTRICT y0 = nullptr);
+#endif
+
+	void up(
+		const float * BW_RESTRICT const * BW_RESTRICT x,
+		float * BW_RESTRICT const * BW_RESTRICT       y,
+		size_t                                        nSamples);
+
+	void down(
+		const float * BW_RESTRICT const * BW_RESTRICT x,
+		float * BW_RESTRICT const * BW_RESTRICT       y,
+		size_t                                        nSamples);
+
+	template<typename F>
+	void process(
+		const float * const *                   x,
+		float * const *                         y,
+		size_t                                  nSamples,
+		float * const *                         buf,
+		size_t                                  bufLen,
+		F &&                                    callback);
+
+	size_t getFactor();
+
+	float getLatency();
+/*! <<<...
+ *  }
+ *  ```
+ *
+ *    `callback` is invoked as `callback(x, y, nSamples)`, where `x` and `y`
+ *    are both `buf` and `nSamples` is the number of samples at the
+ *    oversampled rate in the current chunk.
+ *  }}} */
+
+/*** Implementation ***/
+
+/* WARNING: This part of the file is not part of the public API. Its content may
+ * change at any time in future versions. Please, do not use it directly. */
+
+private:
+	bw_oversample_coeffs			coeffs;
+	bw_oversample_state			states[N_CHANNELS];
+	bw_oversample_state * BW_RESTRICT	statesP[N_CHANNELS];
+};
+
+template<size_t N_CHANNELS>
+inline Oversample<N_CHANNELS>::Oversample(
+		size_t factor,
+		bool   minPhase) {
+	bw_oversample_init(&coeffs, factor, minPhase);
+	for (size_t i = 0; i < N_CHANNELS; i++)
+		statesP[i] = states + i;
+}
+
+template<size_t N_CHANNELS>
+inline void Oversample<N_CHANNELS>::reset(
+		float               x0,
+		float * BW_RESTRICT y0) {
+	if (y0 != nullptr)
+		for (size_t i = 0; i < N_CHANNELS; i++)
+			y0[i] = bw_oversample_reset_state(&coeffs, states + i, x0);
+	else
+		for (size_t i = 0; i < N_CHANNELS; i++)
+			bw_oversample_reset_state(&coeffs, states + i, x0);
+}
+
+#ifndef BW_CXX_NO_ARRAY
+template<size_t N_CHANNELS>
+inline void Oversample<N_CHANNELS>::reset(
+		float                                       x0,
+		std::array<float, N_CHANNELS> * BW_RESTRICT y0) {
+	reset(x0, y0 != nullptr ? y0->data() : nullptr);
+}
+#endif
+
+template<size_t N_CHANNELS>
+inline void Oversample<N_CHANNELS>::reset(
+		const float * x0,
+		float *       y0) {
+	bw_oversample_reset_state_multi(&coeffs, statesP, x0, y0, N_CHANNELS);
+}
+
+#ifndef BW_CXX_NO_ARRAY
+template<size_t N_CHANNELS>
+inline void Oversample<N_CHANNELS>::reset(
+		std::array<float, N_CHANNELS>               x0,
+		std::array<float, N_CHANNELS> * BW_RESTRICT y0) {
+	reset(x0.data(), y0 != nullptr ? y0->data() : nullptr);
+}
+#endif
+
+template<size_t N_CHANNELS>
+inline void Oversample<N_CHANNELS>::up(
+		const float * BW_RESTRICT const * BW_RESTRICT x,
+		float * BW_RESTRICT const * BW_RESTRICT       y,
+		size_t                                        nSamples) {
+	bw_oversample_up_multi(&coeffs, statesP, x, y, N_CHANNELS, nSamples);
+}
+
+template<size_t N_CHANNELS>
+inline void Oversample<N_CHANNELS>::down(
+		const float * BW_RESTRICT const * BW_RESTRICT x,
+		float * BW_RESTRICT const * BW_RESTRICT       y,
+		size_t                                        nSamples) {
+	bw_oversample_down_multi(&coeffs, statesP, x, y, N_CHANNELS, nSamples);
+}
+
+template<size_t N_CHANNELS>
+template<typename F>
+inline void Oversample<N_CHANNELS>::process(
+		const float * const *                   x,
+		float * const *                         y,
+		size_t                                  nSamples,
+		float * const *                         buf,
+		size_t                                  bufLen,
+		F &&                                    callback) {
+	const size_t nChunk = bufLen / coeffs.factor;
+	for (size_t i = 0; i < nSamples; ) {
+		const size_t n = nSamples - i < nChunk ? nSamples - i : nChunk;
+		for (size_t j = 0; j < N_CHANNELS; j++)
+			bw_oversample_up(&coeffs, states + j, x[j] + i, buf[j], n);
+		callback(const_cast<const float * const *>(buf), buf, coeffs.factor * n);
+		for (size_t j = 0; j < N_CHANNELS; j++)
+			bw_oversample_down(&coeffs, states + j, buf[j], y[j] + i, n);
+		i += n;
+	}
+}
+
+template<size_t N_CHANNELS>
+inline size_t Oversample<N_CHANNELS>::getFactor() {
+	return bw_oversample_get_factor(&coeffs);
+}
+
+template<size_t N_CHANNELS>
+inline float Oversample<N_CHANNELS>::getLatency() {
+	return bw_oversample_get_latency(&coeffs);
+}
+
+}
+#endif
+
+#endif
@@ -20,7 +20,7 @@
 
 /*!
  *  module_type {{{ dsp }}}
- *  version {{{ 1.1.1 }}}
+ *  version {{{ 1.2.0 }}}
  *  requires {{{
  *    bw_buf bw_common bw_delay bw_dry_wet bw_gain bw_lp1 bw_math bw_one_pole
  *    bw_osc_sin bw_phase_gen
@@ -35,6 +35,20 @@
  *  }}}
  *  changelog {{{
  *    <ul>
+ *      <li>Version <strong>1.2.0</strong>:
+ *        <ul>
+ *          <li>Added <code>bw_reverb_set_single_ring()</code> and
+ *              corresponding C++ API.</li>
+ *          <li>Added <code>bw_reverb_is_silent()</code> and corresponding
+ *              C++ API.</li>
+ *          <li><code>bw_reverb_process()</code> and
+ *              <code>bw_reverb_process_multi()</code> now stop processing
+ *              once the input is silent and the tail has decayed below
+ *              -120 dB.</li>
+ *          <li>Fixed write to wrong delay line in
+ *              <code>bw_reverb_process1()</code>.</li>
+ *        </ul>
+ *      </li>
  *      <li>Version <strong>1.1.1</strong>:
  *        <ul>
  *          <li>Added debugging check in <code>bw_reverb_process_multi()</code>
@@ -309,6 +323,45 @@ static inline void bw_reverb_set_wet(
  *
  *    Default value: `0.5f`.
  *
+ *    #### bw_reverb_set_single_ring()
+ *  ```>>> */
+static inline void bw_reverb_set_single_ring(
+	bw_reverb_coeffs * BW_RESTRICT coeffs,
+	char                           value);
+/*! <<<```
+ *    Sets whether all delay lines should be stored in a single ring buffer
+ *    (non-`0`) or each in its own buffer (`0`).
+ *
+ *    In the former case all delay lines share a single write index and are
+ *    placed at fixed offsets in a 64-byte aligned buffer whose length is a
+ *    power of two, so that wrapping around is done via bit masking. This
+ *    reduces index computations per sample at the cost of a higher memory
+ *    requirement.
+ *
+ *    This affects the output of `bw_reverb_mem_req()` and the behavior of
+ *    `bw_reverb_mem_set()`, therefore it must be set before calling those.
+ *
+ *    Default value: `0` (separate buffers).
+ *
+ *    #### bw_reverb_is_silent()
+ *  ```>>> */
+static inline char bw_reverb_is_silent(
+	const bw_reverb_coeffs * BW_RESTRICT coeffs,
+	const bw_reverb_state * BW_RESTRICT  state);
+/*! <<<```
+ *    Returns non-`0` if `state` is currently silent, `0` otherwise.
+ *
+ *    `bw_reverb_process()` and `bw_reverb_process_multi()` keep track of how
+ *    long both inputs have been exactly `0.f`. Each time that exceeds the
+ *    maximum predelay, they check whether the whole tail has decayed below
+ *    -120 dB. If so, they clear all internal delay lines and consider `state`
+ *    silent, in which case they just zero-fill the outputs until non-`0.f`
+ *    input comes in. Processing then resumes exactly as from a state reset
+ *    with `0.f` initial inputs.
+ *
+ *    `bw_reverb_process1()` and `bw_reverb_reset_state()` make `state`
+ *    non-silent.
+ *
  *    #### bw_reverb_coeffs_is_valid()
  *  ```>>> */
 static inline char bw_reverb_coeffs_is_valid(
@@ -438,8 +491,26 @@ struct bw_reverb_coeffs {
 	float				s;
 	float				diff2;
 
+	size_t				ring_mask;
+	size_t				ring_pd;	// offsets of the most recently written
+	size_t				ring_id1;	// samples when write index is 0
+	size_t				ring_id2;
+	size_t				ring_id3;
+	size_t				ring_id4;
+	size_t				ring_dd1;
+	size_t				ring_dd2;
+	size_t				ring_dd3;
+	size_t				ring_dd4;
+	size_t				ring_d1;
+	size_t				ring_d2;
+	size_t				ring_d3;
+	size_t				ring_d4;
+	size_t				pdi;
+	float				pdf;
+
 	// Parameters
 	float				predelay;
+	char				single_ring;
 };
 
 struct bw_reverb_state {
@@ -466,6 +537,14 @@ struct bw_reverb_state {
 	bw_delay_state			delay_d4_state;
 	bw_lp1_state			damping_1_state;
 	bw_lp1_state			damping_2_state;
+
+	// Single ring buffer
+	float * BW_RESTRICT		ring_buf;
+	size_t				ring_idx;
+
+	// Silence detection
+	size_t				n_silent;
+	char				silent;
 };
 
 static inline void bw_reverb_init(
@@ -500,6 +579,7 @@ static inline void bw_reverb_init(
 	bw_one_pole_set_sticky_thresh(&coeffs->smooth_coeffs, 1e-6f);
 
 	coeffs->predelay = 0.f;
+	coeffs->single_ring = 0;
 
 #ifdef BW_DEBUG_DEEP
 	coeffs->hash = bw_hash_sdbm("bw_reverb_coeffs");
@@ -565,6 +645,40 @@ static inline void bw_reverb_set_sample_rate(
 	coeffs->dr6 = (size_t)bw_roundf(coeffs->fs * (335.f / 29761.f));
 	coeffs->dr7 = (size_t)bw_roundf(coeffs->fs * (121.f / 29761.f));
 
+	// 2 more samples per line so that reads (before writes, interpolated) in
+	// the same sample never reach into the previous line
+	size_t n = 0;
+	n += bw_delay_get_length(&coeffs->predelay_coeffs) + 2;
+	coeffs->ring_pd = n - 1;
+	n += bw_delay_get_length(&coeffs->delay_id1_coeffs) + 2;
+	coeffs->ring_id1 = n - 1;
+	n += bw_delay_get_length(&coeffs->delay_id2_coeffs) + 2;
+	coeffs->ring_id2 = n - 1;
+	n += bw_delay_get_length(&coeffs->delay_id3_coeffs) + 2;
+	coeffs->ring_id3 = n - 1;
+	n += bw_delay_get_length(&coeffs->delay_id4_coeffs) + 2;
+	coeffs->ring_id4 = n - 1;
+	n += bw_delay_get_length(&coeffs->delay_dd1_coeffs) + 2;
+	coeffs->ring_dd1 = n - 1;
+	n += bw_delay_get_length(&coeffs->delay_dd2_coeffs) + 2;
+	coeffs->ring_dd2 = n - 1;
+	n += bw_delay_get_length(&coeffs->delay_dd3_coeffs) + 2;
+	coeffs->ring_dd3 = n - 1;
+	n += bw_delay_get_length(&coeffs->delay_dd4_coeffs) + 2;
+	coeffs->ring_dd4 = n - 1;
+	n += bw_delay_get_length(&coeffs->delay_d1_coeffs) + 2;
+	coeffs->ring_d1 = n - 1;
+	n += bw_delay_get_length(&coeffs->delay_d2_coeffs) + 2;
+	coeffs->ring_d2 = n - 1;
+	n += bw_delay_get_length(&coeffs->delay_d3_coeffs) + 2;
+	coeffs->ring_d3 = n - 1;
+	n += bw_delay_get_length(&coeffs->delay_d4_coeffs) + 2;
+	coeffs->ring_d4 = n - 1;
+	size_t len = 1;
+	while (len < n)
+		len <<= 1;
+	coeffs->ring_mask = len - 1;
+
 #ifdef BW_DEBUG_DEEP
 	coeffs->state = bw_reverb_coeffs_state_set_sample_rate;
 #endif
@@ -578,6 +692,8 @@ static inline size_t bw_reverb_mem_req(
 	BW_ASSERT_DEEP(bw_reverb_coeffs_is_valid(coeffs));
 	BW_ASSERT_DEEP(coeffs->state >= bw_reverb_coeffs_state_set_sample_rate);
 
+	if (coeffs->single_ring)
+		return 63 + (coeffs->ring_mask + 1) * sizeof(float); // 63 extra bytes for alignment
 	return bw_delay_mem_req(&coeffs->predelay_coeffs)
 		+ bw_delay_mem_req(&coeffs->delay_id1_coeffs)
 		+ bw_delay_mem_req(&coeffs->delay_id2_coeffs)
@@ -603,6 +719,20 @@ static inline void bw_reverb_mem_set(
 	BW_ASSERT(state != BW_NULL);
 	BW_ASSERT(mem != BW_NULL);
 
+	if (coeffs->single_ring) {
+		state->ring_buf = (float *)((char *)mem + ((64 - (uintptr_t)mem % 64) % 64));
+#ifdef BW_DEBUG_DEEP
+		state->hash = bw_hash_sdbm("bw_reverb_state");
+		state->state = bw_reverb_state_state_mem_set;
+#endif
+		BW_ASSERT_DEEP(bw_reverb_coeffs_is_valid(coeffs));
+		BW_ASSERT_DEEP(coeffs->state >= bw_reverb_coeffs_state_set_sample_rate);
+		BW_ASSERT_DEEP(bw_reverb_state_is_valid(coeffs, state));
+		BW_ASSERT_DEEP(state->state == bw_reverb_state_state_mem_set);
+		return;
+	}
+
+	state->ring_buf = BW_NULL;
 	char *m = (char *)mem;
 	bw_delay_mem_set(&coeffs->predelay_coeffs, &state->predelay_state, m);
 	m += bw_delay_mem_req(&coeffs->predelay_coeffs);
@@ -670,6 +800,9 @@ static inline void bw_reverb_reset_coeffs(
 	bw_dry_wet_reset_coeffs(&coeffs->dry_wet_coeffs);
 	coeffs->predelay = coeffs->T * bw_roundf(coeffs->fs * coeffs->predelay); // rounded
 	bw_one_pole_reset_state(&coeffs->smooth_coeffs, &coeffs->smooth_predelay_state, coeffs->predelay);
+	float pdi;
+	bw_intfracf(coeffs->fs * coeffs->predelay, &pdi, &coeffs->pdf);
+	coeffs->pdi = (size_t)pdi;
 
 #ifdef BW_DEBUG_DEEP
 	coeffs->state = bw_reverb_coeffs_state_reset_coeffs;
@@ -699,17 +832,11 @@ static inline void bw_reverb_reset_state(
 	BW_ASSERT(y_l_0 != y_r_0);
 
 	const float i = 0.5f * (x_l_0 + x_r_0);
-	const float pd = bw_delay_reset_state(&coeffs->predelay_coeffs, &state->predelay_state, i);
-	const float bw = bw_lp1_reset_state(&coeffs->bandwidth_coeffs, &state->bandwidth_state, pd);
+	const float bw = bw_lp1_reset_state(&coeffs->bandwidth_coeffs, &state->bandwidth_state, i);
 
 	const float v1 = (1.f / (1.f + 0.75f)) * bw;
 	const float v2 = (1.f / (1.f + 0.625f)) * bw;
 
-	bw_delay_reset_state(&coeffs->delay_id1_coeffs, &state->delay_id1_state, v1);
-	bw_delay_reset_state(&coeffs->delay_id2_coeffs, &state->delay_id2_state, v1);
-	bw_delay_reset_state(&coeffs->delay_id3_coeffs, &state->delay_id3_state, v2);
-	bw_delay_reset_state(&coeffs->delay_id4_coeffs, &state->delay_id4_state, v2);
-
 	const float decay = bw_gain_get_gain_cur(&coeffs->decay_coeffs);
 	const float v3 = bw / (1.f - decay * decay);
 	const float v4 = decay * bw;
@@ -719,21 +846,49 @@ static inline void bw_reverb_reset_state(
 	bw_lp1_reset_state(&coeffs->damping_coeffs, &state->damping_1_state, v3);
 	bw_lp1_reset_state(&coeffs->damping_coeffs, &state->damping_2_state, v3);
 
-	bw_delay_reset_state(&coeffs->delay_d1_coeffs, &state->delay_d1_state, v3);
-	bw_delay_reset_state(&coeffs->delay_d2_coeffs, &state->delay_d2_state, v4);
-	bw_delay_reset_state(&coeffs->delay_d3_coeffs, &state->delay_d3_state, v3);
-	bw_delay_reset_state(&coeffs->delay_d4_coeffs, &state->delay_d4_state, v4);
-
-	bw_delay_reset_state(&coeffs->delay_dd1_coeffs, &state->delay_dd1_state, v5);
-	bw_delay_reset_state(&coeffs->delay_dd2_coeffs, &state->delay_dd2_state, v6);
-	bw_delay_reset_state(&coeffs->delay_dd3_coeffs, &state->delay_dd3_state, v5);
-	bw_delay_reset_state(&coeffs->delay_dd4_coeffs, &state->delay_dd4_state, v6);
+	if (coeffs->single_ring) {
+		float *b = state->ring_buf;
+		bw_buf_fill(i, b, coeffs->ring_pd + 1);
+		bw_buf_fill(v1, b + coeffs->ring_pd + 1, coeffs->ring_id1 - coeffs->ring_pd);
+		bw_buf_fill(v1, b + coeffs->ring_id1 + 1, coeffs->ring_id2 - coeffs->ring_id1);
+		bw_buf_fill(v2, b + coeffs->ring_id2 + 1, coeffs->ring_id3 - coeffs->ring_id2);
+		bw_buf_fill(v2, b + coeffs->ring_id3 + 1, coeffs->ring_id4 - coeffs->ring_id3);
+		bw_buf_fill(v5, b + coeffs->ring_id4 + 1, coeffs->ring_dd1 - coeffs->ring_id4);
+		bw_buf_fill(v6, b + coeffs->ring_dd1 + 1, coeffs->ring_dd2 - coeffs->ring_dd1);
+		bw_buf_fill(v5, b + coeffs->ring_dd2 + 1, coeffs->ring_dd3 - coeffs->ring_dd2);
+		bw_buf_fill(v6, b + coeffs->ring_dd3 + 1, coeffs->ring_dd4 - coeffs->ring_dd3);
+		bw_buf_fill(v3, b + coeffs->ring_dd4 + 1, coeffs->ring_d1 - coeffs->ring_dd4);
+		bw_buf_fill(v4, b + coeffs->ring_d1 + 1, coeffs->ring_d2 - coeffs->ring_d1);
+		bw_buf_fill(v3, b + coeffs->ring_d2 + 1, coeffs->ring_d3 - coeffs->ring_d2);
+		bw_buf_fill(v4, b + coeffs->ring_d3 + 1, coeffs->ring_d4 - coeffs->ring_d3);
+		state->ring_idx = 0;
+	} else {
+		bw_delay_reset_state(&coeffs->predelay_coeffs, &state->predelay_state, i);
+
+		bw_delay_reset_state(&coeffs->delay_id1_coeffs, &state->delay_id1_state, v1);
+		bw_delay_reset_state(&coeffs->delay_id2_coeffs, &state->delay_id2_state, v1);
+		bw_delay_reset_state(&coeffs->delay_id3_coeffs, &state->delay_id3_state, v2);
+		bw_delay_reset_state(&coeffs->delay_id4_coeffs, &state->delay_id4_state, v2);
+
+		bw_delay_reset_state(&coeffs->delay_d1_coeffs, &state->delay_d1_state, v3);
+		bw_delay_reset_state(&coeffs->delay_d2_coeffs, &state->delay_d2_state, v4);
+		bw_delay_reset_state(&coeffs->delay_d3_coeffs, &state->delay_d3_state, v3);
+		bw_delay_reset_state(&coeffs->delay_d4_coeffs, &state->delay_d4_state, v4);
+
+		bw_delay_reset_state(&coeffs->delay_dd1_coeffs, &state->delay_dd1_state, v5);
+		bw_delay_reset_state(&coeffs->delay_dd2_coeffs, &state->delay_dd2_state, v6);
+		bw_delay_reset_state(&coeffs->delay_dd3_coeffs, &state->delay_dd3_state, v5);
+		bw_delay_reset_state(&coeffs->delay_dd4_coeffs, &state->delay_dd4_state, v6);
+	}
 
 	const float y = 0.6f * (v3 - v6 - v6);
 
 	*y_l_0 = bw_dry_wet_process1(&coeffs->dry_wet_coeffs, x_l_0, y);
 	*y_r_0 = bw_dry_wet_process1(&coeffs->dry_wet_coeffs, x_r_0, y);
 
+	state->n_silent = 0;
+	state->silent = 0;
+
 #ifdef BW_DEBUG_DEEP
 	state->state = bw_reverb_state_state_reset_state;
 	state->coeffs_reset_id = coeffs->reset_id;
@@ -822,6 +977,11 @@ static inline void bw_reverb_update_coeffs_audio(
 	bw_delay_set_delay(&coeffs->predelay_coeffs, pd);
 	bw_delay_update_coeffs_ctrl(&coeffs->predelay_coeffs);
 	bw_delay_update_coeffs_audio(&coeffs->predelay_coeffs);
+	if (coeffs->single_ring) {
+		float pdi;
+		bw_intfracf(coeffs->fs * pd, &pdi, &coeffs->pdf);
+		coeffs->pdi = (size_t)pdi;
+	}
 	bw_gain_update_coeffs_audio(&coeffs->decay_coeffs);
 	bw_phase_gen_update_coeffs_audio(&coeffs->phase_gen_coeffs);
 	float p, pi;
@@ -835,25 +995,13 @@ static inline void bw_reverb_update_coeffs_audio(
 	BW_ASSERT_DEEP(coeffs->state >= bw_reverb_coeffs_state_reset_coeffs);
 }
 
-static inline void bw_reverb_process1(
+static inline void bw_reverb_process1_delay(
 		const bw_reverb_coeffs * BW_RESTRICT coeffs,
 		bw_reverb_state * BW_RESTRICT        state,
 		float                                x_l,
 		float                                x_r,
 		float *                              y_l,
 		float *                              y_r) {
-	BW_ASSERT(coeffs != BW_NULL);
-	BW_ASSERT_DEEP(bw_reverb_coeffs_is_valid(coeffs));
-	BW_ASSERT_DEEP(coeffs->state >= bw_reverb_coeffs_state_reset_coeffs);
-	BW_ASSERT(state != BW_NULL);
-	BW_ASSERT_DEEP(bw_reverb_state_is_valid(coeffs, state));
-	BW_ASSERT_DEEP(state->state >= bw_reverb_state_state_reset_state);
-	BW_ASSERT(bw_is_finite(x_l));
-	BW_ASSERT(bw_is_finite(x_r));
-	BW_ASSERT(y_l != BW_NULL);
-	BW_ASSERT(y_r != BW_NULL);
-	BW_ASSERT(y_l != y_r);
-
 	const float i = 0.5f * (x_l + x_r);
 	const float pd = bw_delay_process1(&coeffs->predelay_coeffs, &state->predelay_state, i);
 	const float bw = bw_lp1_process1(&coeffs->bandwidth_coeffs, &state->bandwidth_state, pd);
@@ -910,7 +1058,7 @@ static inline void bw_reverb_process1(
 	const float n59 = bw_delay_read(&coeffs->delay_dd4_coeffs, &state->delay_dd4_state, coeffs->dd4, 0.f);
 	const float n55 = decay2 - coeffs->diff2 * n59;
 	const float dd4 = n59 + coeffs->diff2 * n55;
-	bw_delay_write(&coeffs->delay_dd2_coeffs, &state->delay_dd2_state, n55);
+	bw_delay_write(&coeffs->delay_dd4_coeffs, &state->delay_dd4_state, n55);
 	bw_delay_write(&coeffs->delay_d2_coeffs, &state->delay_d2_state, dd2);
 	bw_delay_write(&coeffs->delay_d4_coeffs, &state->delay_d4_state, dd4);
 
@@ -934,6 +1082,131 @@ static inline void bw_reverb_process1(
 		);
 	*y_l = bw_dry_wet_process1(&coeffs->dry_wet_coeffs, x_l, *y_l);
 	*y_r = bw_dry_wet_process1(&coeffs->dry_wet_coeffs, x_r, *y_r);
+}
+
+static inline void bw_reverb_process1_ring(
+		const bw_reverb_coeffs * BW_RESTRICT coeffs,
+		bw_reverb_state * BW_RESTRICT        state,
+		float                                x_l,
+		float                                x_r,
+		float *                              y_l,
+		float *                              y_r) {
+	float * BW_RESTRICT b = state->ring_buf;
+	const size_t m = coeffs->ring_mask;
+	// w + ring_* is where the current sample is written on each delay line,
+	// hence a delay d corresponds to w + ring_* - d after writing and to
+	// w + ring_* - 1 - d before writing
+	const size_t w = (state->ring_idx + 1) & m;
+	state->ring_idx = w;
+
+	const float i = 0.5f * (x_l + x_r);
+	b[(w + coeffs->ring_pd) & m] = i;
+	const size_t npd = w + coeffs->ring_pd - coeffs->pdi;
+	const float pd = b[npd & m] + coeffs->pdf * (b[(npd - 1) & m] - b[npd & m]);
+	const float bw = bw_lp1_process1(&coeffs->bandwidth_coeffs, &state->bandwidth_state, pd);
+
+	const float n14 = b[(w + coeffs->ring_id1 - 1 - coeffs->id1) & m];
+	const float n13 = bw - 0.75f * n14;
+	const float id1 = n14 + 0.75f * n13;
+	b[(w + coeffs->ring_id1) & m] = n13;
+	const float n20 = b[(w + coeffs->ring_id2 - 1 - coeffs->id2) & m];
+	const float n19 = id1 - 0.75f * n20;
+	const float id2 = n20 + 0.75f * n19;
+	b[(w + coeffs->ring_id2) & m] = n19;
+	const float n16 = b[(w + coeffs->ring_id3 - 1 - coeffs->id3) & m];
+	const float n15 = id2 - 0.625f * n16;
+	const float id3 = n16 + 0.625f * n15;
+	b[(w + coeffs->ring_id3) & m] = n15;
+	const float n22 = b[(w + coeffs->ring_id4 - 1 - coeffs->id4) & m];
+	const float n21 = id3 - 0.625f * n22;
+	const float id4 = n22 + 0.625f * n21;
+	b[(w + coeffs->ring_id4) & m] = n21;
+
+	const float n39 = b[(w + coeffs->ring_d2 - 1 - coeffs->d2) & m];
+	const float n63 = b[(w + coeffs->ring_d4 - 1 - coeffs->d4) & m];
+	const float s1 = id4 + bw_gain_process1(&coeffs->decay_coeffs, n63);
+	const float s2 = id4 + bw_gain_process1(&coeffs->decay_coeffs, n39);
+
+	float dd1if, dd1f;
+	bw_intfracf(coeffs->fs * ((672.f / 29761.f) + coeffs->s), &dd1if, &dd1f);
+	const size_t ndd1 = w + coeffs->ring_dd1 - 1 - (size_t)dd1if;
+	float dd3if, dd3f;
+	bw_intfracf(coeffs->fs * ((908.f / 29761.f) + coeffs->s), &dd3if, &dd3f);
+	const size_t ndd3 = w + coeffs->ring_dd3 - 1 - (size_t)dd3if;
+
+	const float n24 = b[ndd1 & m] + dd1f * (b[(ndd1 - 1) & m] - b[ndd1 & m]);
+	const float n23 = s1 + 0.7f * n24;
+	const float dd1 = n24 - 0.7f * n23;
+	b[(w + coeffs->ring_dd1) & m] = n23;
+	const float n48 = b[ndd3 & m] + dd3f * (b[(ndd3 - 1) & m] - b[ndd3 & m]);
+	const float n46 = s2 + 0.7f * n48;
+	const float dd3 = n48 - 0.7f * n46;
+	b[(w + coeffs->ring_dd3) & m] = n46;
+	const float n30 = b[(w + coeffs->ring_d1 - 1 - coeffs->d1) & m];
+	b[(w + coeffs->ring_d1) & m] = dd1;
+	const float n54 = b[(w + coeffs->ring_d3 - 1 - coeffs->d3) & m];
+	b[(w + coeffs->ring_d3) & m] = dd3;
+	const float damp1 = bw_lp1_process1(&coeffs->damping_coeffs, &state->damping_1_state, n30);
+	const float damp2 = bw_lp1_process1(&coeffs->damping_coeffs, &state->damping_2_state, n54);
+	const float decay1 = bw_gain_process1(&coeffs->decay_coeffs, damp1);
+	const float decay2 = bw_gain_process1(&coeffs->decay_coeffs, damp2);
+	const float n33 = b[(w + coeffs->ring_dd2 - 1 - coeffs->dd2) & m];
+	const float n31 = decay1 - coeffs->diff2 * n33;
+	const float dd2 = n33 + coeffs->diff2 * n31;
+	b[(w + coeffs->ring_dd2) & m] = n31;
+	const float n59 = b[(w + coeffs->ring_dd4 - 1 - coeffs->dd4) & m];
+	const float n55 = decay2 - coeffs->diff2 * n59;
+	const float dd4 = n59 + coeffs->diff2 * n55;
+	b[(w + coeffs->ring_dd4) & m] = n55;
+	b[(w + coeffs->ring_d2) & m] = dd2;
+	b[(w + coeffs->ring_d4) & m] = dd4;
+
+	*y_l = 0.6f * (
+			b[(w + coeffs->ring_d3 - coeffs->dl1) & m]
+			+ b[(w + coeffs->ring_d3 - coeffs->dl2) & m]
+			- b[(w + coeffs->ring_dd4 - coeffs->dl3) & m]
+			+ b[(w + coeffs->ring_d4 - coeffs->dl4) & m]
+			- b[(w + coeffs->ring_d1 - coeffs->dl5) & m]
+			- b[(w + coeffs->ring_dd2 - coeffs->dl6) & m]
+			- b[(w + coeffs->ring_d2 - coeffs->dl7) & m]
+		);
+	*y_r = 0.6f * (
+			b[(w + coeffs->ring_d1 - coeffs->dr1) & m]
+			+ b[(w + coeffs->ring_d1 - coeffs->dr2) & m]
+			- b[(w + coeffs->ring_dd2 - coeffs->dr3) & m]
+			+ b[(w + coeffs->ring_d2 - coeffs->dr4) & m]
+			- b[(w + coeffs->ring_d3 - coeffs->dr5) & m]
+			- b[(w + coeffs->ring_dd4 - coeffs->dr6) & m]
+			- b[(w + coeffs->ring_d4 - coeffs->dr7) & m]
+		);
+	*y_l = bw_dry_wet_process1(&coeffs->dry_wet_coeffs, x_l, *y_l);
+	*y_r = bw_dry_wet_process1(&coeffs->dry_wet_coeffs, x_r, *y_r);
+}
+
+static inline void bw_reverb_process1(
+		const bw_reverb_coeffs * BW_RESTRICT coeffs,
+		bw_reverb_state * BW_RESTRICT        state,
+		float                                x_l,
+		float                                x_r,
+		float *                              y_l,
+		float *                              y_r) {
+	BW_ASSERT(coeffs != BW_NULL);
+	BW_ASSERT_DEEP(bw_reverb_coeffs_is_valid(coeffs));
+	BW_ASSERT_DEEP(coeffs->state >= bw_reverb_coeffs_state_reset_coeffs);
+	BW_ASSERT(state != BW_NULL);
+	BW_ASSERT_DEEP(bw_reverb_state_is_valid(coeffs, state));
+	BW_ASSERT_DEEP(state->state >= bw_reverb_state_state_reset_state);
+	BW_ASSERT(bw_is_finite(x_l));
+	BW_ASSERT(bw_is_finite(x_r));
+	BW_ASSERT(y_l != BW_NULL);
+	BW_ASSERT(y_r != BW_NULL);
+	BW_ASSERT(y_l != y_r);
+
+	if (coeffs->single_ring)
+		bw_reverb_process1_ring(coeffs, state, x_l, x_r, y_l, y_r);
+	else
+		bw_reverb_process1_delay(coeffs, state, x_l, x_r, y_l, y_r);
+	state->silent = 0;
 
 	BW_ASSERT_DEEP(bw_reverb_coeffs_is_valid(coeffs));
 	BW_ASSERT_DEEP(coeffs->state >= bw_reverb_coeffs_state_reset_coeffs);
@@ -943,6 +1216,55 @@ static inline void bw_reverb_process1(
 	BW_ASSERT(bw_is_finite(*y_r));
 }
 
+static inline void bw_reverb_silence_track(
+		bw_reverb_state * BW_RESTRICT state,
+		const float *                 x_l,
+		const float *                 x_r,
+		size_t                        n_samples) {
+	size_t z = 0;
+	while (z < n_samples && x_l[n_samples - 1 - z] == 0.f && x_r[n_samples - 1 - z] == 0.f)
+		z++;
+	if (z < n_samples) {
+		state->n_silent = z;
+		state->silent = 0;
+	} else if (!state->silent)
+		state->n_silent += n_samples;
+}
+
+static inline void bw_reverb_silence_check(
+		const bw_reverb_coeffs * BW_RESTRICT coeffs,
+		bw_reverb_state * BW_RESTRICT        state) {
+	if (state->silent || state->n_silent < bw_delay_get_length(&coeffs->predelay_coeffs))
+		return;
+	state->n_silent = 0;
+
+	float v = 0.f;
+	if (coeffs->single_ring) {
+		for (size_t i = 0; i <= coeffs->ring_mask; i++)
+			v = bw_maxf(v, bw_absf(state->ring_buf[i]));
+	} else {
+		v = bw_maxf(v, bw_delay_get_peak(&coeffs->predelay_coeffs, &state->predelay_state));
+		v = bw_maxf(v, bw_delay_get_peak(&coeffs->delay_id1_coeffs, &state->delay_id1_state));
+		v = bw_maxf(v, bw_delay_get_peak(&coeffs->delay_id2_coeffs, &state->delay_id2_state));
+		v = bw_maxf(v, bw_delay_get_peak(&coeffs->delay_id3_coeffs, &state->delay_id3_state));
+		v = bw_maxf(v, bw_delay_get_peak(&coeffs->delay_id4_coeffs, &state->delay_id4_state));
+		v = bw_maxf(v, bw_delay_get_peak(&coeffs->delay_dd1_coeffs, &state->delay_dd1_state));
+		v = bw_maxf(v, bw_delay_get_peak(&coeffs->delay_dd2_coeffs, &state->delay_dd2_state));
+		v = bw_maxf(v, bw_delay_get_peak(&coeffs->delay_dd3_coeffs, &state->delay_dd3_state));
+		v = bw_maxf(v, bw_delay_get_peak(&coeffs->delay_dd4_coeffs, &state->delay_dd4_state));
+		v = bw_maxf(v, bw_delay_get_peak(&coeffs->delay_d1_coeffs, &state->delay_d1_state));
+		v = bw_maxf(v, bw_delay_get_peak(&coeffs->delay_d2_coeffs, &state->delay_d2_state));
+		v = bw_maxf(v, bw_delay_get_peak(&coeffs->delay_d3_coeffs, &state->delay_d3_state));
+		v = bw_maxf(v, bw_delay_get_peak(&coeffs->delay_d4_coeffs, &state->delay_d4_state));
+	}
+
+	if (v < 1e-6f /* -120 dB */) {
+		float y_l, y_r;
+		bw_reverb_reset_state(coeffs, state, 0.f, 0.f, &y_l, &y_r);
+		state->silent = 1;
+	}
+}
+
 static inline void bw_reverb_process(
 		bw_reverb_coeffs * BW_RESTRICT coeffs,
 		bw_reverb_state * BW_RESTRICT  state,
@@ -966,10 +1288,18 @@ static inline void bw_reverb_process(
 	BW_ASSERT(y_l != y_r);
 
 	bw_reverb_update_coeffs_ctrl(coeffs);
-	for (size_t i = 0; i < n_samples; i++) {
-		bw_reverb_update_coeffs_audio(coeffs);
-		bw_reverb_process1(coeffs, state, x_l[i], x_r[i], y_l + i, y_r + i);
-	}
+	bw_reverb_silence_track(state, x_l, x_r, n_samples);
+	if (state->silent) {
+		for (size_t i = 0; i < n_samples; i++)
+			bw_reverb_update_coeffs_audio(coeffs);
+		bw_buf_fill(0.f, y_l, n_samples);
+		bw_buf_fill(0.f, y_r, n_samples);
+	} else
+		for (size_t i = 0; i < n_samples; i++) {
+			bw_reverb_update_coeffs_audio(coeffs);
+			bw_reverb_process1(coeffs, state, x_l[i], x_r[i], y_l + i, y_r + i);
+		}
+	bw_reverb_silence_check(coeffs, state);
 
 	BW_ASSERT_DEEP(bw_reverb_coeffs_is_valid(coeffs));
 	BW_ASSERT_DEEP(coeffs->state >= bw_reverb_coeffs_state_reset_coeffs);
@@ -1021,11 +1351,20 @@ static inline void bw_reverb_process_multi(
 #endif
 
 	bw_reverb_update_coeffs_ctrl(coeffs);
+	for (size_t j = 0; j < n_channels; j++)
+		bw_reverb_silence_track(state[j], x_l[j], x_r[j], n_samples);
 	for (size_t i = 0; i < n_samples; i++) {
 		bw_reverb_update_coeffs_audio(coeffs);
-		for (size_t j = 0; j < n_channels; j++)
-			bw_reverb_process1(coeffs, state[j], x_l[j][i], x_r[j][i], y_l[j] + i, y_r[j] + i);
+		for (size_t j = 0; j < n_channels; j++) {
+			if (state[j]->silent) {
+				y_l[j][i] = 0.f;
+				y_r[j][i] = 0.f;
+			} else
+				bw_reverb_process1(coeffs, state[j], x_l[j][i], x_r[j][i], y_l[j] + i, y_r[j] + i);
+		}
 	}
+	for (size_t j = 0; j < n_channels; j++)
+		bw_reverb_silence_check(coeffs, state[j]);
 
 	BW_ASSERT_DEEP(bw_reverb_coeffs_is_valid(coeffs));
 	BW_ASSERT_DEEP(coeffs->state >= bw_reverb_coeffs_state_reset_coeffs);
@@ -1106,6 +1445,34 @@ static inline void bw_reverb_set_wet(
 	BW_ASSERT_DEEP(coeffs->state >= bw_reverb_coeffs_state_init);
 }
 
+static inline void bw_reverb_set_single_ring(
+		bw_reverb_coeffs * BW_RESTRICT coeffs,
+		char                           value) {
+	BW_ASSERT(coeffs != BW_NULL);
+	BW_ASSERT_DEEP(bw_reverb_coeffs_is_valid(coeffs));
+	BW_ASSERT_DEEP(coeffs->state >= bw_reverb_coeffs_state_init);
+
+	coeffs->single_ring = value;
+
+	BW_ASSERT_DEEP(bw_reverb_coeffs_is_valid(coeffs));
+	BW_ASSERT_DEEP(coeffs->state >= bw_reverb_coeffs_state_init);
+}
+
+static inline char bw_reverb_is_silent(
+		const bw_reverb_coeffs * BW_RESTRICT coeffs,
+		const bw_reverb_state * BW_RESTRICT  state) {
+	BW_ASSERT(coeffs != BW_NULL);
+	BW_ASSERT_DEEP(bw_reverb_coeffs_is_valid(coeffs));
+	BW_ASSERT_DEEP(coeffs->state >= bw_reverb_coeffs_state_reset_coeffs);
+	BW_ASSERT(state != BW_NULL);
+	BW_ASSERT_DEEP(bw_reverb_state_is_valid(coeffs, state));
+	BW_ASSERT_DEEP(state->state >= bw_reverb_state_state_reset_state);
+
+	(void)coeffs;
+
+	return state->silent;
+}
+
 static inline char bw_reverb_coeffs_is_valid(
 		const bw_reverb_coeffs * BW_RESTRICT coeffs) {
 	BW_ASSERT(coeffs != BW_NULL);
@@ -1131,9 +1498,13 @@ static inline char bw_reverb_coeffs_is_valid(
 			return 0;
 		if (!bw_is_finite(coeffs->T) || coeffs->T <= 0.f)
 			return 0;
+		if ((coeffs->ring_mask & (coeffs->ring_mask + 1)) != 0 || coeffs->ring_d4 > coeffs->ring_mask)
+			return 0;
 	}
 
 	if (coeffs->state >= bw_reverb_coeffs_state_reset_coeffs) {
+		if (!bw_is_finite(coeffs->pdf) || coeffs->pdf < 0.f || coeffs->pdf >= 1.f)
+			return 0;
 		if (!bw_is_finite(coeffs->s) || coeffs->s < -8.f / 29761.f || coeffs->s > 8.f / 29761.f)
 			return 0;
 		if (!bw_is_finite(coeffs->diff2) || coeffs->diff2 < 0.25f || coeffs->s > 0.5f)
@@ -1183,9 +1554,18 @@ static inline char bw_reverb_state_is_valid(
 			|| !bw_lp1_state_is_valid(coeffs ? &coeffs->damping_coeffs : BW_NULL, &state->damping_1_state)
 			|| !bw_lp1_state_is_valid(coeffs ? &coeffs->damping_coeffs : BW_NULL, &state->damping_2_state))
 			return 0;
+
+		if (state->ring_buf != BW_NULL && coeffs != BW_NULL && state->ring_idx > coeffs->ring_mask)
+			return 0;
 	}
 #endif
 
+	if (coeffs != BW_NULL && (coeffs->single_ring != 0) != (state->ring_buf != BW_NULL))
+		return 0;
+
+	if (state->ring_buf != BW_NULL)
+		return (uintptr_t)state->ring_buf % 64 == 0;
+
 	return bw_delay_state_is_valid(coeffs ? &coeffs->predelay_coeffs : BW_NULL, &state->predelay_state)
 		&& bw_delay_state_is_valid(coeffs ? &coeffs->delay_id1_coeffs : BW_NULL, &state->delay_id1_state)
 		&& bw_delay_state_is_valid(coeffs ? &coeffs->delay_id2_coeffs : BW_NULL, &state->delay_id2_state)
@@ -1283,6 +1663,12 @@ public:
 
 	void setWet(
 		float value);
+
+	void setSingleRing(
+		bool value);
+
+	bool isSilent(
+		size_t channel);
 /*! <<<...
  *  }
  *  ```
@@ -1440,6 +1826,18 @@ inline void Reverb<N_CHANNELS>::setWet(
 	bw_reverb_set_wet(&coeffs, value);
 }
 
+template<size_t N_CHANNELS>
+inline void Reverb<N_CHANNELS>::setSingleRing(
+		bool value) {
+	bw_reverb_set_single_ring(&coeffs, value);
+}
+
+template<size_t N_CHANNELS>
+inline bool Reverb<N_CHANNELS>::isSilent(
+		size_t channel) {
+	return bw_reverb_is_silent(&coeffs, states + channel);
+}
+
 }
 #endif
 
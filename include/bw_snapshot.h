@@ -0,0 +1,488 @@
+/*
+ * Brickworks
+ *
+ * Copyright (C) 2024 Orastron Srl unipersonale
+ *
+ * Brickworks is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3 of the License.
+ *
+ * Brickworks is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Brickworks.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * File author: Stefano D'Angelo
+ */
+
+/*!
+ *  module_type {{{ utility }}}
+ *  version {{{ 1.0.0 }}}
+ *  requires {{{ bw_atomic bw_common }}}
+ *  description {{{
+ *    Wait-free single-producer single-consumer channel to publish snapshots of
+ *    `float` data (e.g., meter readings, gain reduction values, analysis
+ *    results) from one thread to another.
+ *
+ *    It is implemented as a triple buffer: the producer (typically the audio
+ *    thread) fills a private buffer and then publishes it with one atomic
+ *    exchange, while the consumer (typically a UI thread) always gets the
+ *    latest completely written snapshot, again with one atomic exchange. No
+ *    locks are involved and neither side ever waits for the other. Snapshots
+ *    that are published but not read before a newer one are simply skipped.
+ *
+ *    As an example, a PPM meter can be published once per block as:
+ *
+ *    ```
+ *    float *s = bw_snapshot_write_begin(&snapshot);
+ *    for (size_t i = 0; i < n_channels; i++)
+ *        s[i] = bw_ppm_get_y_z1(ppm_states[i]);
+ *    bw_snapshot_write_end(&snapshot);
+ *    ```
+ *
+ *    and read from any other thread with
+ *    `bw_snapshot_read(&snapshot, BW_NULL)`.
+ *  }}}
+ *  changelog {{{
+ *    <ul>
+ *      <li>Version <strong>1.0.0</strong>:
+ *        <ul>
+ *          <li>First release.</li>
+ *        </ul>
+ *      </li>
+ *    </ul>
+ *  }}}
+ */
+
+#ifndef BW_SNAPSHOT_H
+#define BW_SNAPSHOT_H
+
+#include <bw_common.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*** Public API ***/
+
+/*! api {{{
+ *    #### bw_snapshot
+ *  ```>>> */
+typedef struct bw_snapshot bw_snapshot;
+/*! <<<```
+ *    Snapshot channel object.
+ *
+ *    #### bw_snapshot_init()
+ *  ```>>> */
+static inline void bw_snapshot_init(
+	bw_snapshot * BW_RESTRICT snapshot,
+	size_t                    n_elems);
+/*! <<<```
+ *    Initializes `snapshot` so that each published snapshot consists of
+ *    `n_elems` `float` values.
+ *
+ *    `n_elems` must be positive.
+ *
+ *    #### bw_snapshot_mem_req()
+ *  ```>>> */
+static inline size_t bw_snapshot_mem_req(
+	const bw_snapshot * BW_RESTRICT snapshot);
+/*! <<<```
+ *    Returns the size, in bytes, of contiguous memory to be supplied to
+ *    `bw_snapshot_mem_set()` using `snapshot`.
+ *
+ *    #### bw_snapshot_mem_set()
+ *  ```>>> */
+static inline void bw_snapshot_mem_set(
+	bw_snapshot * BW_RESTRICT snapshot,
+	void * BW_RESTRICT        mem);
+/*! <<<```
+ *    Associates the contiguous memory block `mem` to the given `snapshot`.
+ *
+ *    `mem` must be suitably aligned to store `float` values.
+ *
+ *    #### bw_snapshot_reset()
+ *  ```>>> */
+static inline void bw_snapshot_reset(
+	bw_snapshot * BW_RESTRICT snapshot,
+	float                     value);
+/*! <<<```
+ *    Sets all elements of all buffers in `snapshot` to `value` and marks the
+ *    channel as having no fresh data.
+ *
+ *    This function must not be called while other threads are writing to or
+ *    reading from `snapshot`.
+ *
+ *    #### bw_snapshot_write_begin()
+ *  ```>>> */
+static inline float * bw_snapshot_write_begin(
+	bw_snapshot * BW_RESTRICT snapshot);
+/*! <<<```
+ *    Returns a pointer to the buffer owned by the producer, where the
+ *    `n_elems` values of the next snapshot are to be written.
+ *
+ *    The previous content of the buffer is unspecified.
+ *
+ *    Must only be called by the producer thread.
+ *
+ *    #### bw_snapshot_write_end()
+ *  ```>>> */
+static inline void bw_snapshot_write_end(
+	bw_snapshot * BW_RESTRICT snapshot);
+/*! <<<```
+ *    Publishes the snapshot written into the buffer returned by the last call
+ *    to `bw_snapshot_write_begin()`, which must not be accessed anymore.
+ *
+ *    Must only be called by the producer thread.
+ *
+ *    #### bw_snapshot_write()
+ *  ```>>> */
+static inline void bw_snapshot_write(
+	bw_snapshot * BW_RESTRICT snapshot,
+	const float * BW_RESTRICT x);
+/*! <<<```
+ *    Copies the first `n_elems` values in `x` and publishes them as a new
+ *    snapshot.
+ *
+ *    Must only be called by the producer thread.
+ *
+ *    #### bw_snapshot_read()
+ *  ```>>> */
+static inline const float * bw_snapshot_read(
+	bw_snapshot * BW_RESTRICT snapshot,
+	char * BW_RESTRICT        updated);
+/*! <<<```
+ *    Returns a pointer to the buffer owned by the consumer containing the
+ *    latest published snapshot, or the same data returned by the previous call
+ *    if nothing was published since then (or the reset value if nothing was
+ *    ever published).
+ *
+ *    If `updated` is not `BW_NULL`, it is set to non-`0` if a new snapshot
+ *    was obtained, `0` otherwise.
+ *
+ *    The returned buffer remains valid and unchanged until the next call to
+ *    this function. Must only be called by the consumer thread.
+ *
+ *    #### bw_snapshot_get_n_elems()
+ *  ```>>> */
+static inline size_t bw_snapshot_get_n_elems(
+	const bw_snapshot * BW_RESTRICT snapshot);
+/*! <<<```
+ *    Returns the number of `float` values in each snapshot.
+ *
+ *    #### bw_snapshot_is_valid()
+ *  ```>>> */
+static inline char bw_snapshot_is_valid(
+	const bw_snapshot * BW_RESTRICT snapshot);
+/*! <<<```
+ *    Tries to determine whether `snapshot` is valid and returns non-`0` if it
+ *    seems to be the case and `0` if it is certainly not. False positives are
+ *    possible, false negatives are not.
+ *
+ *    `snapshot` must at least point to a readable memory block of size greater
+ *    than or equal to that of `bw_snapshot`.
+ *  }}} */
+
+#ifdef __cplusplus
+}
+#endif
+
+/*** Implementation ***/
+
+/* WARNING: This part of the file is not part of the public API. Its content may
+ * change at any time in future versions. Please, do not use it directly. */
+
+#include <bw_atomic.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifdef BW_DEBUG_DEEP
+enum bw_snapshot_state {
+	bw_snapshot_state_invalid,
+	bw_snapshot_state_init,
+	bw_snapshot_state_mem_set,
+	bw_snapshot_state_reset
+};
+#endif
+
+struct bw_snapshot {
+#ifdef BW_DEBUG_DEEP
+	uint32_t		hash;
+	enum bw_snapshot_state	state;
+#endif
+
+	size_t			n_elems;
+	float * BW_RESTRICT	buf;
+
+	// Producer-owned
+	uint32_t		back;
+
+	// Consumer-owned
+	uint32_t		front;
+
+	// Shared: buffer index in bits 0-1, fresh flag in bit 2
+	uint32_t		middle;
+};
+
+static inline void bw_snapshot_init(
+		bw_snapshot * BW_RESTRICT snapshot,
+		size_t                    n_elems) {
+	BW_ASSERT(snapshot != BW_NULL);
+	BW_ASSERT(n_elems > 0);
+
+	snapshot->n_elems = n_elems;
+	snapshot->buf = BW_NULL;
+
+#ifdef BW_DEBUG_DEEP
+	snapshot->hash = bw_hash_sdbm("bw_snapshot");
+	snapshot->state = bw_snapshot_state_init;
+#endif
+	BW_ASSERT_DEEP(bw_snapshot_is_valid(snapshot));
+	BW_ASSERT_DEEP(snapshot->state == bw_snapshot_state_init);
+}
+
+static inline size_t bw_snapshot_mem_req(
+		const bw_snapshot * BW_RESTRICT snapshot) {
+	BW_ASSERT(snapshot != BW_NULL);
+	BW_ASSERT_DEEP(bw_snapshot_is_valid(snapshot));
+	BW_ASSERT_DEEP(snapshot->state >= bw_snapshot_state_init);
+
+	return 3 * snapshot->n_elems * sizeof(float);
+}
+
+static inline void bw_snapshot_mem_set(
+		bw_snapshot * BW_RESTRICT snapshot,
+		void * BW_RESTRICT        mem) {
+	BW_ASSERT(snapshot != BW_NULL);
+	BW_ASSERT_DEEP(bw_snapshot_is_valid(snapshot));
+	BW_ASSERT_DEEP(snapshot->state >= bw_snapshot_state_init);
+	BW_ASSERT(mem != BW_NULL);
+
+	snapshot->buf = (float *)mem;
+
+#ifdef BW_DEBUG_DEEP
+	snapshot->state = bw_snapshot_state_mem_set;
+#endif
+	BW_ASSERT_DEEP(bw_snapshot_is_valid(snapshot));
+	BW_ASSERT_DEEP(snapshot->state == bw_snapshot_state_mem_set);
+}
+
+static inline void bw_snapshot_reset(
+		bw_snapshot * BW_RESTRICT snapshot,
+		float                     value) {
+	BW_ASSERT(snapshot != BW_NULL);
+	BW_ASSERT_DEEP(bw_snapshot_is_valid(snapshot));
+	BW_ASSERT_DEEP(snapshot->state >= bw_snapshot_state_mem_set);
+	BW_ASSERT(!bw_is_nan(value));
+
+	for (size_t i = 0; i < 3 * snapshot->n_elems; i++)
+		snapshot->buf[i] = value;
+	snapshot->back = 0;
+	snapshot->front = 2;
+	bw_atomic_store(&snapshot->middle, 1);
+
+#ifdef BW_DEBUG_DEEP
+	snapshot->state = bw_snapshot_state_reset;
+#endif
+	BW_ASSERT_DEEP(bw_snapshot_is_valid(snapshot));
+	BW_ASSERT_DEEP(snapshot->state == bw_snapshot_state_reset);
+}
+
+static inline float * bw_snapshot_write_begin(
+		bw_snapshot * BW_RESTRICT snapshot) {
+	BW_ASSERT(snapshot != BW_NULL);
+	BW_ASSERT_DEEP(bw_snapshot_is_valid(snapshot));
+	BW_ASSERT_DEEP(snapshot->state >= bw_snapshot_state_reset);
+
+	return snapshot->buf + snapshot->back * snapshot->n_elems;
+}
+
+static inline void bw_snapshot_write_end(
+		bw_snapshot * BW_RESTRICT snapshot) {
+	BW_ASSERT(snapshot != BW_NULL);
+	BW_ASSERT_DEEP(bw_snapshot_is_valid(snapshot));
+	BW_ASSERT_DEEP(snapshot->state >= bw_snapshot_state_reset);
+
+	snapshot->back = bw_atomic_exchange(&snapshot->middle, snapshot->back | 4) & 3;
+
+	BW_ASSERT_DEEP(bw_snapshot_is_valid(snapshot));
+}
+
+static inline void bw_snapshot_write(
+		bw_snapshot * BW_RESTRICT snapshot,
+		const float * BW_RESTRICT x) {
+	BW_ASSERT(snapshot != BW_NULL);
+	BW_ASSERT_DEEP(bw_snapshot_is_valid(snapshot));
+	BW_ASSERT_DEEP(snapshot->state >= bw_snapshot_state_reset);
+	BW_ASSERT(x != BW_NULL);
+	BW_ASSERT_DEEP(!bw_has_nan(x, snapshot->n_elems));
+
+	float * const b = bw_snapshot_write_begin(snapshot);
+	for (size_t i = 0; i < snapshot->n_elems; i++)
+		b[i] = x[i];
+	bw_snapshot_write_end(snapshot);
+}
+
+static inline const float * bw_snapshot_read(
+		bw_snapshot * BW_RESTRICT snapshot,
+		char * BW_RESTRICT        updated) {
+	BW_ASSERT(snapshot != BW_NULL);
+	BW_ASSERT_DEEP(bw_snapshot_is_valid(snapshot));
+	BW_ASSERT_DEEP(snapshot->state >= bw_snapshot_state_reset);
+
+	const char fresh = (bw_atomic_load(&snapshot->middle) & 4) != 0;
+	if (fresh)
+		snapshot->front = bw_atomic_exchange(&snapshot->middle, snapshot->front) & 3;
+	if (updated != BW_NULL)
+		*updated = fresh;
+
+	BW_ASSERT_DEEP(bw_snapshot_is_valid(snapshot));
+
+	return snapshot->buf + snapshot->front * snapshot->n_elems;
+}
+
+static inline size_t bw_snapshot_get_n_elems(
+		const bw_snapshot * BW_RESTRICT snapshot) {
+	BW_ASSERT(snapshot != BW_NULL);
+	BW_ASSERT_DEEP(bw_snapshot_is_valid(snapshot));
+
+	return snapshot->n_elems;
+}
+
+static inline char bw_snapshot_is_valid(
+		const bw_snapshot * BW_RESTRICT snapshot) {
+	BW_ASSERT(snapshot != BW_NULL);
+
+#ifdef BW_DEBUG_DEEP
+	if (snapshot->hash != bw_hash_sdbm("bw_snapshot"))
+		return 0;
+	if (snapshot->state < bw_snapshot_state_init || snapshot->state > bw_snapshot_state_reset)
+		return 0;
+#endif
+
+	if (snapshot->n_elems == 0)
+		return 0;
+
+#ifdef BW_DEBUG_DEEP
+	if (snapshot->state >= bw_snapshot_state_mem_set && snapshot->buf == BW_NULL)
+		return 0;
+
+	if (snapshot->state >= bw_snapshot_state_reset) {
+		// middle is not checked as it may be concurrently modified
+		if (snapshot->back > 2 || snapshot->front > 2)
+			return 0;
+	}
+#endif
+
+	return 1;
+}
+
+#ifdef __cplusplus
+}
+
+#ifndef BW_CXX_NO_ARRAY
+# include <array>
+#endif
+
+namespace Brickworks {
+
+/*** Public C++ API ***/
+
+/*! api_cpp {{{
+ *    ##### Brickworks::Snapshot
+ *  ```>>> */
+template<size_t N_ELEMS>
+class Snapshot {
+public:
+	Snapshot(
+		float value = 0.f);
+
+	void reset(
+		float value = 0.f);
+
+	float * writeBegin();
+
+	void writeEnd();
+
+	void write(
+		const float * x);
+
+#ifndef BW_CXX_NO_ARRAY
+	void write(
+		const std::array<float, N_ELEMS> & x);
+#endif
+
+	const float * read(
+		bool * updated = nullptr);
+/*! <<<...
+ *  }
+ *  ```
+ *  }}} */
+
+/*** Implementation ***/
+
+/* WARNING: This part of the file is not part of the public API. Its content may
+ * change at any time in future versions. Please, do not use it directly. */
+
+private:
+	bw_snapshot	snapshot;
+	float		mem[3 * N_ELEMS];
+};
+
+template<size_t N_ELEMS>
+inline Snapshot<N_ELEMS>::Snapshot(
+		float value) {
+	bw_snapshot_init(&snapshot, N_ELEMS);
+	bw_snapshot_mem_set(&snapshot, mem);
+	bw_snapshot_reset(&snapshot, value);
+}
+
+template<size_t N_ELEMS>
+inline void Snapshot<N_ELEMS>::reset(
+		float value) {
+	bw_snapshot_reset(&snapshot, value);
+}
+
+template<size_t N_ELEMS>
+inline float * Snapshot<N_ELEMS>::writeBegin() {
+	return bw_snapshot_write_begin(&snapshot);
+}
+
+template<size_t N_ELEMS>
+inline void Snapshot<N_ELEMS>::writeEnd() {
+	bw_snapshot_write_end(&snapshot);
+}
+
+template<size_t N_ELEMS>
+inline void Snapshot<N_ELEMS>::write(
+		const float * x) {
+	bw_snapshot_write(&snapshot, x);
+}
+
+#ifndef BW_CXX_NO_ARRAY
+template<size_t N_ELEMS>
+inline void Snapshot<N_ELEMS>::write(
+		const std::array<float, N_ELEMS> & x) {
+	write(x.data());
+}
+#endif
+
+template<size_t N_ELEMS>
+inline const float * Snapshot<N_ELEMS>::read(
+		bool * updated) {
+	char u;
+	const float *y = bw_snapshot_read(&snapshot, &u);
+	if (updated != nullptr)
+		*updated = u;
+	return y;
+}
+
+}
+#endif
+
+#endif
@@ -0,0 +1,846 @@
+/*
+ * Brickworks
+ *
+ * Copyright (C) 2024 Orastron Srl unipersonale
+ *
+ * Brickworks is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3 of the License.
+ *
+ * Brickworks is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Brickworks.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * File author: Stefano D'Angelo
+ */
+
+/*!
+ *  module_type {{{ dsp }}}
+ *  version {{{ 1.0.0 }}}
+ *  requires {{{ bw_common bw_math }}}
+ *  description {{{
+ *    Arbitrary-ratio polyphase windowed-sinc sample rate converter.
+ *
+ *    Kaiser-windowed sinc filter tables are precomputed by
+ *    `bw_src_sinc_init()` and stored in the coefficients, which are thus
+ *    rather large (around 64 kB).
+ *
+ *    If the resampling ratio is (within one part in ten million)
+ *    equal to a fraction whose numerator is small enough, then one filter
+ *    phase is stored for each possible output position and output samples
+ *    are computed exactly using a single dot product each (e.g., 44.1 kHz to
+ *    48 kHz, that is 160/147). Otherwise, 256 phases are stored and output
+ *    samples are obtained by linear interpolation of the outputs of the two
+ *    closest phases.
+ *
+ *    The input position is tracked by integer arithmetic, hence the number of
+ *    input samples needed to produce a given number of output samples, or
+ *    vice versa, can be computed in advance exactly.
+ *  }}}
+ *  changelog {{{
+ *    <ul>
+ *      <li>Version <strong>1.0.0</strong>:
+ *        <ul>
+ *          <li>First release.</li>
+ *        </ul>
+ *      </li>
+ *    </ul>
+ *  }}}
+ */
+
+#ifndef BW_SRC_SINC_H
+#define BW_SRC_SINC_H
+
+#include <bw_common.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*! api {{{
+ *    #### bw_src_sinc_coeffs
+ *  ```>>> */
+typedef struct bw_src_sinc_coeffs bw_src_sinc_coeffs;
+/*! <<<```
+ *    Coefficients and related.
+ *
+ *    #### bw_src_sinc_state
+ *  ```>>> */
+typedef struct bw_src_sinc_state bw_src_sinc_state;
+/*! <<<```
+ *    Internal state and related.
+ *
+ *    #### bw_src_sinc_quality
+ *  ```>>> */
+typedef enum {
+	bw_src_sinc_quality_low,
+	bw_src_sinc_quality_medium,
+	bw_src_sinc_quality_high
+} bw_src_sinc_quality;
+/*! <<<```
+ *    Conversion quality:
+ *     * `bw_src_sinc_quality_low`: 16 taps, passband up to 0.375 times the
+ *       lower sample rate, about 60 dB of stopband attenuation;
+ *     * `bw_src_sinc_quality_medium`: 32 taps, passband up to 0.4 times the
+ *       lower sample rate, about 95 dB of stopband attenuation;
+ *     * `bw_src_sinc_quality_high`: 64 taps, passband up to 0.44 times the
+ *       lower sample rate, about 115 dB of stopband attenuation.
+ *
+ *    When downsampling, the number of taps is increased by the inverse of the
+ *    resampling ratio in order to preserve stopband attenuation. Beyond 64
+ *    taps, the transition band is widened instead.
+ *
+ *    #### bw_src_sinc_init()
+ *  ```>>> */
+static inline void bw_src_sinc_init(
+	bw_src_sinc_coeffs * BW_RESTRICT coeffs,
+	float                            ratio,
+	bw_src_sinc_quality              quality);
+/*! <<<```
+ *    Initializes `coeffs` using the given resampling `ratio` and `quality`.
+ *
+ *    `ratio` must be between `0.015625f` (1/64) and `64.f` and determines the
+ *    sample rate of the output signal, which will be equal to `ratio` times
+ *    the sample rate of the input signal.
+ *
+ *    #### bw_src_sinc_reset_state()
+ *  ```>>> */
+static inline float bw_src_sinc_reset_state(
+	const bw_src_sinc_coeffs * BW_RESTRICT coeffs,
+	bw_src_sinc_state * BW_RESTRICT        state,
+	float                                  x_0);
+/*! <<<```
+ *    Resets the given `state` to its initial values using the given `coeffs`
+ *    and the initial input value `x_0`.
+ *
+ *    Returns the corresponding initial output value.
+ *
+ *    #### bw_src_sinc_reset_state_multi()
+ *  ```>>> */
+static inline void bw_src_sinc_reset_state_multi(
+	const bw_src_sinc_coeffs * BW_RESTRICT              coeffs,
+	bw_src_sinc_state * BW_RESTRICT const * BW_RESTRICT state,
+	const float *                                       x_0,
+	float *                                             y_0,
+	size_t                                              n_channels);
+/*! <<<```
+ *    Resets each of the `n_channels` `state`s to its initial values using the
+ *    given `coeffs` and the corresponding initial input value in the `x_0`
+ *    array.
+ *
+ *    The corresponding initial output values are written into the `y_0` array,
+ *    if not `BW_NULL`.
+ *
+ *    #### bw_src_sinc_process()
+ *  ```>>> */
+static inline void bw_src_sinc_process(
+	const bw_src_sinc_coeffs * BW_RESTRICT coeffs,
+	bw_src_sinc_state * BW_RESTRICT        state,
+	const float * BW_RESTRICT              x,
+	float * BW_RESTRICT                    y,
+	size_t * BW_RESTRICT                   n_in_samples,
+	size_t * BW_RESTRICT                   n_out_samples);
+/*! <<<```
+ *    Processes at most the first `n_in_samples` of the input buffer `x` and
+ *    fills the output buffer `y` with at most `n_out_samples` using `coeffs`,
+ *    while using and updating `state`.
+ *
+ *    After the call `n_in_samples` and `n_out_samples` will contain the actual
+ *    number of consumed input samples and generated output samples,
+ *    respectively.
+ *
+ *    Input samples are only consumed as long as they are needed to produce
+ *    output samples. Hence, if `n_in_samples` is at least
+ *    `bw_src_sinc_get_in_samples(coeffs, state, n_out_samples)`, then exactly
+ *    that many input samples are consumed and exactly `n_out_samples` output
+ *    samples are generated.
+ *
+ *    `x` and `y` must point to different buffers. Also, `n_in_samples` and
+ *    `n_out_samples` must be different.
+ *
+ *    #### bw_src_sinc_process_multi()
+ *  ```>>> */
+static inline void bw_src_sinc_process_multi(
+	const bw_src_sinc_coeffs * BW_RESTRICT              coeffs,
+	bw_src_sinc_state * BW_RESTRICT const * BW_RESTRICT state,
+	const float * BW_RESTRICT const * BW_RESTRICT       x,
+	float * BW_RESTRICT const * BW_RESTRICT             y,
+	size_t                                              n_channels,
+	size_t * BW_RESTRICT                                n_in_samples,
+	size_t * BW_RESTRICT                                n_out_samples);
+/*! <<<```
+ *    Processes at most the first `n_in_samples[i]` of each input buffer `x[i]`
+ *    and fills the corresponding output buffer `y[i]` with at most
+ *    `n_out_samples[i]` using `coeffs`, while using and updating each
+ *    `state[i]`.
+ *
+ *    After the call each element in `n_in_samples` and `n_out_samples` will
+ *    contain the actual number of consumed input samples and generated output
+ *    samples, respectively, for each of the `n_channels` input/output buffer
+ *    couples.
+ *
+ *    A given buffer cannot be used both as an input and output buffer. Also,
+ *    `n_in_samples` and `n_out_samples` must point to non-overlapping memory
+ *    areas.
+ *
+ *    #### bw_src_sinc_get_in_samples()
+ *  ```>>> */
+static inline size_t bw_src_sinc_get_in_samples(
+	const bw_src_sinc_coeffs * BW_RESTRICT coeffs,
+	const bw_src_sinc_state * BW_RESTRICT  state,
+	size_t                                 n_out_samples);
+/*! <<<```
+ *    Returns the number of input samples that `bw_src_sinc_process()` needs
+ *    to generate `n_out_samples` output samples using `coeffs` and starting
+ *    from `state`.
+ *
+ *    #### bw_src_sinc_get_out_samples()
+ *  ```>>> */
+static inline size_t bw_src_sinc_get_out_samples(
+	const bw_src_sinc_coeffs * BW_RESTRICT coeffs,
+	const bw_src_sinc_state * BW_RESTRICT  state,
+	size_t                                 n_in_samples);
+/*! <<<```
+ *    Returns the maximum number of output samples that
+ *    `bw_src_sinc_process()` can generate out of `n_in_samples` input samples
+ *    using `coeffs` and starting from `state`.
+ *
+ *    `n_in_samples` must be less than `2147483648` (2^31).
+ *
+ *    #### bw_src_sinc_get_latency()
+ *  ```>>> */
+static inline float bw_src_sinc_get_latency(
+	const bw_src_sinc_coeffs * BW_RESTRICT coeffs);
+/*! <<<```
+ *    Returns the latency (samples at the input sample rate) introduced by the
+ *    sample rate converter using `coeffs`.
+ *
+ *    #### bw_src_sinc_coeffs_is_valid()
+ *  ```>>> */
+static inline char bw_src_sinc_coeffs_is_valid(
+	const bw_src_sinc_coeffs * BW_RESTRICT coeffs);
+/*! <<<```
+ *    Tries to determine whether `coeffs` is valid and returns non-`0` if it
+ *    seems to be the case and `0` if it is certainly not. False positives are
+ *    possible, false negatives are not.
+ *
+ *    `coeffs` must at least point to a readable memory block of size greater
+ *    than or equal to that of `bw_src_sinc_coeffs`.
+ *
+ *    #### bw_src_sinc_state_is_valid()
+ *  ```>>> */
+static inline char bw_src_sinc_state_is_valid(
+	const bw_src_sinc_coeffs * BW_RESTRICT coeffs,
+	const bw_src_sinc_state * BW_RESTRICT  state);
+/*! <<<```
+ *    Tries to determine whether `state` is valid and returns non-`0` if it
+ *    seems to be the case and `0` if it is certainly not. False positives are
+ *    possible, false negatives are not.
+ *
+ *    If `coeffs` is not `BW_NULL` extra cross-checks might be performed
+ *    (`state` is supposed to be associated to `coeffs`).
+ *
+ *    `state` must at least point to a readable memory block of size greater
+ *    than or equal to that of `bw_src_sinc_state`.
+ *  }}} */
+
+#ifdef __cplusplus
+}
+#endif
+
+/*** Implementation ***/
+
+/* WARNING: This part of the file is not part of the public API. Its content may
+ * change at any time in future versions. Please, do not use it directly. */
+
+#include <bw_math.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define BW_SRC_SINC_TAPS_MAX	64
+#define BW_SRC_SINC_PHASES	256
+#define BW_SRC_SINC_PHASE_SHIFT	24	// 32 - log2(BW_SRC_SINC_PHASES)
+#define BW_SRC_SINC_TABLE_LEN	((BW_SRC_SINC_PHASES + 1) * BW_SRC_SINC_TAPS_MAX)
+
+struct bw_src_sinc_coeffs {
+#ifdef BW_DEBUG_DEEP
+	uint32_t	hash;
+	uint32_t	reset_id;
+#endif
+
+	// Coefficients
+	size_t		n_taps;
+	char		rational;
+	uint64_t	den;		// position denominator (L if rational, 2^32 otherwise)
+	uint64_t	step;		// position increment per output sample (M if rational)
+	float		h[BW_SRC_SINC_TABLE_LEN];
+};
+
+struct bw_src_sinc_state {
+#ifdef BW_DEBUG_DEEP
+	uint32_t	hash;
+	uint32_t	coeffs_reset_id;
+#endif
+
+	// Buffers (history is stored twice in a row)
+	float		buf[2 * BW_SRC_SINC_TAPS_MAX];
+
+	// States
+	size_t		idx;
+	uint64_t	pos;
+};
+
+// Filter design happens at initialization time only and needs more accuracy
+// than what bw_math provides, hence the following double precision helpers.
+
+static inline double bw_src_sinc_sinpi(
+		double x) {
+	// sin(pi * x)
+	const double n = x >= 0.0 ? (double)(int64_t)(x + 0.5) : -(double)(int64_t)(0.5 - x);
+	const double t = 3.141592653589793 * (x - n);
+	const double t2 = t * t;
+	double term = t;
+	double s = t;
+	for (int k = 1; k < 12; k++) {
+		term *= -t2 / (double)((2 * k) * (2 * k + 1));
+		s += term;
+	}
+	return (int64_t)n & 1 ? -s : s;
+}
+
+static inline double bw_src_sinc_sqrt(
+		double x) {
+	if (x <= 0.0)
+		return 0.0;
+	double y = (double)bw_sqrtf((float)x);
+	y = 0.5 * (y + x / y);
+	return 0.5 * (y + x / y);
+}
+
+static inline double bw_src_sinc_i0(
+		double x) {
+	// zeroth order modified Bessel function of the first kind
+	const double x2 = 0.25 * x * x;
+	double term = 1.0;
+	double s = 1.0;
+	for (int k = 1; k < 200 && term > 1e-17 * s; k++) {
+		term *= x2 / (double)(k * k);
+		s += term;
+	}
+	return s;
+}
+
+// Also used by bw_asrc, which needs arbitrary phases (allow_rational = 0)
+static inline void bw_src_sinc_design(
+		bw_src_sinc_coeffs * BW_RESTRICT coeffs,
+		float                            ratio,
+		bw_src_sinc_quality              quality,
+		char                             allow_rational) {
+	static const size_t n_taps[3] = { 16, 32, 64 };
+	static const double df[3] = { 0.25, 0.2, 0.12 }; // transition bandwidths, relative to the lower sample rate
+
+	const double r = ratio < 1.f ? (double)ratio : 1.0;
+	size_t n = (size_t)((double)n_taps[quality] / r + 3.0) & ~(size_t)3;
+	double d = df[quality];
+	if (n > BW_SRC_SINC_TAPS_MAX) {
+		// keep stopband attenuation by widening the transition band
+		n = BW_SRC_SINC_TAPS_MAX;
+		d = d * (double)(n_taps[quality] - 1) / ((double)(n - 1) * r);
+		d = d < 0.5 ? d : 0.5;
+	}
+	coeffs->n_taps = n;
+
+	// look for rational ratio L / M
+	size_t n_phases = BW_SRC_SINC_PHASES;
+	coeffs->rational = 0;
+	coeffs->den = (uint64_t)1 << 32;
+	coeffs->step = (uint64_t)(4294967296.0 / (double)ratio + 0.5);
+	for (size_t l = 1; allow_rational && l * n <= BW_SRC_SINC_TABLE_LEN; l++) {
+		const uint64_t m = (uint64_t)((double)l / (double)ratio + 0.5);
+		if (m == 0)
+			continue;
+		const double e = (double)l - (double)m * (double)ratio;
+		if (e <= 1e-7 * (double)l && e >= -1e-7 * (double)l) {
+			n_phases = l;
+			coeffs->rational = 1;
+			coeffs->den = l;
+			coeffs->step = m;
+			break;
+		}
+	}
+
+	// Kaiser-windowed sinc
+	const double dw = 6.283185307179586 * d * r;
+	const double a = 8.0 + 2.285 * (double)(n - 1) * dw;
+	const double beta = a > 50.0 ? 0.1102 * (a - 8.7) : (a > 21.0 ? 0.5842 * bw_pow2f(0.4f * bw_log2f((float)(a - 21.0))) + 0.07886 * (a - 21.0) : 0.0);
+	const double fc2 = r * (1.0 - d); // 2 * cutoff
+	const double k_i0 = 1.0 / bw_src_sinc_i0(beta);
+	const double k_u = 2.0 / (double)n;
+	const size_t n_rows = coeffs->rational ? n_phases : n_phases + 1;
+	for (size_t p = 0; p < n_rows; p++) {
+		float * BW_RESTRICT h = coeffs->h + p * n;
+		const double mu = (double)p / (double)n_phases;
+		double s = 0.0;
+		for (size_t k = 0; k < n; k++) {
+			const double t = mu + (double)(n / 2 - 1) - (double)k;
+			const double u = t * k_u;
+			const double w = u >= 1.0 || u <= -1.0 ? 0.0 : bw_src_sinc_i0(beta * bw_src_sinc_sqrt(1.0 - u * u)) * k_i0;
+			const double v = fc2 * t;
+			const double g = (v == 0.0 ? 1.0 : bw_src_sinc_sinpi(v) / (3.141592653589793 * v)) * w;
+			h[k] = (float)g;
+			s += g;
+		}
+		// unity gain at DC for every phase
+		const float k_s = (float)(1.0 / s);
+		for (size_t k = 0; k < n; k++)
+			h[k] *= k_s;
+	}
+}
+
+static inline void bw_src_sinc_init(
+		bw_src_sinc_coeffs * BW_RESTRICT coeffs,
+		float                            ratio,
+		bw_src_sinc_quality              quality) {
+	BW_ASSERT(coeffs != BW_NULL);
+	BW_ASSERT(bw_is_finite(ratio));
+	BW_ASSERT(ratio >= 0.015625f && ratio <= 64.f);
+	BW_ASSERT(quality == bw_src_sinc_quality_low || quality == bw_src_sinc_quality_medium || quality == bw_src_sinc_quality_high);
+
+	bw_src_sinc_design(coeffs, ratio, quality, 1);
+
+#ifdef BW_DEBUG_DEEP
+	coeffs->hash = bw_hash_sdbm("bw_src_sinc_coeffs");
+	coeffs->reset_id = coeffs->hash + 1;
+#endif
+	BW_ASSERT_DEEP(bw_src_sinc_coeffs_is_valid(coeffs));
+}
+
+static inline float bw_src_sinc_reset_state(
+		const bw_src_sinc_coeffs * BW_RESTRICT coeffs,
+		bw_src_sinc_state * BW_RESTRICT        state,
+		float                                  x_0) {
+	BW_ASSERT(coeffs != BW_NULL);
+	BW_ASSERT_DEEP(bw_src_sinc_coeffs_is_valid(coeffs));
+	BW_ASSERT(state != BW_NULL);
+	BW_ASSERT(bw_is_finite(x_0));
+
+	for (size_t i = 0; i < 2 * coeffs->n_taps; i++)
+		state->buf[i] = x_0;
+	state->idx = 0;
+	state->pos = coeffs->den; // first output sample needs one input sample
+	const float y = x_0;
+
+#ifdef BW_DEBUG_DEEP
+	state->hash = bw_hash_sdbm("bw_src_sinc_state");
+	state->coeffs_reset_id = coeffs->reset_id;
+#endif
+	BW_ASSERT_DEEP(bw_src_sinc_coeffs_is_valid(coeffs));
+	BW_ASSERT_DEEP(bw_src_sinc_state_is_valid(coeffs, state));
+	BW_ASSERT(bw_is_finite(y));
+
+	return y;
+}
+
+static inline void bw_src_sinc_reset_state_multi(
+		const bw_src_sinc_coeffs * BW_RESTRICT              coeffs,
+		bw_src_sinc_state * BW_RESTRICT const * BW_RESTRICT state,
+		const float *                                       x_0,
+		float *                                             y_0,
+		size_t                                              n_channels) {
+	BW_ASSERT(coeffs != BW_NULL);
+	BW_ASSERT_DEEP(bw_src_sinc_coeffs_is_valid(coeffs));
+	BW_ASSERT(state != BW_NULL);
+#ifndef BW_NO_DEBUG
+	for (size_t i = 0; i < n_channels; i++)
+		for (size_t j = i + 1; j < n_channels; j++)
+			BW_ASSERT(state[i] != state[j]);
+#endif
+	BW_ASSERT(x_0 != BW_NULL);
+
+	if (y_0 != BW_NULL)
+		for (size_t i = 0; i < n_channels; i++)
+			y_0[i] = bw_src_sinc_reset_state(coeffs, state[i], x_0[i]);
+	else
+		for (size_t i = 0; i < n_channels; i++)
+			bw_src_sinc_reset_state(coeffs, state[i], x_0[i]);
+
+	BW_ASSERT_DEEP(bw_src_sinc_coeffs_is_valid(coeffs));
+	BW_ASSERT_DEEP(y_0 != BW_NULL ? bw_has_only_finite(y_0, n_channels) : 1);
+}
+
+static inline float bw_src_sinc_dot(
+		const float * BW_RESTRICT h,
+		const float * BW_RESTRICT w,
+		size_t                    n) {
+	// n is a multiple of 4, 4 independent partial sums can be vectorized
+	float v[4] = { 0.f, 0.f, 0.f, 0.f };
+	for (size_t k = 0; k < n; k += 4) {
+		v[0] += h[k] * w[k];
+		v[1] += h[k + 1] * w[k + 1];
+		v[2] += h[k + 2] * w[k + 2];
+		v[3] += h[k + 3] * w[k + 3];
+	}
+	return (v[0] + v[1]) + (v[2] + v[3]);
+}
+
+// Arbitrary phases only, frac is the fractional position (32-bit fixed point),
+// also used by bw_asrc
+static inline float bw_src_sinc_interp(
+		const bw_src_sinc_coeffs * BW_RESTRICT coeffs,
+		const float * BW_RESTRICT              w,
+		uint32_t                               frac) {
+	const size_t n = coeffs->n_taps;
+	const float * BW_RESTRICT h = coeffs->h + (frac >> BW_SRC_SINC_PHASE_SHIFT) * n;
+	const float a = (float)(frac & ((1u << BW_SRC_SINC_PHASE_SHIFT) - 1)) * (1.f / (float)(1u << BW_SRC_SINC_PHASE_SHIFT));
+	const float v0 = bw_src_sinc_dot(h, w, n);
+	const float v1 = bw_src_sinc_dot(h + n, w, n);
+	return v0 + a * (v1 - v0);
+}
+
+static inline void bw_src_sinc_process(
+		const bw_src_sinc_coeffs * BW_RESTRICT coeffs,
+		bw_src_sinc_state * BW_RESTRICT        state,
+		const float * BW_RESTRICT              x,
+		float * BW_RESTRICT                    y,
+		size_t * BW_RESTRICT                   n_in_samples,
+		size_t * BW_RESTRICT                   n_out_samples) {
+	BW_ASSERT(coeffs != BW_NULL);
+	BW_ASSERT_DEEP(bw_src_sinc_coeffs_is_valid(coeffs));
+	BW_ASSERT(state != BW_NULL);
+	BW_ASSERT_DEEP(bw_src_sinc_state_is_valid(coeffs, state));
+	BW_ASSERT(n_in_samples != BW_NULL);
+	BW_ASSERT(n_out_samples != BW_NULL);
+	BW_ASSERT(n_in_samples != n_out_samples);
+	BW_ASSERT(x != BW_NULL);
+	BW_ASSERT_DEEP(bw_has_only_finite(x, *n_in_samples));
+	BW_ASSERT(y != BW_NULL);
+	BW_ASSERT(x != y);
+
+	const size_t n = coeffs->n_taps;
+	float * BW_RESTRICT buf = state->buf;
+	size_t idx = state->idx;
+	uint64_t pos = state->pos;
+	size_t i = 0;
+	size_t j = 0;
+	while (j < *n_out_samples) {
+		if (pos >= coeffs->den) {
+			if (i == *n_in_samples)
+				break;
+			idx = idx + 1 == n ? 0 : idx + 1;
+			buf[idx] = x[i];
+			buf[idx + n] = x[i];
+			pos -= coeffs->den;
+			i++;
+			continue;
+		}
+
+		// w[0] is the oldest sample and w[n - 1] the newest
+		const float * BW_RESTRICT w = buf + idx + 1;
+		if (coeffs->rational)
+			y[j] = bw_src_sinc_dot(coeffs->h + pos * n, w, n);
+		else
+			y[j] = bw_src_sinc_interp(coeffs, w, (uint32_t)pos);
+		pos += coeffs->step;
+		j++;
+	}
+	state->idx = idx;
+	state->pos = pos;
+	*n_in_samples = i;
+	*n_out_samples = j;
+
+	BW_ASSERT_DEEP(bw_src_sinc_coeffs_is_valid(coeffs));
+	BW_ASSERT_DEEP(bw_src_sinc_state_is_valid(coeffs, state));
+	BW_ASSERT_DEEP(bw_has_only_finite(y, *n_out_samples));
+}
+
+static inline void bw_src_sinc_process_multi(
+		const bw_src_sinc_coeffs * BW_RESTRICT              coeffs,
+		bw_src_sinc_state * BW_RESTRICT const * BW_RESTRICT state,
+		const float * BW_RESTRICT const * BW_RESTRICT       x,
+		float * BW_RESTRICT const * BW_RESTRICT             y,
+		size_t                                              n_channels,
+		size_t * BW_RESTRICT                                n_in_samples,
+		size_t * BW_RESTRICT                                n_out_samples) {
+	BW_ASSERT(coeffs != BW_NULL);
+	BW_ASSERT_DEEP(bw_src_sinc_coeffs_is_valid(coeffs));
+	BW_ASSERT(state != BW_NULL);
+#ifndef BW_NO_DEBUG
+	for (size_t i = 0; i < n_channels; i++)
+		for (size_t j = i + 1; j < n_channels; j++)
+			BW_ASSERT(state[i] != state[j]);
+#endif
+	BW_ASSERT(x != BW_NULL);
+	BW_ASSERT(y != BW_NULL);
+	BW_ASSERT((void *)x != (void *)y);
+#ifndef BW_NO_DEBUG
+	for (size_t i = 0; i < n_channels; i++)
+		for (size_t j = i + 1; j < n_channels; j++)
+			BW_ASSERT(y[i] != y[j]);
+	for (size_t i = 0; i < n_channels; i++)
+		for (size_t j = 0; j < n_channels; j++)
+			BW_ASSERT((void *)x[i] != (void *)y[j]);
+#endif
+	BW_ASSERT(n_in_samples != BW_NULL);
+	BW_ASSERT(n_out_samples != BW_NULL);
+	BW_ASSERT(n_in_samples != n_out_samples);
+
+	for (size_t i = 0; i < n_channels; i++)
+		bw_src_sinc_process(coeffs, state[i], x[i], y[i], n_in_samples + i, n_out_samples + i);
+
+	BW_ASSERT_DEEP(bw_src_sinc_coeffs_is_valid(coeffs));
+}
+
+static inline size_t bw_src_sinc_get_in_samples(
+		const bw_src_sinc_coeffs * BW_RESTRICT coeffs,
+		const bw_src_sinc_state * BW_RESTRICT  state,
+		size_t                                 n_out_samples) {
+	BW_ASSERT(coeffs != BW_NULL);
+	BW_ASSERT_DEEP(bw_src_sinc_coeffs_is_valid(coeffs));
+	BW_ASSERT(state != BW_NULL);
+	BW_ASSERT_DEEP(bw_src_sinc_state_is_valid(coeffs, state));
+
+	// input samples consumed before generating the last output sample
+	return n_out_samples == 0 ? 0 : (size_t)((state->pos + (uint64_t)(n_out_samples - 1) * coeffs->step) / coeffs->den);
+}
+
+static inline size_t bw_src_sinc_get_out_samples(
+		const bw_src_sinc_coeffs * BW_RESTRICT coeffs,
+		const bw_src_sinc_state * BW_RESTRICT  state,
+		size_t                                 n_in_samples) {
+	BW_ASSERT(coeffs != BW_NULL);
+	BW_ASSERT_DEEP(bw_src_sinc_coeffs_is_valid(coeffs));
+	BW_ASSERT(state != BW_NULL);
+	BW_ASSERT_DEEP(bw_src_sinc_state_is_valid(coeffs, state));
+	BW_ASSERT(n_in_samples < ((size_t)1 << 31));
+
+	// last position reachable before needing one more input sample
+	const uint64_t p = ((uint64_t)n_in_samples + 1) * coeffs->den - 1;
+	return p < state->pos ? 0 : (size_t)((p - state->pos) / coeffs->step) + 1;
+}
+
+static inline float bw_src_sinc_get_latency(
+		const bw_src_sinc_coeffs * BW_RESTRICT coeffs) {
+	BW_ASSERT(coeffs != BW_NULL);
+	BW_ASSERT_DEEP(bw_src_sinc_coeffs_is_valid(coeffs));
+
+	return (float)(coeffs->n_taps >> 1);
+}
+
+static inline char bw_src_sinc_coeffs_is_valid(
+		const bw_src_sinc_coeffs * BW_RESTRICT coeffs) {
+	BW_ASSERT(coeffs != BW_NULL);
+
+#ifdef BW_DEBUG_DEEP
+	if (coeffs->hash != bw_hash_sdbm("bw_src_sinc_coeffs"))
+		return 0;
+#endif
+
+	if (coeffs->n_taps < 16 || coeffs->n_taps > BW_SRC_SINC_TAPS_MAX || (coeffs->n_taps & 3) != 0)
+		return 0;
+	if (coeffs->den == 0 || coeffs->step == 0)
+		return 0;
+	if (coeffs->rational ? coeffs->den * coeffs->n_taps > BW_SRC_SINC_TABLE_LEN : coeffs->den != (uint64_t)1 << 32)
+		return 0;
+
+	return 1;
+}
+
+static inline char bw_src_sinc_state_is_valid(
+		const bw_src_sinc_coeffs * BW_RESTRICT coeffs,
+		const bw_src_sinc_state * BW_RESTRICT  state) {
+	BW_ASSERT(state != BW_NULL);
+
+#ifdef BW_DEBUG_DEEP
+	if (state->hash != bw_hash_sdbm("bw_src_sinc_state"))
+		return 0;
+
+	if (coeffs != BW_NULL && coeffs->reset_id != state->coeffs_reset_id)
+		return 0;
+#endif
+
+	if (coeffs != BW_NULL && state->idx >= coeffs->n_taps)
+		return 0;
+
+	return 1;
+}
+
+#undef BW_SRC_SINC_TAPS_MAX
+#undef BW_SRC_SINC_PHASES
+#undef BW_SRC_SINC_PHASE_SHIFT
+#undef BW_SRC_SINC_TABLE_LEN
+
+#ifdef __cplusplus
+}
+
+#ifndef BW_CXX_NO_ARRAY
+# include <array>
+#endif
+
+namespace Brickworks {
+
+/*** Public C++ API ***/
+
+/*! api_cpp {{{
+ *    ##### Brickworks::SRCSinc
+ *  ```>>> */
+template<size_t N_CHANNELS>
+class SRCSinc {
+public:
+	SRCSinc(
+		float               ratio,
+		bw_src_sinc_quality quality = bw_src_sinc_quality_high);
+
+	void reset(
+		float               x0 = 0.f,
+		float * BW_RESTRICT y0 = nullptr);
+
+#ifndef BW_CXX_NO_ARRAY
+	void reset(
+		float                                       x0,
+		std::array<float, N_CHANNELS> * BW_RESTRICT y0);
+#endif
+
+	void reset(
+		const float * x0,
+		float *       y0 = nullptr);
+
+#ifndef BW_CXX_NO_ARRAY
+	void reset(
+		std::array<float, N_CHANNELS>               x0,
+		std::array<float, N_CHANNELS> * BW_RESTRICT y0 = nullptr);
+#endif
+
+	void process(
+		const float * BW_RESTRICT const * BW_RESTRICT x,
+		float * BW_RESTRICT const * BW_RESTRICT       y,
+		size_t * BW_RESTRICT                          nInSamples,
+		size_t * BW_RESTRICT                          nOutSamples);
+
+#ifndef BW_CXX_NO_ARRAY
+	void process(
+		std::array<const float * BW_RESTRICT, N_CHANNELS> x,
+		std::array<float * BW_RESTRICT, N_CHANNELS>       y,
+		std::array<size_t, N_CHANNELS> &                  nInSamples,
+		std::array<size_t, N_CHANNELS> &                  nOutSamples);
+#endif
+
+	size_t getInSamples(
+		size_t channel,
+		size_t nOutSamples);
+
+	size_t getOutSamples(
+		size_t channel,
+		size_t nInSamples);
+
+	float getLatency();
+/*! <<<...
+ *  }
+ *  ```
+ *  }}} */
+
+/*** Implementation ***/
+
+/* WARNING: This part of the file is not part of the public API. Its content may
+ * change at any time in future versions. Please, do not use it directly. */
+
+private:
+	bw_src_sinc_coeffs			coeffs;
+	bw_src_sinc_state			states[N_CHANNELS];
+	bw_src_sinc_state * BW_RESTRICT	statesP[N_CHANNELS];
+};
+
+template<size_t N_CHANNELS>
+inline SRCSinc<N_CHANNELS>::SRCSinc(
+		float               ratio,
+		bw_src_sinc_quality quality) {
+	bw_src_sinc_init(&coeffs, ratio, quality);
+	for (size_t i = 0; i < N_CHANNELS; i++)
+		statesP[i] = states + i;
+}
+
+template<size_t N_CHANNELS>
+inline void SRCSinc<N_CHANNELS>::reset(
+		float               x0,
+		float * BW_RESTRICT y0) {
+	if (y0 != nullptr)
+		for (size_t i = 0; i < N_CHANNELS; i++)
+			y0[i] = bw_src_sinc_reset_state(&coeffs, states + i, x0);
+	else
+		for (size_t i = 0; i < N_CHANNELS; i++)
+			bw_src_sinc_reset_state(&coeffs, states + i, x0);
+}
+
+#ifndef BW_CXX_NO_ARRAY
+template<size_t N_CHANNELS>
+inline void SRCSinc<N_CHANNELS>::reset(
+		float                                       x0,
+		std::array<float, N_CHANNELS> * BW_RESTRICT y0) {
+	reset(x0, y0 != nullptr ? y0->data() : nullptr);
+}
+#endif
+
+template<size_t N_CHANNELS>
+inline void SRCSinc<N_CHANNELS>::reset(
+		const float * x0,
+		float *       y0) {
+	bw_src_sinc_reset_state_multi(&coeffs, statesP, x0, y0, N_CHANNELS);
+}
+
+#ifndef BW_CXX_NO_ARRAY
+template<size_t N_CHANNELS>
+inline void SRCSinc<N_CHANNELS>::reset(
+		std::array<float, N_CHANNELS>               x0,
+		std::array<float, N_CHANNELS> * BW_RESTRICT y0) {
+	reset(x0.data(), y0 != nullptr ? y0->data() : nullptr);
+}
+#endif
+
+template<size_t N_CHANNELS>
+inline void SRCSinc<N_CHANNELS>::process(
+		const float * BW_RESTRICT const * BW_RESTRICT x,
+		float * BW_RESTRICT const * BW_RESTRICT       y,
+		size_t * BW_RESTRICT                          nInSamples,
+		size_t * BW_RESTRICT                          nOutSamples) {
+	bw_src_sinc_process_multi(&coeffs, statesP, x, y, N_CHANNELS, nInSamples, nOutSamples);
+}
+
+#ifndef BW_CXX_NO_ARRAY
+template<size_t N_CHANNELS>
+inline void SRCSinc<N_CHANNELS>::process(
+		std::array<const float * BW_RESTRICT, N_CHANNELS> x,
+		std::array<float * BW_RESTRICT, N_CHANNELS>       y,
+		std::array<size_t, N_CHANNELS> &                  nInSamples,
+		std::array<size_t, N_CHANNELS> &                  nOutSamples) {
+	process(x.data(), y.data(), nInSamples.data(), nOutSamples.data());
+}
+#endif
+
+template<size_t N_CHANNELS>
+inline size_t SRCSinc<N_CHANNELS>::getInSamples(
+		size_t channel,
+		size_t nOutSamples) {
+	return bw_src_sinc_get_in_samples(&coeffs, states + channel, nOutSamples);
+}
+
+template<size_t N_CHANNELS>
+inline size_t SRCSinc<N_CHANNELS>::getOutSamples(
+		size_t channel,
+		size_t nInSamples) {
+	return bw_src_sinc_get_out_samples(&coeffs, states + channel, nInSamples);
+}
+
+template<size_t N_CHANNELS>
+inline float SRCSinc<N_CHANNELS>::getLatency() {
+	return bw_src_sinc_get_latency(&coeffs);
+}
+
+}
+#endif
+
+#endif
@@ -20,7 +20,7 @@
 
 /*!
  *  module_type {{{ dsp }}}
- *  version {{{ 1.1.1 }}}
+ *  version {{{ 1.2.0 }}}
  *  requires {{{ bw_common bw_math bw_one_pole }}}
  *  description {{{
  *    State variable filter (2nd order, 12 dB/oct) model with separated lowpass,
@@ -28,6 +28,13 @@
  *  }}}
  *  changelog {{{
  *    <ul>
+ *      <li>Version <strong>1.2.0</strong>:
+ *        <ul>
+ *          <li>Added <code>bw_svf_set_block_mode()</code> and optional
+ *              block state-space processing in <code>bw_svf_process()</code>
+ *              and <code>bw_svf_process_multi()</code>.</li>
+ *        </ul>
+ *      </li>
  *      <li>Version <strong>1.1.1</strong>:
  *        <ul>
  *          <li>Added debugging check in <code>bw_svf_process_multi()</code> to
@@ -303,6 +310,23 @@ static inline void bw_svf_set_prewarp_freq(
  *
  *    Default value: `1e3f`.
  *
+ *    #### bw_svf_set_block_mode()
+ *  ```>>> */
+static inline void bw_svf_set_block_mode(
+	bw_svf_coeffs * BW_RESTRICT coeffs,
+	char                        value);
+/*! <<<```
+ *    Sets whether block processing should be used (non-`0`) or not (`0`) in
+ *    `coeffs`.
+ *
+ *    When on, `bw_svf_process()` and `bw_svf_process_multi()` compute blocks
+ *    of 8 output samples at once via precomputed state-transition and impulse
+ *    response matrices whenever no parameter is being smoothed, which lets
+ *    the compiler vectorize across time. Output matches per-sample processing
+ *    net of rounding errors.
+ *
+ *    Default value: `0` (off).
+ *
  *    #### bw_svf_coeffs_is_valid()
  *  ```>>> */
 static inline char bw_svf_coeffs_is_valid(
@@ -348,6 +372,8 @@ static inline char bw_svf_state_is_valid(
 extern "C" {
 #endif
 
+#define BW_SVF_BLOCK_LEN	8
+
 #ifdef BW_DEBUG_DEEP
 enum bw_svf_coeffs_state {
 	bw_svf_coeffs_state_invalid,
@@ -386,6 +412,12 @@ struct bw_svf_coeffs {
 	float				Q;
 	float				prewarp_k;
 	float				prewarp_freq;
+
+	// Block processing
+	char				block_mode;
+	char				block_valid;
+	float				block_o[3][2][BW_SVF_BLOCK_LEN];
+	float				block_t[3][BW_SVF_BLOCK_LEN][BW_SVF_BLOCK_LEN];
 };
 
 struct bw_svf_state {
@@ -412,6 +444,8 @@ static inline void bw_svf_init(
 	coeffs->Q = 0.5f;
 	coeffs->prewarp_freq = 1e3f;
 	coeffs->prewarp_k = 1.f;
+	coeffs->block_mode = 0;
+	coeffs->block_valid = 0;
 
 #ifdef BW_DEBUG_DEEP
 	coeffs->hash = bw_hash_sdbm("bw_svf_coeffs");
@@ -470,7 +504,115 @@ static inline void bw_svf_do_update_coeffs(
 		}
 		coeffs->hp_hb = coeffs->k + coeffs->kbl;
 		coeffs->hp_x = bw_rcpf(1.f + coeffs->kbl * coeffs->hp_hb);
+		coeffs->block_valid = 0;
+	}
+}
+
+// Block processing is only exact when bw_svf_update_coeffs_audio() would be a
+// no-op, i.e., when all smoothed parameters have reached their targets.
+static inline char bw_svf_block_is_ready(
+		const bw_svf_coeffs * BW_RESTRICT coeffs) {
+	if (!coeffs->block_mode)
+		return 0;
+	const float prewarp_freq = coeffs->prewarp_freq + coeffs->prewarp_k * (coeffs->cutoff - coeffs->prewarp_freq);
+	return coeffs->cutoff == bw_one_pole_get_y_z1(&coeffs->smooth_cutoff_state)
+		&& prewarp_freq == bw_one_pole_get_y_z1(&coeffs->smooth_prewarp_freq_state)
+		&& coeffs->Q == bw_one_pole_get_y_z1(&coeffs->smooth_Q_state);
+}
+
+static inline char bw_svf_block_state_is_ready(
+		const bw_svf_coeffs * BW_RESTRICT coeffs,
+		const bw_svf_state * BW_RESTRICT  state) {
+	return state->cutoff_z1 == bw_one_pole_get_y_z1(&coeffs->smooth_cutoff_state);
+}
+
+// With s = (bp_xz1, lp_xz1) as state, outputs over a block are
+// y_o = O_o * s + T_o * x, where T_o is lower-triangular Toeplitz built from the
+// impulse response of output o (0: lp, 1: bp, 2: hp).
+static inline void bw_svf_block_sim(
+		const bw_svf_coeffs * BW_RESTRICT coeffs,
+		float                             s_bp,
+		float                             s_lp,
+		float                             x_0,
+		float                             y[3][BW_SVF_BLOCK_LEN]) {
+	float x = x_0;
+	for (size_t i = 0; i < BW_SVF_BLOCK_LEN; i++) {
+		const float hp = coeffs->hp_x * (x - coeffs->hp_hb * s_bp - s_lp);
+		const float bp = s_bp + coeffs->kbl * hp;
+		const float lp = s_lp + coeffs->kbl * bp;
+		s_bp = bp + coeffs->kbl * hp;
+		s_lp = lp + coeffs->kbl * bp;
+		y[0][i] = lp;
+		y[1][i] = bp;
+		y[2][i] = hp;
+		x = 0.f;
+	}
+}
+
+static inline void bw_svf_block_update(
+		bw_svf_coeffs * BW_RESTRICT coeffs) {
+	if (coeffs->block_valid)
+		return;
+	float h[3][BW_SVF_BLOCK_LEN], o_bp[3][BW_SVF_BLOCK_LEN], o_lp[3][BW_SVF_BLOCK_LEN];
+	bw_svf_block_sim(coeffs, 0.f, 0.f, 1.f, h);
+	bw_svf_block_sim(coeffs, 1.f, 0.f, 0.f, o_bp);
+	bw_svf_block_sim(coeffs, 0.f, 1.f, 0.f, o_lp);
+	for (size_t o = 0; o < 3; o++) {
+		for (size_t i = 0; i < BW_SVF_BLOCK_LEN; i++) {
+			coeffs->block_o[o][0][i] = o_bp[o][i];
+			coeffs->block_o[o][1][i] = o_lp[o][i];
+		}
+		for (size_t j = 0; j < BW_SVF_BLOCK_LEN; j++)
+			for (size_t i = 0; i < BW_SVF_BLOCK_LEN; i++)
+				coeffs->block_t[o][j][i] = i >= j ? h[o][i - j] : 0.f;
 	}
+	coeffs->block_valid = 1;
+}
+
+// Processes as many whole blocks as fit in n_samples and returns the number of
+// processed samples. y_lp, y_bp, and y_hp may be BW_NULL and may alias x.
+static inline size_t bw_svf_block_process(
+		const bw_svf_coeffs * BW_RESTRICT coeffs,
+		bw_svf_state * BW_RESTRICT        state,
+		const float *                     x,
+		float *                           y_lp,
+		float *                           y_bp,
+		float *                           y_hp,
+		size_t                            n_samples) {
+	const size_t n = n_samples - n_samples % BW_SVF_BLOCK_LEN;
+	float hp_z1 = state->hp_z1;
+	float bp_z1 = state->bp_z1;
+	float lp_z1 = state->lp_z1;
+	for (size_t k = 0; k < n; k += BW_SVF_BLOCK_LEN) {
+		float xb[BW_SVF_BLOCK_LEN], yb[3][BW_SVF_BLOCK_LEN];
+		for (size_t i = 0; i < BW_SVF_BLOCK_LEN; i++)
+			xb[i] = x[k + i];
+		const float s_bp = bp_z1 + coeffs->kbl * hp_z1;
+		const float s_lp = lp_z1 + coeffs->kbl * bp_z1;
+		for (size_t o = 0; o < 3; o++) {
+			for (size_t i = 0; i < BW_SVF_BLOCK_LEN; i++)
+				yb[o][i] = coeffs->block_o[o][0][i] * s_bp + coeffs->block_o[o][1][i] * s_lp;
+			for (size_t j = 0; j < BW_SVF_BLOCK_LEN; j++)
+				for (size_t i = 0; i < BW_SVF_BLOCK_LEN; i++)
+					yb[o][i] += coeffs->block_t[o][j][i] * xb[j];
+		}
+		if (y_lp != BW_NULL)
+			for (size_t i = 0; i < BW_SVF_BLOCK_LEN; i++)
+				y_lp[k + i] = yb[0][i];
+		if (y_bp != BW_NULL)
+			for (size_t i = 0; i < BW_SVF_BLOCK_LEN; i++)
+				y_bp[k + i] = yb[1][i];
+		if (y_hp != BW_NULL)
+			for (size_t i = 0; i < BW_SVF_BLOCK_LEN; i++)
+				y_hp[k + i] = yb[2][i];
+		lp_z1 = yb[0][BW_SVF_BLOCK_LEN - 1];
+		bp_z1 = yb[1][BW_SVF_BLOCK_LEN - 1];
+		hp_z1 = yb[2][BW_SVF_BLOCK_LEN - 1];
+	}
+	state->hp_z1 = hp_z1;
+	state->bp_z1 = bp_z1;
+	state->lp_z1 = lp_z1;
+	return n;
 }
 
 static inline void bw_svf_reset_coeffs(
@@ -688,15 +830,21 @@ static inline void bw_svf_process(
 	BW_ASSERT(y_lp == BW_NULL || y_hp == BW_NULL || y_lp != y_hp);
 	BW_ASSERT(y_bp == BW_NULL || y_hp == BW_NULL || y_bp != y_hp);
 
+	size_t n_block = 0;
+	if (bw_svf_block_is_ready(coeffs) && bw_svf_block_state_is_ready(coeffs, state)) {
+		bw_svf_block_update(coeffs);
+		n_block = bw_svf_block_process(coeffs, state, x, y_lp, y_bp, y_hp, n_samples);
+	}
+
 	if (y_lp != BW_NULL) {
 		if (y_bp != BW_NULL) {
 			if (y_hp != BW_NULL) {
-				for (size_t i = 0; i < n_samples; i++) {
+				for (size_t i = n_block; i < n_samples; i++) {
 					bw_svf_update_coeffs_audio(coeffs);
 					bw_svf_process1(coeffs, state, x[i], y_lp + i, y_bp + i, y_hp + i);
 				}
 			} else {
-				for (size_t i = 0; i < n_samples; i++) {
+				for (size_t i = n_block; i < n_samples; i++) {
 					bw_svf_update_coeffs_audio(coeffs);
 					float v_hp;
 					bw_svf_process1(coeffs, state, x[i], y_lp + i, y_bp + i, &v_hp);
@@ -704,13 +852,13 @@ static inline void bw_svf_process(
 			}
 		} else {
 			if (y_hp != BW_NULL) {
-				for (size_t i = 0; i < n_samples; i++) {
+				for (size_t i = n_block; i < n_samples; i++) {
 					bw_svf_update_coeffs_audio(coeffs);
 					float v_bp;
 					bw_svf_process1(coeffs, state, x[i], y_lp + i, &v_bp, y_hp + i);
 				}
 			} else {
-				for (size_t i = 0; i < n_samples; i++) {
+				for (size_t i = n_block; i < n_samples; i++) {
 					bw_svf_update_coeffs_audio(coeffs);
 					float v_bp, v_hp;
 					bw_svf_process1(coeffs, state, x[i], y_lp + i, &v_bp, &v_hp);
@@ -720,13 +868,13 @@ static inline void bw_svf_process(
 	} else {
 		if (y_bp != BW_NULL) {
 			if (y_hp != BW_NULL) {
-				for (size_t i = 0; i < n_samples; i++) {
+				for (size_t i = n_block; i < n_samples; i++) {
 					bw_svf_update_coeffs_audio(coeffs);
 					float v_lp;
 					bw_svf_process1(coeffs, state, x[i], &v_lp, y_bp + i, y_hp + i);
 				}
 			} else {
-				for (size_t i = 0; i < n_samples; i++) {
+				for (size_t i = n_block; i < n_samples; i++) {
 					bw_svf_update_coeffs_audio(coeffs);
 					float v_lp, v_hp;
 					bw_svf_process1(coeffs, state, x[i], &v_lp, y_bp + i, &v_hp);
@@ -734,13 +882,13 @@ static inline void bw_svf_process(
 			}
 		} else {
 			if (y_hp != BW_NULL) {
-				for (size_t i = 0; i < n_samples; i++) {
+				for (size_t i = n_block; i < n_samples; i++) {
 					bw_svf_update_coeffs_audio(coeffs);
 					float v_lp, v_bp;
 					bw_svf_process1(coeffs, state, x[i], &v_lp, &v_bp, y_hp + i);
 				}
 			} else {
-				for (size_t i = 0; i < n_samples; i++) {
+				for (size_t i = n_block; i < n_samples; i++) {
 					bw_svf_update_coeffs_audio(coeffs);
 					float v_lp, v_bp, v_hp;
 					bw_svf_process1(coeffs, state, x[i], &v_lp, &v_bp, &v_hp);
@@ -818,10 +966,25 @@ static inline void bw_svf_process_multi(
 				BW_ASSERT(y_bp[i] == BW_NULL || y_hp[j] == BW_NULL || y_bp[i] != y_hp[j]);
 #endif
 
+	size_t n_block = 0;
+	if (bw_svf_block_is_ready(coeffs)) {
+		char ready = 1;
+		for (size_t j = 0; j < n_channels; j++)
+			ready = ready && bw_svf_block_state_is_ready(coeffs, state[j]);
+		if (ready) {
+			bw_svf_block_update(coeffs);
+			for (size_t j = 0; j < n_channels; j++)
+				n_block = bw_svf_block_process(coeffs, state[j], x[j],
+					y_lp != BW_NULL ? y_lp[j] : BW_NULL,
+					y_bp != BW_NULL ? y_bp[j] : BW_NULL,
+					y_hp != BW_NULL ? y_hp[j] : BW_NULL, n_samples);
+		}
+	}
+
 	if (y_lp != BW_NULL) {
 		if (y_bp != BW_NULL) {
 			if (y_hp != BW_NULL) {
-				for (size_t i = 0; i < n_samples; i++) {
+				for (size_t i = n_block; i < n_samples; i++) {
 					bw_svf_update_coeffs_audio(coeffs);
 					for (size_t j = 0; j < n_channels; j++) {
 						float v_lp, v_bp, v_hp;
@@ -835,7 +998,7 @@ static inline void bw_svf_process_multi(
 					}
 				}
 			} else {
-				for (size_t i = 0; i < n_samples; i++) {
+				for (size_t i = n_block; i < n_samples; i++) {
 					bw_svf_update_coeffs_audio(coeffs);
 					for (size_t j = 0; j < n_channels; j++) {
 						float v_lp, v_bp, v_hp;
@@ -849,7 +1012,7 @@ static inline void bw_svf_process_multi(
 			}
 		} else {
 			if (y_hp != BW_NULL) {
-				for (size_t i = 0; i < n_samples; i++) {
+				for (size_t i = n_block; i < n_samples; i++) {
 					bw_svf_update_coeffs_audio(coeffs);
 					for (size_t j = 0; j < n_channels; j++) {
 						float v_lp, v_bp, v_hp;
@@ -861,7 +1024,7 @@ static inline void bw_svf_process_multi(
 					}
 				}
 			} else {
-				for (size_t i = 0; i < n_samples; i++) {
+				for (size_t i = n_block; i < n_samples; i++) {
 					bw_svf_update_coeffs_audio(coeffs);
 					for (size_t j = 0; j < n_channels; j++) {
 						float v_lp, v_bp, v_hp;
@@ -875,7 +1038,7 @@ static inline void bw_svf_process_multi(
 	} else {
 		if (y_bp != BW_NULL) {
 			if (y_hp != BW_NULL) {
-				for (size_t i = 0; i < n_samples; i++) {
+				for (size_t i = n_block; i < n_samples; i++) {
 					bw_svf_update_coeffs_audio(coeffs);
 					for (size_t j = 0; j < n_channels; j++) {
 						float v_lp, v_bp, v_hp;
@@ -887,7 +1050,7 @@ static inline void bw_svf_process_multi(
 					}
 				}
 			} else {
-				for (size_t i = 0; i < n_samples; i++) {
+				for (size_t i = n_block; i < n_samples; i++) {
 					bw_svf_update_coeffs_audio(coeffs);
 					for (size_t j = 0; j < n_channels; j++) {
 						float v_lp, v_bp, v_hp;
@@ -899,7 +1062,7 @@ static inline void bw_svf_process_multi(
 			}
 		} else {
 			if (y_hp != BW_NULL) {
-				for (size_t i = 0; i < n_samples; i++) {
+				for (size_t i = n_block; i < n_samples; i++) {
 					bw_svf_update_coeffs_audio(coeffs);
 					for (size_t j = 0; j < n_channels; j++) {
 						float v_lp, v_bp, v_hp;
@@ -909,7 +1072,7 @@ static inline void bw_svf_process_multi(
 					}
 				}
 			} else {
-				for (size_t i = 0; i < n_samples; i++) {
+				for (size_t i = n_block; i < n_samples; i++) {
 					bw_svf_update_coeffs_audio(coeffs);
 					for (size_t j = 0; j < n_channels; j++) {
 						float v_lp, v_bp, v_hp;
@@ -982,6 +1145,19 @@ static inline void bw_svf_set_prewarp_freq(
 	BW_ASSERT_DEEP(coeffs->state >= bw_svf_coeffs_state_init);
 }
 
+static inline void bw_svf_set_block_mode(
+		bw_svf_coeffs * BW_RESTRICT coeffs,
+		char                        value) {
+	BW_ASSERT(coeffs != BW_NULL);
+	BW_ASSERT_DEEP(bw_svf_coeffs_is_valid(coeffs));
+	BW_ASSERT_DEEP(coeffs->state >= bw_svf_coeffs_state_init);
+
+	coeffs->block_mode = value;
+
+	BW_ASSERT_DEEP(bw_svf_coeffs_is_valid(coeffs));
+	BW_ASSERT_DEEP(coeffs->state >= bw_svf_coeffs_state_init);
+}
+
 static inline char bw_svf_coeffs_is_valid(
 		const bw_svf_coeffs * BW_RESTRICT coeffs) {
 	BW_ASSERT(coeffs != BW_NULL);
@@ -1066,6 +1242,8 @@ static inline char bw_svf_state_is_valid(
 	return 1;
 }
 
+#undef BW_SVF_BLOCK_LEN
+
 #ifdef __cplusplus
 }
 
@@ -1143,6 +1321,9 @@ public:
 
 	void setPrewarpFreq(
 		float value);
+
+	void setBlockMode(
+		bool value);
 /*! <<<...
  *  }
  *  ```
@@ -1310,6 +1491,13 @@ inline void SVF<N_CHANNELS>::setPrewarpFreq(
 	bw_svf_set_prewarp_freq(&coeffs, value);
 }
 
+
+template<size_t N_CHANNELS>
+inline void SVF<N_CHANNELS>::setBlockMode(
+		bool value) {
+	bw_svf_set_block_mode(&coeffs, value);
+}
+
 }
 #endif
 